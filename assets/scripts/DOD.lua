@@ -25,11 +25,8 @@ local function init(game)
 
    local collisionLayer = game:makeEntity()
    collisionLayer:addRigidBody(0)
-   local collisions = game:getObjectsInLayer(tmxID, 'Collisions')
-   for i, rect in ipairs(collisions) do
-      local scaledRect = scaleRect(rect, Vec(1 / pixelToUnitScale.x, 1 / pixelToUnitScale.y))
-      collisionLayer:addFixtureRect(rect)
-   end
+   local fixtures = collisionLayer:addMergedCollisionLayer(tmxID, 'Collisions')
+   print(string.format('Collisions: %d rects merged into %d fixtures', fixtures.before, fixtures.after))
 
    local atlasID = game:loadAtlas('assets/spritesheets/priest/priest.xml')
 end
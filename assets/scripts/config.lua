@@ -3,3 +3,7 @@ SCREEN_WIDTH=640
 SCREEN_HEIGHT=360
 WINDOW_TITLE="Caul's Castle"
 INITIAL_SCRIPT="assets/scripts/DOD.lua"
+TEXTURE_BUDGET_MB=64
+PHYSICS_RATE=30
+PHYSICS_VELOCITY_ITERATIONS=8
+PHYSICS_POSITION_ITERATIONS=3
@@ -25,9 +25,11 @@
 
 #include <stdio.h>
 
+#ifdef B2_COLLECT_STATS
 float32 b2_toiTime, b2_toiMaxTime;
 int32 b2_toiCalls, b2_toiIters, b2_toiMaxIters;
 int32 b2_toiRootIters, b2_toiMaxRootIters;
+#endif
 
 //
 struct b2SeparationFunction
@@ -253,9 +255,11 @@ struct b2SeparationFunction
 // by computing the largest time at which separation is maintained.
 void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 {
+#ifdef B2_COLLECT_STATS
 	b2Timer timer;
 
 	++b2_toiCalls;
+#endif
 
 	output->state = b2TOIOutput::e_unknown;
 	output->t = input->tMax;
@@ -422,7 +426,9 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 				}
 
 				++rootIterCount;
+#ifdef B2_COLLECT_STATS
 				++b2_toiRootIters;
+#endif
 
 				float32 s = fcn.Evaluate(indexA, indexB, t);
 
@@ -451,7 +457,9 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 				}
 			}
 
+#ifdef B2_COLLECT_STATS
 			b2_toiMaxRootIters = b2Max(b2_toiMaxRootIters, rootIterCount);
+#endif
 
 			++pushBackIter;
 
@@ -462,7 +470,9 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 		}
 
 		++iter;
+#ifdef B2_COLLECT_STATS
 		++b2_toiIters;
+#endif
 
 		if (done)
 		{
@@ -478,9 +488,11 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 		}
 	}
 
+#ifdef B2_COLLECT_STATS
 	b2_toiMaxIters = b2Max(b2_toiMaxIters, iter);
 
 	float32 time = timer.GetMilliseconds();
 	b2_toiMaxTime = b2Max(b2_toiMaxTime, time);
 	b2_toiTime += time;
+#endif
 }
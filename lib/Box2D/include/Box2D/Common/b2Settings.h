@@ -26,6 +26,12 @@
 #define B2_NOT_USED(x) ((void)(x))
 #define b2Assert(A) assert(A)
 
+// Altered from the original: the GJK and time of impact counters
+// (b2_gjkCalls, b2_toiCalls, ...) are plain globals that every b2World::Step
+// writes, so they are only kept when this is defined. Leave it undefined when
+// worlds step on more than one thread.
+// #define B2_COLLECT_STATS
+
 typedef signed char	int8;
 typedef signed short int16;
 typedef signed int int32;
@@ -14,6 +14,7 @@
 #include <lua_game_state.h>
 #include <ecs.h>
 #include <view.h>
+#include <asset_pack.h>
 
 #include <lua.hpp>
 #include <LuaBridge.h>
@@ -23,6 +24,21 @@
 #include <iostream>
 #include <algorithm>
 #include <thread>
+#include <fstream>
+#include <memory>
+#include <string>
+
+// The game's texture budget from its config, in bytes. 0, for no budget,
+// when the config or the setting is missing.
+static std::size_t readTextureBudget(const std::string& configPath)
+{
+    std::unique_ptr<lua_State, void(*)(lua_State*)> pL(luaL_newstate(), &lua_close);
+    if (!pL || te::doLuaAsset(pL.get(), configPath) != LUA_OK) {
+        return 0;
+    }
+    luabridge::LuaRef budget = luabridge::getGlobal(pL.get(), "TEXTURE_BUDGET_MB");
+    return budget.isNumber() ? budget.cast<std::size_t>() * 1024 * 1024 : 0;
+}
 
 int main(int argc, char* argv[])
 {
@@ -38,6 +54,13 @@ int main(int argc, char* argv[])
 
         const te::Initialization init;
 
+        // Read from the pack built by tools/pack_assets.pl when there is one,
+        // anything missing from it still loads from loose files. Debug builds
+        // read loose files first, so edits show up without repacking.
+        if (std::ifstream("assets.pak")) {
+            te::mountAssetPack(std::make_shared<te::AssetPack>("assets.pak"));
+        }
+
         te::WindowPtr pWindow = te::createWindowOpenGL(
             "Map Runner",
             SDL_WINDOWPOS_UNDEFINED,
@@ -51,10 +74,13 @@ int main(int argc, char* argv[])
         auto pShader = std::make_shared<te::Shader>(view, *pWindow);
 
         auto pTMX = std::make_shared<te::TMX>(argv[1]);
+        te::AssetManager assets(pTMX);
+        assets.pTextureManager->setBudget(readTextureBudget("assets/scripts/config.lua"));
         auto pState = std::make_shared<te::LuaGameState>(
             pTMX,
             pShader,
-            glm::scale(glm::vec3(1.f/pTMX->tilewidth, 1.f/pTMX->tileheight, 1.f)));
+            glm::scale(glm::vec3(1.f/pTMX->tilewidth, 1.f/pTMX->tileheight, 1.f)),
+            assets);
         te::StateStack stateStack(pState);
 
         bool running = true;
@@ -0,0 +1,323 @@
+#include "aabb_tree.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace te
+{
+    static AABB combine(const AABB& a, const AABB& b)
+    {
+        return{ glm::min(a.min, b.min), glm::max(a.max, b.max) };
+    }
+
+    // Half the perimeter, which orders boxes like area does but stays
+    // meaningful for flat ones.
+    static float getCost(const AABB& aabb)
+    {
+        glm::vec2 size = aabb.max - aabb.min;
+        return size.x + size.y;
+    }
+
+    float rayEntry(const AABB& aabb, const glm::vec2& origin, const glm::vec2& invDirection, float maxDistance)
+    {
+        const float infinity = std::numeric_limits<float>::infinity();
+        float tMin = 0.f;
+        float tMax = maxDistance;
+        for (int axis = 0; axis < 2; ++axis) {
+            if (std::abs(invDirection[axis]) == infinity) {
+                // Parallel to the slab.
+                if (origin[axis] < aabb.min[axis] || origin[axis] > aabb.max[axis]) { return -1.f; }
+                continue;
+            }
+            float t1 = (aabb.min[axis] - origin[axis]) * invDirection[axis];
+            float t2 = (aabb.max[axis] - origin[axis]) * invDirection[axis];
+            if (t1 > t2) { std::swap(t1, t2); }
+            tMin = std::max(tMin, t1);
+            tMax = std::min(tMax, t2);
+            if (tMin > tMax) { return -1.f; }
+        }
+        return tMin;
+    }
+
+    AABBTree::AABBTree(float margin)
+        : mMargin(margin)
+        , mNodes()
+        , mRoot(NULL_NODE)
+        , mFreeList(NULL_NODE)
+        , mProxyCount(0)
+    {}
+
+    int AABBTree::createProxy(const AABB& aabb, const Entity& entity)
+    {
+        int proxy = allocateNode();
+        Node& node = mNodes[proxy];
+        node.aabb = aabb;
+        node.fat = { aabb.min - mMargin, aabb.max + mMargin };
+        node.entity = entity;
+        node.height = 0;
+        insertLeaf(proxy);
+        ++mProxyCount;
+        return proxy;
+    }
+
+    void AABBTree::destroyProxy(int proxy)
+    {
+        assert(0 <= proxy && proxy < (int)mNodes.size() && mNodes[proxy].isLeaf());
+        removeLeaf(proxy);
+        freeNode(proxy);
+        --mProxyCount;
+    }
+
+    bool AABBTree::moveProxy(int proxy, const AABB& aabb)
+    {
+        assert(0 <= proxy && proxy < (int)mNodes.size() && mNodes[proxy].isLeaf());
+        mNodes[proxy].aabb = aabb;
+        if (encloses(mNodes[proxy].fat, aabb)) { return false; }
+
+        removeLeaf(proxy);
+        mNodes[proxy].fat = { aabb.min - mMargin, aabb.max + mMargin };
+        insertLeaf(proxy);
+        return true;
+    }
+
+    const AABB& AABBTree::getAABB(int proxy) const
+    {
+        return mNodes[proxy].aabb;
+    }
+
+    const AABB& AABBTree::getFatAABB(int proxy) const
+    {
+        return mNodes[proxy].fat;
+    }
+
+    const Entity& AABBTree::getEntity(int proxy) const
+    {
+        return mNodes[proxy].entity;
+    }
+
+    unsigned AABBTree::getProxyCount() const
+    {
+        return mProxyCount;
+    }
+
+    int AABBTree::getHeight() const
+    {
+        return mRoot == NULL_NODE ? 0 : mNodes[mRoot].height;
+    }
+
+    void AABBTree::clear()
+    {
+        mNodes.clear();
+        mRoot = NULL_NODE;
+        mFreeList = NULL_NODE;
+        mProxyCount = 0;
+    }
+
+    void AABBTree::nearest(const glm::vec2& point, unsigned k, std::vector<std::pair<float, int>>& out) const
+    {
+        out.clear();
+        if (mRoot == NULL_NODE || k == 0) { return; }
+
+        // Best first: leaves are keyed by their own box and everything
+        // else by its fat box, which no box below it is closer than, so
+        // leaves come off the queue in order.
+        typedef std::pair<float, int> Candidate;
+        std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> open;
+        auto push = [&](int index) {
+            const Node& node = mNodes[index];
+            open.push({ distanceSquared(node.isLeaf() ? node.aabb : node.fat, point), index });
+        };
+        push(mRoot);
+        while (!open.empty() && out.size() < k) {
+            Candidate candidate = open.top();
+            open.pop();
+            const Node& node = mNodes[candidate.second];
+            if (node.isLeaf()) {
+                out.push_back(candidate);
+            } else {
+                push(node.child1);
+                push(node.child2);
+            }
+        }
+    }
+
+    int AABBTree::allocateNode()
+    {
+        int index;
+        if (mFreeList != NULL_NODE) {
+            index = mFreeList;
+            mFreeList = mNodes[index].parent;
+        } else {
+            index = (int)mNodes.size();
+            mNodes.push_back(Node());
+        }
+        Node& node = mNodes[index];
+        node.parent = NULL_NODE;
+        node.child1 = NULL_NODE;
+        node.child2 = NULL_NODE;
+        node.height = 0;
+        return index;
+    }
+
+    void AABBTree::freeNode(int index)
+    {
+        mNodes[index].parent = mFreeList;
+        mNodes[index].height = -1;
+        mFreeList = index;
+    }
+
+    void AABBTree::insertLeaf(int leaf)
+    {
+        if (mRoot == NULL_NODE) {
+            mRoot = leaf;
+            mNodes[leaf].parent = NULL_NODE;
+            return;
+        }
+
+        // Walk down to the sibling that makes the tree grow least.
+        const AABB leafAABB = mNodes[leaf].fat;
+        int index = mRoot;
+        while (!mNodes[index].isLeaf()) {
+            const Node& node = mNodes[index];
+            float cost = getCost(node.fat);
+            float combinedCost = getCost(combine(node.fat, leafAABB));
+
+            // Pairing with this node makes a new parent. Descending instead
+            // grows this node and everything below that the leaf reaches.
+            float pairCost = 2.f * combinedCost;
+            float inheritanceCost = 2.f * (combinedCost - cost);
+
+            float childCosts[2];
+            int children[2] = { node.child1, node.child2 };
+            for (int i = 0; i < 2; ++i) {
+                const Node& child = mNodes[children[i]];
+                float grown = getCost(combine(child.fat, leafAABB));
+                childCosts[i] = (child.isLeaf() ? grown : grown - getCost(child.fat)) + inheritanceCost;
+            }
+
+            if (pairCost < childCosts[0] && pairCost < childCosts[1]) { break; }
+            index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+        }
+
+        int sibling = index;
+        int oldParent = mNodes[sibling].parent;
+        int newParent = allocateNode();
+        mNodes[newParent].parent = oldParent;
+        mNodes[newParent].fat = combine(leafAABB, mNodes[sibling].fat);
+        mNodes[newParent].height = mNodes[sibling].height + 1;
+        mNodes[newParent].child1 = sibling;
+        mNodes[newParent].child2 = leaf;
+        mNodes[sibling].parent = newParent;
+        mNodes[leaf].parent = newParent;
+
+        if (oldParent == NULL_NODE) {
+            mRoot = newParent;
+        } else if (mNodes[oldParent].child1 == sibling) {
+            mNodes[oldParent].child1 = newParent;
+        } else {
+            mNodes[oldParent].child2 = newParent;
+        }
+
+        refit(mNodes[leaf].parent);
+    }
+
+    void AABBTree::removeLeaf(int leaf)
+    {
+        if (leaf == mRoot) {
+            mRoot = NULL_NODE;
+            return;
+        }
+
+        // The sibling takes the parent's place.
+        int parent = mNodes[leaf].parent;
+        int grandParent = mNodes[parent].parent;
+        int sibling = mNodes[parent].child1 == leaf ? mNodes[parent].child2 : mNodes[parent].child1;
+
+        if (grandParent == NULL_NODE) {
+            mRoot = sibling;
+            mNodes[sibling].parent = NULL_NODE;
+        } else {
+            if (mNodes[grandParent].child1 == parent) {
+                mNodes[grandParent].child1 = sibling;
+            } else {
+                mNodes[grandParent].child2 = sibling;
+            }
+            mNodes[sibling].parent = grandParent;
+            refit(grandParent);
+        }
+        freeNode(parent);
+    }
+
+    // Balances and resizes every node from index up to the root.
+    void AABBTree::refit(int index)
+    {
+        while (index != NULL_NODE) {
+            index = balance(index);
+
+            Node& node = mNodes[index];
+            const Node& child1 = mNodes[node.child1];
+            const Node& child2 = mNodes[node.child2];
+            node.height = 1 + std::max(child1.height, child2.height);
+            node.fat = combine(child1.fat, child2.fat);
+
+            index = node.parent;
+        }
+    }
+
+    // Promotes the taller child of a node whose children differ in height
+    // by more than one. Returns the node now in index's place.
+    int AABBTree::balance(int iA)
+    {
+        Node& a = mNodes[iA];
+        if (a.isLeaf() || a.height < 2) { return iA; }
+
+        int iB = a.child1;
+        int iC = a.child2;
+        int heightDifference = mNodes[iC].height - mNodes[iB].height;
+        if (heightDifference >= -1 && heightDifference <= 1) { return iA; }
+
+        // Rotate so iUp, the taller child, takes a's place and a takes the
+        // shorter of iUp's children.
+        int iUp = heightDifference > 0 ? iC : iB;
+        int iOther = heightDifference > 0 ? iB : iC;
+        Node& up = mNodes[iUp];
+        int iF = up.child1;
+        int iG = up.child2;
+
+        up.child1 = iA;
+        up.parent = a.parent;
+        a.parent = iUp;
+
+        if (up.parent == NULL_NODE) {
+            mRoot = iUp;
+        } else if (mNodes[up.parent].child1 == iA) {
+            mNodes[up.parent].child1 = iUp;
+        } else {
+            mNodes[up.parent].child2 = iUp;
+        }
+
+        int iKeep = mNodes[iF].height > mNodes[iG].height ? iF : iG;
+        int iMove = iKeep == iF ? iG : iF;
+        up.child2 = iKeep;
+        if (heightDifference > 0) {
+            a.child2 = iMove;
+        } else {
+            a.child1 = iMove;
+        }
+        mNodes[iMove].parent = iA;
+
+        const Node& other = mNodes[iOther];
+        const Node& moved = mNodes[iMove];
+        const Node& kept = mNodes[iKeep];
+        a.fat = combine(other.fat, moved.fat);
+        a.height = 1 + std::max(other.height, moved.height);
+        up.fat = combine(a.fat, kept.fat);
+        up.height = 1 + std::max(a.height, kept.height);
+
+        return iUp;
+    }
+}
@@ -0,0 +1,189 @@
+#ifndef TE_AABB_TREE_H
+#define TE_AABB_TREE_H
+
+#include "entity_manager.h"
+
+#include <glm/glm.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace te
+{
+    struct AABB {
+        glm::vec2 min;
+        glm::vec2 max;
+    };
+
+    // Inclusive, so boxes that only share an edge overlap.
+    inline bool overlaps(const AABB& a, const AABB& b)
+    {
+        return a.min.x <= b.max.x && b.min.x <= a.max.x &&
+            a.min.y <= b.max.y && b.min.y <= a.max.y;
+    }
+
+    inline bool encloses(const AABB& outer, const AABB& inner)
+    {
+        return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y &&
+            inner.max.x <= outer.max.x && inner.max.y <= outer.max.y;
+    }
+
+    // Zero for points inside the box.
+    inline float distanceSquared(const AABB& aabb, const glm::vec2& point)
+    {
+        glm::vec2 d = glm::max(glm::max(aabb.min - point, point - aabb.max), glm::vec2(0.f));
+        return glm::dot(d, d);
+    }
+
+    // Distance along the ray to where it enters the box, or a negative
+    // number when it misses within maxDistance. invDirection holds the
+    // reciprocal of each direction component.
+    float rayEntry(const AABB& aabb, const glm::vec2& origin, const glm::vec2& invDirection, float maxDistance);
+
+    // Bounding volume hierarchy over entity boxes that can change every
+    // frame. Leaves hold a copy of the box grown by a margin, so a box that
+    // moves a little stays inside its leaf and needs no tree update.
+    // Inserting picks the sibling that grows the tree's area least and
+    // rotations keep the subtrees within one level of each other.
+    class AABBTree {
+    public:
+        static const int NULL_NODE = -1;
+
+        explicit AABBTree(float margin = 0.25f);
+
+        int createProxy(const AABB& aabb, const Entity& entity);
+        void destroyProxy(int proxy);
+        // Returns true when the box left its fat box and was reinserted.
+        bool moveProxy(int proxy, const AABB& aabb);
+
+        // The box last given for the proxy, without the margin.
+        const AABB& getAABB(int proxy) const;
+        const AABB& getFatAABB(int proxy) const;
+        const Entity& getEntity(int proxy) const;
+
+        unsigned getProxyCount() const;
+        int getHeight() const;
+        void clear();
+
+        // Calls fn(proxy) for every proxy whose fat box overlaps aabb. The
+        // search stops early when fn returns false.
+        template <typename Fn>
+        void query(const AABB& aabb, Fn fn) const;
+
+        // Calls fn(proxy) for every proxy whose fat box the ray enters
+        // within maxDistance. direction need not be normalized; distances
+        // are in multiples of it.
+        template <typename Fn>
+        void raycast(const glm::vec2& origin, const glm::vec2& direction, float maxDistance, Fn fn) const;
+
+        // Fills out with up to k (squared distance, proxy) pairs nearest to
+        // point, closest first. Distances are to the boxes without margin.
+        void nearest(const glm::vec2& point, unsigned k, std::vector<std::pair<float, int>>& out) const;
+
+    private:
+        struct Node {
+            AABB fat;
+            AABB aabb;
+            Entity entity;
+            // Next free node while on the free list.
+            int parent;
+            int child1;
+            int child2;
+            // Leaves are 0, free nodes -1.
+            int height;
+
+            bool isLeaf() const { return child1 == NULL_NODE; }
+        };
+
+        int allocateNode();
+        void freeNode(int node);
+        void insertLeaf(int leaf);
+        void removeLeaf(int leaf);
+        int balance(int node);
+        void refit(int node);
+
+        float mMargin;
+        std::vector<Node> mNodes;
+        int mRoot;
+        int mFreeList;
+        unsigned mProxyCount;
+    };
+
+    // Nodes left to visit in one traversal. Each query has its own, so a
+    // callback may query the tree again. Stacks no deeper than the fixed
+    // part need no allocation.
+    class AABBTraversalStack {
+    public:
+        AABBTraversalStack() : mSize(0), mOverflow() {}
+
+        bool empty() const { return mSize == 0; }
+        void push(int node)
+        {
+            if (mSize < FIXED_SIZE) {
+                mFixed[mSize] = node;
+            } else {
+                mOverflow.push_back(node);
+            }
+            ++mSize;
+        }
+        int pop()
+        {
+            --mSize;
+            if (mSize < FIXED_SIZE) { return mFixed[mSize]; }
+            int node = mOverflow.back();
+            mOverflow.pop_back();
+            return node;
+        }
+
+    private:
+        static const unsigned FIXED_SIZE = 64;
+        int mFixed[FIXED_SIZE];
+        unsigned mSize;
+        std::vector<int> mOverflow;
+    };
+
+    template <typename Fn>
+    void AABBTree::query(const AABB& aabb, Fn fn) const
+    {
+        if (mRoot == NULL_NODE) { return; }
+
+        AABBTraversalStack stack;
+        stack.push(mRoot);
+        while (!stack.empty()) {
+            int index = stack.pop();
+            const Node& node = mNodes[index];
+            if (!overlaps(node.fat, aabb)) { continue; }
+
+            if (node.isLeaf()) {
+                if (!fn(index)) { return; }
+            } else {
+                stack.push(node.child1);
+                stack.push(node.child2);
+            }
+        }
+    }
+
+    template <typename Fn>
+    void AABBTree::raycast(const glm::vec2& origin, const glm::vec2& direction, float maxDistance, Fn fn) const
+    {
+        if (mRoot == NULL_NODE) { return; }
+
+        glm::vec2 invDirection(1.f / direction.x, 1.f / direction.y);
+        AABBTraversalStack stack;
+        stack.push(mRoot);
+        while (!stack.empty()) {
+            int index = stack.pop();
+            const Node& node = mNodes[index];
+            if (rayEntry(node.fat, origin, invDirection, maxDistance) < 0.f) { continue; }
+
+            if (node.isLeaf()) {
+                fn(index);
+            } else {
+                stack.push(node.child1);
+                stack.push(node.child2);
+            }
+        }
+    }
+}
+
+#endif
@@ -1,63 +1,39 @@
 #include "animation_component.h"
 #include "mesh_manager.h"
 
+#include <algorithm>
+
 namespace te
 {
     AnimationComponent::AnimationComponent(size_t capacity)
         : Component(capacity) {}
 
-    static void checkExistingKey(const std::map<int, std::shared_ptr<const Animation>> animations, int key)
+    static AnimationHandle findAnimation(const std::vector<std::pair<int, AnimationHandle>>& animations, int key)
     {
-        auto it = animations.find(key);
+        // Entities have a handful of animations, a scan beats a search.
+        auto it = std::find_if(animations.begin(), animations.end(), [key](const std::pair<int, AnimationHandle>& entry) {
+            return entry.first == key;
+        });
         if (it == animations.end()) {
-            throw std::runtime_error{ "AnimationComponent::setAnimations: no animation for given initial key." };
+            throw std::runtime_error{ "AnimationComponent::setAnimation: no animation for given key." };
         }
+        return it->second;
     }
 
-    static void checkErrors(const std::map<int, std::shared_ptr<const Animation>> animations, int initialKey)
+    void AnimationComponent::setAnimations(const Entity& entity, const std::map<int, AnimationHandle>& animations, int initialKey)
     {
         if (animations.size() == 0) {
             throw std::runtime_error{ "AnimationComponent::setAnimations: must have at least one animation." };
         }
-        for (auto it = animations.begin(); it != animations.end(); ++it) {
-            if (it->second->frames.size() == 0) {
-                throw std::runtime_error{ "AnimationComponent::setAnimations: must have at least one frame." };
-            }
-        }
-
-        checkExistingKey(animations, initialKey);
-    }
-
-    void AnimationComponent::setAnimations(const Entity& entity, const std::map<int, std::shared_ptr<const Animation>>& animations, int initialKey)
-    {
-        checkErrors(animations, initialKey);
-
-        // Create instance
-        if (!hasInstance(entity)) {
-            createInstance(entity, { animations, nullptr, 0, 0 });
-        } else {
-            at(entity) = { animations, nullptr, 0, 0 };
-        }
 
-        // Correct pointer
-        AnimationInstance& instance = at(entity);
-        instance.currAnimation = instance.animations.find(initialKey)->second.get();
-    }
+        AnimationInstance instance{ { animations.begin(), animations.end() }, { 0 }, 0, 0 };
+        instance.currAnimation = findAnimation(instance.animations, initialKey);
 
-    void AnimationComponent::setAnimations(const Entity& entity, std::map<int, std::shared_ptr<const Animation>>&& animations, int initialKey)
-    {
-        checkErrors(animations, initialKey);
-
-        // Create instance
         if (!hasInstance(entity)) {
-            createInstance(entity, { std::move(animations), nullptr, 0, 0 });
+            createInstance(entity, std::move(instance));
         } else {
-            at(entity) = { std::move(animations), nullptr, 0, 0 };
+            at(entity) = std::move(instance);
         }
-
-        // Correct pointer
-        AnimationInstance& instance = at(entity);
-        instance.currAnimation = instance.animations.find(initialKey)->second.get();
     }
 
     void AnimationComponent::setAnimation(const Entity& entity, int key)
@@ -69,8 +45,7 @@ namespace te
             throw std::runtime_error{ "AnimationComponent::setAnimation: entity has no animations." };
         }
 
-        checkExistingKey(pInstance->animations, key);
-        pInstance->currAnimation = pInstance->animations.find(key)->second.get();
+        pInstance->currAnimation = findAnimation(pInstance->animations, key);
         pInstance->currDuration = 0;
         pInstance->currFrameIndex = 0;
     }
@@ -12,8 +12,8 @@
 namespace te
 {
     struct AnimationInstance {
-        std::map<int, std::shared_ptr<const Animation>> animations;
-        const Animation* currAnimation;
+        std::vector<std::pair<int, AnimationHandle>> animations;
+        AnimationHandle currAnimation;
         float currDuration;
         unsigned currFrameIndex;
     };
@@ -22,8 +22,7 @@ namespace te
     public:
         AnimationComponent(size_t capacity = 1024);
 
-        void setAnimations(const Entity& entity, const std::map<int, std::shared_ptr<const Animation>>& animations, int initialKey);
-        void setAnimations(const Entity& entity, std::map<int, std::shared_ptr<const Animation>>&& animations, int initialKey);
+        void setAnimations(const Entity& entity, const std::map<int, AnimationHandle>& animations, int initialKey);
         void setAnimation(const Entity& entity, int key);
 
     private:
@@ -1,6 +1,8 @@
 #ifndef TE_ANIMATION_FACTORY
 #define TE_ANIMATION_FACTORY
 
+#include "mesh.h"
+
 #include <memory>
 #include <vector>
 #include <map>
@@ -8,11 +10,10 @@
 namespace te
 {
     struct TMX;
-    class Model;
     class MeshManager;
 
     struct Frame {
-        std::shared_ptr<const Model> model;
+        MeshHandle mesh;
         unsigned duration;
     };
 
@@ -21,6 +22,8 @@ namespace te
         bool frozen;
     };
 
+    typedef Handle<Animation> AnimationHandle;
+
     class AnimationFactory
     {
     public:
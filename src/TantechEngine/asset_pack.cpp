@@ -0,0 +1,499 @@
+#include "asset_pack.h"
+
+#include <lua.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace te
+{
+    static const char PACK_MAGIC[4] = { 'T', 'E', 'P', 'K' };
+    static const std::uint32_t PACK_VERSION = 1;
+    static const std::uint32_t ENTRY_LZ4 = 1;
+
+    struct PackHeader {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t entryCount;
+        std::uint32_t reserved;
+    };
+
+    // Layout written by tools/pack_assets.pl, all little endian.
+    struct AssetPack::Entry {
+        std::uint32_t pathOffset;
+        std::uint32_t pathLength;
+        std::uint32_t dataOffset;
+        std::uint32_t storedSize;
+        std::uint32_t size;
+        std::uint32_t flags;
+    };
+
+    static_assert(sizeof(PackHeader) == 16, "Pack header must match the packer.");
+
+    struct AssetPack::Mapping {
+        const char* data;
+        std::size_t size;
+#ifdef _WIN32
+        HANDLE file;
+        HANDLE mapping;
+#endif
+
+        Mapping(const std::string& pathfile);
+        ~Mapping();
+    };
+
+#ifdef _WIN32
+    AssetPack::Mapping::Mapping(const std::string& pathfile)
+        : data(nullptr), size(0), file(INVALID_HANDLE_VALUE), mapping(NULL)
+    {
+        file = CreateFileA(pathfile.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+        if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("AssetPack: Could not open " + pathfile);
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            throw std::runtime_error("AssetPack: Empty pack " + pathfile);
+        }
+        size = (std::size_t)fileSize.QuadPart;
+
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping) data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!data) {
+            if (mapping) CloseHandle(mapping);
+            CloseHandle(file);
+            throw std::runtime_error("AssetPack: Could not map " + pathfile);
+        }
+    }
+
+    AssetPack::Mapping::~Mapping()
+    {
+        UnmapViewOfFile(data);
+        CloseHandle(mapping);
+        CloseHandle(file);
+    }
+#else
+    AssetPack::Mapping::Mapping(const std::string& pathfile)
+        : data(nullptr), size(0)
+    {
+        int fd = ::open(pathfile.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("AssetPack: Could not open " + pathfile);
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            throw std::runtime_error("AssetPack: Empty pack " + pathfile);
+        }
+        size = (std::size_t)info.st_size;
+
+        void* pMapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (pMapped == MAP_FAILED) throw std::runtime_error("AssetPack: Could not map " + pathfile);
+        data = (const char*)pMapped;
+    }
+
+    AssetPack::Mapping::~Mapping()
+    {
+        munmap((void*)data, size);
+    }
+#endif
+
+    // LZ4 block format, as produced by the packer. Every length and offset
+    // is checked so a corrupt pack throws instead of overrunning.
+    static void decompressLZ4(const unsigned char* src, std::size_t srcSize, unsigned char* dst, std::size_t dstSize)
+    {
+        const unsigned char* ip = src;
+        const unsigned char* const srcEnd = src + srcSize;
+        unsigned char* op = dst;
+        unsigned char* const dstEnd = dst + dstSize;
+        const std::runtime_error corrupt("AssetPack: Corrupt compressed entry.");
+
+        while (ip < srcEnd) {
+            unsigned token = *ip++;
+
+            std::size_t literals = token >> 4;
+            if (literals == 15) {
+                unsigned char extra;
+                do {
+                    if (ip == srcEnd) throw corrupt;
+                    extra = *ip++;
+                    literals += extra;
+                } while (extra == 255);
+            }
+            if (literals > (std::size_t)(srcEnd - ip) || literals > (std::size_t)(dstEnd - op)) throw corrupt;
+            std::memcpy(op, ip, literals);
+            ip += literals;
+            op += literals;
+
+            // The final sequence is literals only.
+            if (ip == srcEnd) break;
+
+            if (srcEnd - ip < 2) throw corrupt;
+            std::size_t offset = ip[0] | (ip[1] << 8);
+            ip += 2;
+            if (offset == 0 || offset > (std::size_t)(op - dst)) throw corrupt;
+
+            std::size_t match = token & 15;
+            if (match == 15) {
+                unsigned char extra;
+                do {
+                    if (ip == srcEnd) throw corrupt;
+                    extra = *ip++;
+                    match += extra;
+                } while (extra == 255);
+            }
+            match += 4;
+            if (match > (std::size_t)(dstEnd - op)) throw corrupt;
+
+            // Matches may overlap their own output, so copy forwards bytewise.
+            const unsigned char* from = op - offset;
+            for (std::size_t i = 0; i < match; ++i) {
+                op[i] = from[i];
+            }
+            op += match;
+        }
+
+        if (op != dstEnd) throw corrupt;
+    }
+
+    AssetSpan::AssetSpan()
+        : mData(nullptr), mSize(0), mpOwner() {}
+
+    AssetSpan::AssetSpan(const char* data, std::size_t size, std::shared_ptr<const void> pOwner)
+        : mData(data), mSize(size), mpOwner(pOwner) {}
+
+    const char* AssetSpan::data() const
+    {
+        return mData;
+    }
+
+    std::size_t AssetSpan::size() const
+    {
+        return mSize;
+    }
+
+    bool AssetSpan::empty() const
+    {
+        return mSize == 0;
+    }
+
+    std::string AssetSpan::str() const
+    {
+        return std::string(mData, mSize);
+    }
+
+    AssetPack::AssetPack(const std::string& pathfile)
+        : mpMapping(new Mapping(pathfile))
+        , mEntries(nullptr)
+        , mEntryCount(0)
+    {
+        const std::runtime_error corrupt("AssetPack: Corrupt pack " + pathfile);
+
+        if (mpMapping->size < sizeof(PackHeader)) throw corrupt;
+        const PackHeader* pHeader = (const PackHeader*)mpMapping->data;
+        if (std::memcmp(pHeader->magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0) throw corrupt;
+        if (pHeader->version != PACK_VERSION) throw std::runtime_error("AssetPack: Unsupported pack version in " + pathfile);
+
+        mEntryCount = pHeader->entryCount;
+        mEntries = (const Entry*)(mpMapping->data + sizeof(PackHeader));
+        if ((mpMapping->size - sizeof(PackHeader)) / sizeof(Entry) < mEntryCount) throw corrupt;
+
+        // Validate once here so lookups can trust the index.
+        for (unsigned i = 0; i < mEntryCount; ++i) {
+            const Entry& entry = mEntries[i];
+            if (entry.pathOffset > mpMapping->size || entry.pathLength > mpMapping->size - entry.pathOffset) throw corrupt;
+            if (entry.dataOffset > mpMapping->size || entry.storedSize > mpMapping->size - entry.dataOffset) throw corrupt;
+            if (!(entry.flags & ENTRY_LZ4) && entry.storedSize != entry.size) throw corrupt;
+        }
+    }
+
+    AssetPack::~AssetPack() {}
+
+    const AssetPack::Entry* AssetPack::find(const std::string& path) const
+    {
+        const char* data = mpMapping->data;
+        const Entry* end = mEntries + mEntryCount;
+        const Entry* it = std::lower_bound(mEntries, end, path, [data](const Entry& entry, const std::string& key)
+        {
+            int cmp = std::memcmp(data + entry.pathOffset, key.data(), std::min<std::size_t>(entry.pathLength, key.size()));
+            return cmp < 0 || (cmp == 0 && entry.pathLength < key.size());
+        });
+
+        if (it != end && it->pathLength == path.size() && std::memcmp(data + it->pathOffset, path.data(), path.size()) == 0) {
+            return it;
+        }
+        return nullptr;
+    }
+
+    bool AssetPack::contains(const std::string& path) const
+    {
+        return find(normalizeAssetPath(path)) != nullptr;
+    }
+
+    AssetSpan AssetPack::open(const std::string& path) const
+    {
+        const Entry* pEntry = find(normalizeAssetPath(path));
+        if (!pEntry) throw AssetNotFound(path);
+
+        const char* stored = mpMapping->data + pEntry->dataOffset;
+        if (!(pEntry->flags & ENTRY_LZ4)) {
+            return AssetSpan(stored, pEntry->size, mpMapping);
+        }
+
+        std::shared_ptr<std::vector<char>> pBuffer(new std::vector<char>(pEntry->size));
+        decompressLZ4((const unsigned char*)stored, pEntry->storedSize, (unsigned char*)pBuffer->data(), pBuffer->size());
+        return AssetSpan(pBuffer->data(), pBuffer->size(), pBuffer);
+    }
+
+    unsigned AssetPack::getEntryCount() const
+    {
+        return mEntryCount;
+    }
+
+    AssetNotFound::AssetNotFound(const std::string& path)
+        : std::runtime_error("Asset not found: " + path) {}
+
+    std::string normalizeAssetPath(const std::string& path)
+    {
+        std::vector<std::string> parts;
+        std::string part;
+        for (std::size_t i = 0; i <= path.size(); ++i) {
+            char c = i < path.size() ? path[i] : '/';
+            if (c != '/' && c != '\\') {
+                part += c;
+                continue;
+            }
+            if (part == "..") {
+                if (!parts.empty() && parts.back() != "..") {
+                    parts.pop_back();
+                } else {
+                    parts.push_back(part);
+                }
+            } else if (!part.empty() && part != ".") {
+                parts.push_back(part);
+            }
+            part.clear();
+        }
+
+        std::string normalized;
+        for (const auto& p : parts) {
+            if (!normalized.empty()) normalized += '/';
+            normalized += p;
+        }
+        return normalized;
+    }
+
+    static std::mutex mountMutex;
+    static std::shared_ptr<const AssetPack> pMountedPack;
+    static AssetPriority mountedPriority = DEFAULT_ASSET_PRIORITY;
+
+    static std::shared_ptr<const AssetPack> getMountedPack(AssetPriority* pPriority = nullptr)
+    {
+        std::lock_guard<std::mutex> lock(mountMutex);
+        if (pPriority) *pPriority = mountedPriority;
+        return pMountedPack;
+    }
+
+    static bool hasLooseFile(const std::string& path)
+    {
+        return static_cast<bool>(std::ifstream(path.c_str(), std::ios::binary));
+    }
+
+    // Whether readAsset would take the path from the pack.
+    static bool isReadFromPack(const AssetPack* pPack, AssetPriority priority, const std::string& path)
+    {
+        if (!pPack || !pPack->contains(path)) return false;
+        return priority == AssetPriority::PACK || !hasLooseFile(path);
+    }
+
+    void mountAssetPack(std::shared_ptr<const AssetPack> pPack, AssetPriority priority)
+    {
+        std::lock_guard<std::mutex> lock(mountMutex);
+        pMountedPack = pPack;
+        mountedPriority = priority;
+    }
+
+    AssetSpan readAsset(const std::string& path)
+    {
+        AssetPriority priority;
+        std::shared_ptr<const AssetPack> pPack = getMountedPack(&priority);
+        if (isReadFromPack(pPack.get(), priority, path)) {
+            return pPack->open(path);
+        }
+
+        std::ifstream file(path.c_str(), std::ios::binary);
+        if (!file) throw AssetNotFound(path);
+
+        std::shared_ptr<std::vector<char>> pBuffer(new std::vector<char>());
+        pBuffer->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return AssetSpan(pBuffer->data(), pBuffer->size(), pBuffer);
+    }
+
+    std::vector<char> readAssetText(const std::string& path)
+    {
+        AssetSpan span = readAsset(path);
+        std::vector<char> text(span.data(), span.data() + span.size());
+        text.push_back('\0');
+        return text;
+    }
+
+    int loadLuaAsset(lua_State* L, const std::string& path)
+    {
+        AssetSpan span;
+        try {
+            span = readAsset(path);
+        } catch (const std::exception& ex) {
+            lua_pushfstring(L, "cannot open %s: %s", path.c_str(), ex.what());
+            return LUA_ERRFILE;
+        }
+        std::string chunkname = "@" + path;
+        return luaL_loadbuffer(L, span.data(), span.size(), chunkname.c_str());
+    }
+
+    int doLuaAsset(lua_State* L, const std::string& path)
+    {
+        return loadLuaAsset(L, path) || lua_pcall(L, 0, LUA_MULTRET, 0);
+    }
+
+    static int appendChunk(lua_State*, const void* p, std::size_t size, void* ud)
+    {
+        static_cast<std::string*>(ud)->append(static_cast<const char*>(p), size);
+        return 0;
+    }
+
+    std::string compileLuaAsset(const std::string& path)
+    {
+        std::unique_ptr<lua_State, void(*)(lua_State*)> pL(luaL_newstate(), &lua_close);
+        if (!pL) {
+            throw std::runtime_error{ "compileLuaAsset: could not create Lua state." };
+        }
+        lua_State* L = pL.get();
+        if (loadLuaAsset(L, path) != LUA_OK) {
+            throw std::runtime_error{ lua_tostring(L, -1) };
+        }
+        std::string bytecode;
+        lua_dump(L, &appendChunk, &bytecode, 0);
+        return bytecode;
+    }
+
+    int loadLuaBytecode(lua_State* L, const std::string& bytecode, const std::string& path)
+    {
+        std::string chunkname = "@" + path;
+        return luaL_loadbufferx(L, bytecode.data(), bytecode.size(), chunkname.c_str(), "b");
+    }
+
+    // The functions below are called from Lua. C++ locals are scoped so
+    // none are alive when Lua raises an error.
+
+    static int callOriginal(lua_State* L)
+    {
+        lua_pushvalue(L, lua_upvalueindex(1));
+        lua_insert(L, 1);
+        lua_call(L, lua_gettop(L) - 1, LUA_MULTRET);
+        return lua_gettop(L);
+    }
+
+    static int luaDoFile(lua_State* L)
+    {
+        if (lua_isnoneornil(L, 1)) return callOriginal(L);
+
+        const char* path = luaL_checkstring(L, 1);
+        lua_settop(L, 1);
+        int status;
+        {
+            status = loadLuaAsset(L, path);
+        }
+        if (status != LUA_OK) return lua_error(L);
+        lua_call(L, 0, LUA_MULTRET);
+        return lua_gettop(L) - 1;
+    }
+
+    static int luaLoadFile(lua_State* L)
+    {
+        if (lua_isnoneornil(L, 1)) return callOriginal(L);
+
+        const char* path = luaL_checkstring(L, 1);
+        int env = lua_isnone(L, 3) ? 0 : 3;
+        int status;
+        {
+            status = loadLuaAsset(L, path);
+        }
+        if (status != LUA_OK) {
+            lua_pushnil(L);
+            lua_insert(L, -2);
+            return 2;
+        }
+        if (env) {
+            lua_pushvalue(L, env);
+            if (!lua_setupvalue(L, -2, 1)) lua_pop(L, 1);
+        }
+        return 1;
+    }
+
+    static int searchAssetPack(lua_State* L)
+    {
+        const char* name = luaL_checkstring(L, 1);
+        bool found;
+        int status = LUA_OK;
+        {
+            std::string path(name);
+            std::replace(path.begin(), path.end(), '.', '/');
+            path += ".lua";
+
+            AssetPriority priority;
+            std::shared_ptr<const AssetPack> pPack = getMountedPack(&priority);
+            found = isReadFromPack(pPack.get(), priority, path);
+            if (!found) {
+                lua_pushfstring(L, "\n\tno entry '%s' in asset pack", path.c_str());
+            } else {
+                status = loadLuaAsset(L, path);
+                if (status == LUA_OK) lua_pushstring(L, path.c_str());
+            }
+        }
+        if (!found) return 1;
+        if (status != LUA_OK) return lua_error(L);
+        return 2;
+    }
+
+    void openAssetLoaders(lua_State* L)
+    {
+        lua_getglobal(L, "dofile");
+        lua_pushcclosure(L, luaDoFile, 1);
+        lua_setglobal(L, "dofile");
+
+        lua_getglobal(L, "loadfile");
+        lua_pushcclosure(L, luaLoadFile, 1);
+        lua_setglobal(L, "loadfile");
+
+        // Ahead of the file searcher, after the preload one. It passes on
+        // modules readAsset would take from loose files.
+        lua_getglobal(L, "package");
+        if (lua_istable(L, -1)) {
+            lua_getfield(L, -1, "searchers");
+            if (lua_istable(L, -1)) {
+                for (lua_Integer i = (lua_Integer)lua_rawlen(L, -1); i >= 2; --i) {
+                    lua_rawgeti(L, -1, i);
+                    lua_rawseti(L, -2, i + 1);
+                }
+                lua_pushcfunction(L, searchAssetPack);
+                lua_rawseti(L, -2, 2);
+            }
+            lua_pop(L, 1);
+        }
+        lua_pop(L, 1);
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef TE_ASSET_PACK_H
+#define TE_ASSET_PACK_H
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct lua_State;
+
+namespace te
+{
+    // Read-only bytes of one asset. Entries stored uncompressed point
+    // straight into the mapped pack, anything else owns its buffer.
+    class AssetSpan {
+    public:
+        AssetSpan();
+        AssetSpan(const char* data, std::size_t size, std::shared_ptr<const void> pOwner);
+
+        const char* data() const;
+        std::size_t size() const;
+        bool empty() const;
+        std::string str() const;
+    private:
+        const char* mData;
+        std::size_t mSize;
+        std::shared_ptr<const void> mpOwner;
+    };
+
+    // Archive built by tools/pack_assets.pl: a header, an index sorted by
+    // path, then the entries, each optionally LZ4 block compressed.
+    // The whole file is mapped once and shared by every span into it.
+    class AssetPack {
+    public:
+        explicit AssetPack(const std::string& pathfile);
+        ~AssetPack();
+
+        bool contains(const std::string& path) const;
+        // Throws AssetNotFound if the pack has no such entry.
+        AssetSpan open(const std::string& path) const;
+        unsigned getEntryCount() const;
+
+    private:
+        AssetPack(const AssetPack&) = delete;
+        AssetPack& operator=(const AssetPack&) = delete;
+
+        struct Entry;
+        const Entry* find(const std::string& path) const;
+
+        struct Mapping;
+        std::shared_ptr<Mapping> mpMapping;
+        const Entry* mEntries;
+        unsigned mEntryCount;
+    };
+
+    class AssetNotFound : public std::runtime_error {
+    public:
+        AssetNotFound(const std::string& path);
+    };
+
+    // Collapses "." and ".." and uses forward slashes, the form paths are
+    // stored in.
+    std::string normalizeAssetPath(const std::string& path);
+
+    // Which of the mounted pack and loose files readAsset tries first.
+    // Debug builds prefer loose files, so an asset edited in place is read
+    // even when a stale copy of it is still in the pack.
+    enum class AssetPriority {
+        PACK,
+        LOOSE_FILES
+    };
+#ifdef _DEBUG
+    const AssetPriority DEFAULT_ASSET_PRIORITY = AssetPriority::LOOSE_FILES;
+#else
+    const AssetPriority DEFAULT_ASSET_PRIORITY = AssetPriority::PACK;
+#endif
+
+    // Makes the pack a place readAsset looks, before or after loose files
+    // as priority says. Passing nullptr returns to loose files only.
+    void mountAssetPack(std::shared_ptr<const AssetPack> pPack, AssetPriority priority = DEFAULT_ASSET_PRIORITY);
+
+    // Reads from the mounted pack or a loose file, whichever comes first
+    // that has the asset.
+    AssetSpan readAsset(const std::string& path);
+
+    // A zero terminated copy, for parsers such as rapidxml that work in place.
+    std::vector<char> readAssetText(const std::string& path);
+
+    // Counterparts of luaL_loadfile and luaL_dofile that go through readAsset.
+    int loadLuaAsset(lua_State* L, const std::string& path);
+    int doLuaAsset(lua_State* L, const std::string& path);
+
+    // Parses a script in a scratch state and returns its bytecode, so the
+    // parse can run on a thread other than the one owning the state that
+    // will run it. Throws std::runtime_error with Lua's message on failure.
+    std::string compileLuaAsset(const std::string& path);
+    // Loads what compileLuaAsset returned, like loadLuaAsset would have.
+    int loadLuaBytecode(lua_State* L, const std::string& bytecode, const std::string& path);
+
+    // Replaces dofile and loadfile and adds a package searcher, so scripts
+    // that load other scripts read them through readAsset as well.
+    void openAssetLoaders(lua_State* L);
+}
+
+#endif
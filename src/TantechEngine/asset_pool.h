@@ -0,0 +1,153 @@
+#ifndef TE_ASSET_POOL_H
+#define TE_ASSET_POOL_H
+
+#include <cassert>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace te
+{
+    // Refers to an asset in an AssetPool. The low bits index a slot and the
+    // high bits hold the slot's generation, so a handle to an erased asset
+    // never resolves to whatever reuses the slot. Zero is never issued.
+    template <typename Asset>
+    struct Handle {
+        std::uint32_t value;
+
+        bool operator==(const Handle& o) const { return value == o.value; }
+        bool operator!=(const Handle& o) const { return value != o.value; }
+        bool operator<(const Handle& o) const { return value < o.value; }
+    };
+
+    // Assets are released together when their scope ends. Scope 0 lasts as
+    // long as the pool.
+    typedef unsigned AssetScope;
+
+    // Keeps assets of one type contiguous, moving the last asset into the
+    // hole when one is erased.
+    template <typename Asset>
+    class AssetPool {
+    public:
+        static const std::uint32_t INDEX_BITS = 20;
+        static const std::uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+        static const std::uint32_t GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+
+        AssetPool()
+            : mAssets()
+            , mSlotOf()
+            , mScopes()
+            , mSlots()
+            , mFreeSlots()
+        {}
+
+        Handle<Asset> insert(Asset&& asset, AssetScope scope = 0)
+        {
+            std::uint32_t slot;
+            if (!mFreeSlots.empty()) {
+                slot = mFreeSlots.back();
+                mFreeSlots.pop_back();
+            } else {
+                if (mSlots.size() > INDEX_MASK) {
+                    throw std::runtime_error{ "AssetPool::insert: out of slots." };
+                }
+                slot = (std::uint32_t)mSlots.size();
+                mSlots.push_back({ 0, 1 });
+            }
+
+            mSlots[slot].dense = (std::uint32_t)mAssets.size();
+            mAssets.push_back(std::move(asset));
+            mSlotOf.push_back(slot);
+            mScopes.push_back(scope);
+
+            return{ mSlots[slot].generation << INDEX_BITS | slot };
+        }
+
+        bool contains(Handle<Asset> handle) const
+        {
+            std::uint32_t slot = handle.value & INDEX_MASK;
+            return handle.value != 0 && slot < mSlots.size() &&
+                mSlots[slot].generation == handle.value >> INDEX_BITS &&
+                mSlots[slot].dense != NONE;
+        }
+
+        const Asset& operator[](Handle<Asset> handle) const
+        {
+            assert(contains(handle));
+            return mAssets[mSlots[handle.value & INDEX_MASK].dense];
+        }
+
+        Asset& operator[](Handle<Asset> handle)
+        {
+            return const_cast<Asset&>(static_cast<const AssetPool&>(*this)[handle]);
+        }
+
+        // Null when the handle is stale.
+        const Asset* find(Handle<Asset> handle) const
+        {
+            return contains(handle) ? &mAssets[mSlots[handle.value & INDEX_MASK].dense] : nullptr;
+        }
+
+        void erase(Handle<Asset> handle)
+        {
+            if (!contains(handle)) { return; }
+            eraseDense(mSlots[handle.value & INDEX_MASK].dense);
+        }
+
+        void eraseScope(AssetScope scope)
+        {
+            for (std::uint32_t i = (std::uint32_t)mAssets.size(); i-- > 0;) {
+                if (mScopes[i] == scope) {
+                    eraseDense(i);
+                }
+            }
+        }
+
+        std::size_t size() const { return mAssets.size(); }
+
+        typename std::vector<Asset>::const_iterator begin() const { return mAssets.begin(); }
+        typename std::vector<Asset>::const_iterator end() const { return mAssets.end(); }
+
+    private:
+        static const std::uint32_t NONE = 0xffffffff;
+
+        struct Slot {
+            std::uint32_t dense;
+            std::uint32_t generation;
+        };
+
+        void eraseDense(std::uint32_t i)
+        {
+            std::uint32_t last = (std::uint32_t)mAssets.size() - 1;
+            std::uint32_t slot = mSlotOf[i];
+            if (i != last) {
+                mAssets[i] = std::move(mAssets[last]);
+                mSlotOf[i] = mSlotOf[last];
+                mScopes[i] = mScopes[last];
+                mSlots[mSlotOf[i]].dense = i;
+            }
+            mAssets.pop_back();
+            mSlotOf.pop_back();
+            mScopes.pop_back();
+
+            mSlots[slot].dense = NONE;
+            mSlots[slot].generation = (mSlots[slot].generation + 1) & GENERATION_MASK;
+            if (mSlots[slot].generation == 0) {
+                mSlots[slot].generation = 1;
+            }
+            mFreeSlots.push_back(slot);
+        }
+
+        AssetPool(const AssetPool&) = delete;
+        AssetPool& operator=(const AssetPool&) = delete;
+
+        std::vector<Asset> mAssets;
+        std::vector<std::uint32_t> mSlotOf;
+        std::vector<AssetScope> mScopes;
+        std::vector<Slot> mSlots;
+        std::vector<std::uint32_t> mFreeSlots;
+    };
+}
+
+#endif
@@ -0,0 +1,37 @@
+#include "asset_pools.h"
+
+#include <algorithm>
+
+namespace te
+{
+    AssetPools::AssetPools()
+        : textures()
+        , meshes()
+        , animations()
+        , mScopes()
+        , mNextScope(1)
+    {}
+
+    AssetScope AssetPools::beginScope()
+    {
+        mScopes.push_back(mNextScope);
+        return mNextScope++;
+    }
+
+    void AssetPools::endScope(AssetScope scope)
+    {
+        if (scope == 0) { return; }
+
+        // Animations refer to meshes and meshes to textures, so release
+        // them in that order.
+        animations.eraseScope(scope);
+        meshes.eraseScope(scope);
+        textures.eraseScope(scope);
+        mScopes.erase(std::remove(mScopes.begin(), mScopes.end(), scope), mScopes.end());
+    }
+
+    AssetScope AssetPools::getScope() const
+    {
+        return mScopes.empty() ? 0 : mScopes.back();
+    }
+}
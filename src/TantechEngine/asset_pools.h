@@ -0,0 +1,36 @@
+#ifndef TE_ASSET_POOLS_H
+#define TE_ASSET_POOLS_H
+
+#include "asset_pool.h"
+#include "texture.h"
+#include "mesh.h"
+#include "animation_factory.h"
+
+#include <vector>
+
+namespace te
+{
+    // Every texture, mesh and animation loaded for the game. Managers insert
+    // into the innermost open scope, which a level opens on entry and ends
+    // on exit; handles into an ended scope simply stop resolving.
+    struct AssetPools {
+        AssetPools();
+
+        AssetPool<Texture> textures;
+        AssetPool<Mesh> meshes;
+        AssetPool<Animation> animations;
+
+        AssetScope beginScope();
+        void endScope(AssetScope scope);
+        AssetScope getScope() const;
+
+    private:
+        AssetPools(const AssetPools&) = delete;
+        AssetPools& operator=(const AssetPools&) = delete;
+
+        std::vector<AssetScope> mScopes;
+        AssetScope mNextScope;
+    };
+}
+
+#endif
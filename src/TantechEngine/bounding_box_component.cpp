@@ -19,8 +19,10 @@ namespace te
 
     BoundingBoxComponent::BoundingBoxComponent(
         std::shared_ptr<TransformComponent> pTransform,
+        std::vector<std::shared_ptr<Observer<BoundingBoxUpdateEvent>>>&& observers,
         std::size_t capacity)
         : Component(capacity)
+        , Notifier(std::move(observers))
         , mpTransform(pTransform)
     {}
 
@@ -34,14 +36,18 @@ namespace te
         {
             at(entity) = { dimensions, offset };
         }
+        notify({ entity });
     }
 
 	BoundingBox BoundingBoxComponent::getBoundingBox(const Entity& entity) const
 	{
         if (!hasInstance(entity)) { throw std::out_of_range("No bounding box instance for entity."); }
 
-        const BBInstance& instance = at(entity);
+        return getBoundingBox(entity, at(entity));
+	}
 
+    BoundingBox BoundingBoxComponent::getBoundingBox(const Entity& entity, const BBInstance& instance) const
+    {
         glm::mat4 transform = mpTransform->getWorldTransform(entity);
 
         glm::vec4 vertices[4] = {
@@ -67,7 +73,7 @@ namespace te
             max.x - min.x,
             max.y - min.y
         };
-	}
+    }
 
     //SDL_Rect BoundingBoxComponent::getBoundingBox(const Entity& entity) const
     //{
@@ -27,15 +27,26 @@ namespace te
 
     BoundingBox operator*(const glm::mat4&, const BoundingBox&);
 
-    class BoundingBoxComponent : public Component<BBInstance>
+    struct BoundingBoxUpdateEvent
+    {
+        const Entity entity;
+    };
+
+    class BoundingBoxComponent : public Component<BBInstance>,
+                                 public Notifier<BoundingBoxUpdateEvent>
     {
     public:
-        BoundingBoxComponent(std::shared_ptr<TransformComponent> pTransform, std::size_t capacity = 1024);
+        BoundingBoxComponent(std::shared_ptr<TransformComponent> pTransform,
+                             std::vector<std::shared_ptr<Observer<BoundingBoxUpdateEvent>>>&& observers = {},
+                             std::size_t capacity = 1024);
 
         void setBoundingBox(const Entity& entity, const glm::vec2& dimensions, const glm::vec2& offset);
         BoundingBox getBoundingBox(const Entity& entity) const;
 	private:
 		friend class CollisionSystem;
+        friend class SpatialIndex;
+
+        BoundingBox getBoundingBox(const Entity& entity, const BBInstance& instance) const;
 
         std::shared_ptr<TransformComponent> mpTransform;
     };
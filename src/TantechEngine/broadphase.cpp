@@ -0,0 +1,76 @@
+#include "broadphase.h"
+#include "bounding_box_component.h"
+
+#include <algorithm>
+
+namespace te
+{
+    void AABBArray::clear()
+    {
+        minX.clear();
+        minY.clear();
+        maxX.clear();
+        maxY.clear();
+    }
+
+    void AABBArray::reserve(std::size_t n)
+    {
+        minX.reserve(n);
+        minY.reserve(n);
+        maxX.reserve(n);
+        maxY.reserve(n);
+    }
+
+    void AABBArray::push(const BoundingBox& bb)
+    {
+        minX.push_back(bb.x);
+        minY.push_back(bb.y);
+        maxX.push_back(bb.x + bb.w);
+        maxY.push_back(bb.y + bb.h);
+    }
+
+    std::size_t AABBArray::size() const
+    {
+        return minX.size();
+    }
+
+    BoundingBox AABBArray::get(std::size_t i) const
+    {
+        return{ minX[i], minY[i], maxX[i] - minX[i], maxY[i] - minY[i] };
+    }
+
+    void sweepAndPrune(const AABBArray& boxes, std::vector<IndexPair>& pairs, std::vector<unsigned>& order)
+    {
+        pairs.clear();
+
+        const unsigned n = (unsigned)boxes.size();
+        order.resize(n);
+        for (unsigned i = 0; i < n; ++i) {
+            order[i] = i;
+        }
+        const float* minX = boxes.minX.data();
+        std::sort(order.begin(), order.end(), [minX](unsigned a, unsigned b) {
+            return minX[a] < minX[b];
+        });
+
+        for (unsigned i = 0; i < n; ++i) {
+            unsigned a = order[i];
+            float maxXA = boxes.maxX[a];
+            float minXA = boxes.minX[a];
+            float minYA = boxes.minY[a];
+            float maxYA = boxes.maxY[a];
+
+            // Every later box starts no further left, so the first one that
+            // starts at or past a's right edge ends the sweep for a.
+            for (unsigned j = i + 1; j < n; ++j) {
+                unsigned b = order[j];
+                if (boxes.minX[b] >= maxXA) {
+                    break;
+                }
+                if (minXA < boxes.maxX[b] && minYA < boxes.maxY[b] && boxes.minY[b] < maxYA) {
+                    pairs.push_back(a < b ? IndexPair(a, b) : IndexPair(b, a));
+                }
+            }
+        }
+    }
+}
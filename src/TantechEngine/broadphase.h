@@ -0,0 +1,35 @@
+#ifndef TE_BROADPHASE_H
+#define TE_BROADPHASE_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace te
+{
+    struct BoundingBox;
+
+    // Axis aligned boxes kept as one array per bound, so the sweep only
+    // streams through the values it compares.
+    struct AABBArray {
+        std::vector<float> minX;
+        std::vector<float> minY;
+        std::vector<float> maxX;
+        std::vector<float> maxY;
+
+        void clear();
+        void reserve(std::size_t n);
+        void push(const BoundingBox& bb);
+        std::size_t size() const;
+        BoundingBox get(std::size_t i) const;
+    };
+
+    typedef std::pair<unsigned, unsigned> IndexPair;
+
+    // Sweep and prune along x. Replaces pairs with every pair of boxes whose
+    // interiors overlap, each once with the lower index first, matching
+    // checkCollision. order is scratch space kept by the caller.
+    void sweepAndPrune(const AABBArray& boxes, std::vector<IndexPair>& pairs, std::vector<unsigned>& order);
+}
+
+#endif
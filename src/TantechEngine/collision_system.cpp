@@ -14,6 +14,10 @@ namespace te
         ObserverList&& observers)
         : mpBoundingBox(pBoundingBox)
         , mObservers(std::move(observers))
+        , mBoxes()
+        , mEntities()
+        , mPairs()
+        , mOrder()
     {}
 
     void CollisionSystem::update(float dt) const
@@ -21,21 +25,26 @@ namespace te
         BoundingBoxComponent& bbcomponent = *mpBoundingBox;
         const ObserverList& observers = mObservers;
 
-        bbcomponent.forEach([&bbcomponent, &observers, dt](const Entity& entityA, BBInstance instanceA)
+        // Transform every box once, then only test pairs the sweep finds.
+        mBoxes.clear();
+        mEntities.clear();
+        bbcomponent.forEach([this, &bbcomponent](const Entity& entity, BBInstance& instance)
         {
-            bbcomponent.forEach([&entityA, &bbcomponent, &observers, dt](const Entity& entityB, BBInstance& instanceB)
+            mBoxes.push(bbcomponent.getBoundingBox(entity, instance));
+            mEntities.push_back(entity);
+        });
+
+        sweepAndPrune(mBoxes, mPairs, mOrder);
+
+        for (const IndexPair& pair : mPairs)
+        {
+            const Entity& entityA = mEntities[pair.first];
+            const Entity& entityB = mEntities[pair.second];
+            std::for_each(std::begin(observers), std::end(observers), [&entityA, &entityB, dt](std::shared_ptr<Observer<CollisionEvent>> pObserver)
             {
-                if (entityA != entityB &&
-                    checkCollision(bbcomponent.getBoundingBox(entityA),
-                                   bbcomponent.getBoundingBox(entityB)))
-                {
-                    std::for_each(std::begin(observers), std::end(observers), [&entityA, &entityB, dt](std::shared_ptr<Observer<CollisionEvent>> pObserver)
-                    {
-                        pObserver->onNotify({entityA, entityB, dt});
-                    });
-                }
+                pObserver->onNotify({entityA, entityB, dt});
             });
-        });
+        }
     }
 
     MapCollisionSystem::MapCollisionSystem(
@@ -5,6 +5,7 @@
 #include <memory>
 #include "entity_manager.h"
 #include "observer.h"
+#include "broadphase.h"
 
 namespace te
 {
@@ -28,11 +29,18 @@ namespace te
             std::shared_ptr<BoundingBoxComponent> pBoundingBox,
             ObserverList&& observers);
 
+        // Notifies once per overlapping pair.
         void update(float dt) const;
 
     private:
         std::shared_ptr<BoundingBoxComponent> mpBoundingBox;
         ObserverList mObservers;
+
+        // Rebuilt every update, kept to reuse their storage.
+        mutable AABBArray mBoxes;
+        mutable std::vector<Entity> mEntities;
+        mutable std::vector<IndexPair> mPairs;
+        mutable std::vector<unsigned> mOrder;
     };
 
     struct MapCollisionEvent
@@ -1,6 +1,8 @@
 #include "ecs.h"
 
 #include "shader.h"
+#include "job_pool.h"
+#include "asset_pools.h"
 #include "texture_manager.h"
 #include "mesh_manager.h"
 #include "animation_factory.h"
@@ -9,6 +11,8 @@
 #include "animation_component.h"
 #include "data_component.h"
 #include "command_component.h"
+#include "bounding_box_component.h"
+#include "spatial_index.h"
 #include "entity_manager.h"
 #include "command_system.h"
 #include "render_system.h"
@@ -20,8 +24,10 @@ namespace te
     {}
 
     AssetManager::AssetManager(std::shared_ptr<const TMX> pTMX)
-        : pTextureManager(new TextureManager())
-        , pMeshManager(new MeshManager(pTMX, pTextureManager))
+        : pJobPool(new JobPool())
+        , pPools(new AssetPools())
+        , pTextureManager(new TextureManager(pPools, pJobPool))
+        , pMeshManager(new MeshManager(pTMX, pTextureManager, pPools))
         , pAnimationFactory(new AnimationFactory(pTMX, pMeshManager))
     {}
 
@@ -30,12 +36,19 @@ namespace te
         , pAnimationComponent(new AnimationComponent())
         , pDataComponent(new DataComponent())
         , pCommandComponent(new CommandComponent())
+        , pBoundingBoxComponent(new BoundingBoxComponent(pTransformComponent))
+        , pSpatialIndex(new SpatialIndex(pBoundingBoxComponent))
         , pEntityManager(new EntityManager(EntityManager::ObserverVector{
               pTransformComponent,
               pAnimationComponent,
-              pDataComponent
+              pDataComponent,
+              pBoundingBoxComponent,
+              pSpatialIndex
           }))
-    {}
+    {
+        pTransformComponent->addObserver(pSpatialIndex);
+        pBoundingBoxComponent->addObserver(pSpatialIndex);
+    }
 
     void processInput(const ECSWatchers& watchers, char ch, InputType type)
     {
@@ -53,12 +66,12 @@ namespace te
         watchers.pRenderSystem->draw(viewTransform * watchers.pCamera->getView());
     }
 
-    ECSWatchers::ECSWatchers(ECS& ecs, std::shared_ptr<const Shader> pShader)
+    ECSWatchers::ECSWatchers(ECS& ecs, std::shared_ptr<const Shader> pShader, std::shared_ptr<const AssetPools> pPools, std::shared_ptr<TextureManager> pTextureManager)
         : pCamera(new Camera(ecs))
         , pCommandSystem(new CommandSystem(ecs))
         , pInputSystem(new InputSystem(pCommandSystem))
-        , pRenderSystem(new RenderSystem(ecs, pShader))
+        , pRenderSystem(new RenderSystem(ecs, pShader, pPools, pTextureManager))
     {
-        assert(pShader);
+        assert(pShader && pPools && pTextureManager);
     }
 }
@@ -12,11 +12,15 @@ namespace te
 
     class Shader;
 
+    class JobPool;
+    struct AssetPools;
     class TextureManager;
     class MeshManager;
     class AnimationFactory;
 
     struct AssetManager {
+        const std::shared_ptr<JobPool> pJobPool;
+        const std::shared_ptr<AssetPools> pPools;
         const std::shared_ptr<TextureManager> pTextureManager;
         const std::shared_ptr<MeshManager> pMeshManager;
         const std::shared_ptr<AnimationFactory> pAnimationFactory;
@@ -29,6 +33,8 @@ namespace te
     class AnimationComponent;
     class DataComponent;
     class CommandComponent;
+    class BoundingBoxComponent;
+    class SpatialIndex;
 
     class EntityManager;
 
@@ -39,6 +45,8 @@ namespace te
         const std::shared_ptr<AnimationComponent> pAnimationComponent;
         const std::shared_ptr<DataComponent> pDataComponent;
         const std::shared_ptr<CommandComponent> pCommandComponent;
+        const std::shared_ptr<BoundingBoxComponent> pBoundingBoxComponent;
+        const std::shared_ptr<SpatialIndex> pSpatialIndex;
 
         const std::shared_ptr<EntityManager> pEntityManager;
     };
@@ -49,7 +57,7 @@ namespace te
     class RenderSystem;
 
     struct ECSWatchers {
-        ECSWatchers(ECS& ecs, std::shared_ptr<const Shader>);
+        ECSWatchers(ECS& ecs, std::shared_ptr<const Shader>, std::shared_ptr<const AssetPools>, std::shared_ptr<TextureManager>);
 
         const std::shared_ptr<Camera> pCamera;
         const std::shared_ptr<CommandSystem> pCommandSystem;
@@ -69,6 +77,9 @@ namespace te
         ~LuaStateECS();
 
         void loadScript(const std::string& path) const;
+        // Runs bytecode from compileLuaAsset, which may have been compiled
+        // on another thread.
+        void loadScript(const std::string& path, const std::string& bytecode) const;
         void runScript() const;
         void runConsole() const;
     private:
@@ -0,0 +1,254 @@
+#include "image_ops.h"
+#include "job_pool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define TE_IMAGE_OPS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace te
+{
+    // Rows are handed out in blocks of roughly this many pixels, small enough
+    // to balance a 512x512 sheet over a few threads.
+    static const GLuint PIXELS_PER_BLOCK = 16384;
+
+    static std::size_t rowGrain(GLuint width)
+    {
+        return std::max<std::size_t>(1, PIXELS_PER_BLOCK / std::max<GLuint>(width, 1));
+    }
+
+    static GLuint packRGBA(GLubyte r, GLubyte g, GLubyte b, GLubyte a)
+    {
+        return (GLuint)r | ((GLuint)g << 8) | ((GLuint)b << 16) | ((GLuint)a << 24);
+    }
+
+    static GLubyte premultiplyChannel(GLuint channel, GLuint alpha)
+    {
+        // Exact round(channel * alpha / 255) without a divide.
+        GLuint t = channel * alpha + 128;
+        return (GLubyte)((t + (t >> 8)) >> 8);
+    }
+
+    static GLubyte luminance(GLuint pixel)
+    {
+        // 54 + 183 + 19 = 256, fixed point for 0.2127, 0.7152 and 0.0722.
+        return (GLubyte)((54 * (pixel & 0xff) + 183 * ((pixel >> 8) & 0xff) + 19 * ((pixel >> 16) & 0xff) + 128) >> 8);
+    }
+
+#ifdef TE_IMAGE_OPS_SSE2
+    static __m128i premultiply16(const __m128i& channels)
+    {
+        // Two pixels as eight 16 bit lanes; alpha is lanes 3 and 7 and is
+        // multiplied by 255 so it survives unchanged.
+        const __m128i rgbLanes = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+        const __m128i alphaLanes = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+        const __m128i bias = _mm_set1_epi16(128);
+
+        __m128i alpha = _mm_shufflelo_epi16(channels, _MM_SHUFFLE(3, 3, 3, 3));
+        alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+        alpha = _mm_or_si128(_mm_and_si128(alpha, rgbLanes), alphaLanes);
+
+        __m128i t = _mm_add_epi16(_mm_mullo_epi16(channels, alpha), bias);
+        return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+    }
+#endif
+
+    void applyColorKey(GLuint* pixels, GLuint width, GLuint height,
+        GLubyte r, GLubyte g, GLubyte b, GLubyte a, JobPool* pPool)
+    {
+        const GLuint mask = a == 0 ? 0x00ffffff : 0xffffffff;
+        const GLuint key = packRGBA(r, g, b, a) & mask;
+        const GLuint transparent = packRGBA(255, 255, 255, 0);
+
+        parallelFor(pPool, 0, height, rowGrain(width), [=](std::size_t rowBegin, std::size_t rowEnd)
+        {
+            GLuint* it = pixels + rowBegin * width;
+            GLuint* end = pixels + rowEnd * width;
+#ifdef TE_IMAGE_OPS_SSE2
+            const __m128i vMask = _mm_set1_epi32((int)mask);
+            const __m128i vKey = _mm_set1_epi32((int)key);
+            const __m128i vTransparent = _mm_set1_epi32((int)transparent);
+            for (; end - it >= 4; it += 4) {
+                __m128i px = _mm_loadu_si128((const __m128i*)it);
+                __m128i match = _mm_cmpeq_epi32(_mm_and_si128(px, vMask), vKey);
+                px = _mm_or_si128(_mm_and_si128(match, vTransparent), _mm_andnot_si128(match, px));
+                _mm_storeu_si128((__m128i*)it, px);
+            }
+#endif
+            for (; it != end; ++it) {
+                if ((*it & mask) == key) *it = transparent;
+            }
+        });
+    }
+
+    void premultiplyAlpha(GLuint* pixels, GLuint width, GLuint height, JobPool* pPool)
+    {
+        parallelFor(pPool, 0, height, rowGrain(width), [=](std::size_t rowBegin, std::size_t rowEnd)
+        {
+            GLuint* it = pixels + rowBegin * width;
+            GLuint* end = pixels + rowEnd * width;
+#ifdef TE_IMAGE_OPS_SSE2
+            const __m128i zero = _mm_setzero_si128();
+            for (; end - it >= 4; it += 4) {
+                __m128i px = _mm_loadu_si128((const __m128i*)it);
+                __m128i lo = premultiply16(_mm_unpacklo_epi8(px, zero));
+                __m128i hi = premultiply16(_mm_unpackhi_epi8(px, zero));
+                _mm_storeu_si128((__m128i*)it, _mm_packus_epi16(lo, hi));
+            }
+#endif
+            for (; it != end; ++it) {
+                GLuint alpha = *it >> 24;
+                *it = packRGBA(
+                    premultiplyChannel(*it & 0xff, alpha),
+                    premultiplyChannel((*it >> 8) & 0xff, alpha),
+                    premultiplyChannel((*it >> 16) & 0xff, alpha),
+                    (GLubyte)alpha);
+            }
+        });
+    }
+
+    template <typename Pixel>
+    static std::vector<Pixel> padCanvas(const Pixel* pixels, GLuint width, GLuint height,
+        GLuint texWidth, GLuint texHeight, Pixel fill, JobPool* pPool)
+    {
+        if (texWidth < width || texHeight < height) {
+            throw std::runtime_error("padCanvas: Canvas is smaller than image.");
+        }
+
+        std::vector<Pixel> canvas(texWidth * texHeight);
+        Pixel* pCanvas = canvas.data();
+
+        parallelFor(pPool, 0, texHeight, rowGrain(texWidth), [=](std::size_t rowBegin, std::size_t rowEnd)
+        {
+            for (std::size_t y = rowBegin; y < rowEnd; ++y) {
+                Pixel* row = pCanvas + y * texWidth;
+                if (y < height) {
+                    std::memcpy(row, pixels + y * width, width * sizeof(Pixel));
+                    std::fill(row + width, row + texWidth, fill);
+                } else {
+                    std::fill(row, row + texWidth, fill);
+                }
+            }
+        });
+
+        return canvas;
+    }
+
+    std::vector<GLuint> padCanvas32(const GLuint* pixels, GLuint width, GLuint height,
+        GLuint texWidth, GLuint texHeight, GLuint fill, JobPool* pPool)
+    {
+        return padCanvas(pixels, width, height, texWidth, texHeight, fill, pPool);
+    }
+
+    std::vector<GLubyte> padCanvas8(const GLubyte* pixels, GLuint width, GLuint height,
+        GLuint texWidth, GLuint texHeight, GLubyte fill, JobPool* pPool)
+    {
+        return padCanvas(pixels, width, height, texWidth, texHeight, fill, pPool);
+    }
+
+    std::vector<GLuint> extrudeTiles(const GLuint* pixels, GLuint width, GLuint height,
+        GLuint tileWidth, GLuint tileHeight, GLuint margin, GLuint spacing, GLuint gutter,
+        GLuint& outWidth, GLuint& outHeight, JobPool* pPool)
+    {
+        if (tileWidth == 0 || tileHeight == 0) {
+            throw std::runtime_error("extrudeTiles: Tile size must be nonzero.");
+        }
+        if (width < 2 * margin + tileWidth || height < 2 * margin + tileHeight) {
+            throw std::runtime_error("extrudeTiles: Image is smaller than one tile.");
+        }
+
+        const GLuint columns = (width - 2 * margin + spacing) / (tileWidth + spacing);
+        const GLuint rows = (height - 2 * margin + spacing) / (tileHeight + spacing);
+        const GLuint cellWidth = tileWidth + 2 * gutter;
+        const GLuint cellHeight = tileHeight + 2 * gutter;
+
+        outWidth = columns * cellWidth;
+        outHeight = rows * cellHeight;
+
+        std::vector<GLuint> sheet(outWidth * outHeight);
+        GLuint* pSheet = sheet.data();
+        const GLuint sheetWidth = outWidth;
+
+        parallelFor(pPool, 0, outHeight, rowGrain(outWidth), [=](std::size_t rowBegin, std::size_t rowEnd)
+        {
+            for (std::size_t y = rowBegin; y < rowEnd; ++y) {
+                // Gutter rows repeat the tile's first or last row.
+                GLuint tileRow = (GLuint)y / cellHeight;
+                int inner = (int)(y % cellHeight) - (int)gutter;
+                GLuint tileY = (GLuint)std::min(std::max(inner, 0), (int)tileHeight - 1);
+                const GLuint* srcRow = pixels + (margin + tileRow * (tileHeight + spacing) + tileY) * width;
+
+                GLuint* dst = pSheet + y * sheetWidth;
+                for (GLuint column = 0; column < columns; ++column) {
+                    const GLuint* src = srcRow + margin + column * (tileWidth + spacing);
+                    dst = std::fill_n(dst, gutter, src[0]);
+                    std::memcpy(dst, src, tileWidth * sizeof(GLuint));
+                    dst += tileWidth;
+                    dst = std::fill_n(dst, gutter, src[tileWidth - 1]);
+                }
+            }
+        });
+
+        return sheet;
+    }
+
+    void rgbaToLuminance(const GLuint* src, GLubyte* dst, GLuint width, GLuint height, JobPool* pPool)
+    {
+        parallelFor(pPool, 0, height, rowGrain(width), [=](std::size_t rowBegin, std::size_t rowEnd)
+        {
+            std::size_t i = rowBegin * width;
+            const std::size_t end = rowEnd * width;
+#ifdef TE_IMAGE_OPS_SSE2
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i weights = _mm_set_epi16(0, 19, 183, 54, 0, 19, 183, 54);
+            const __m128i bias = _mm_set1_epi32(128);
+            for (; end - i >= 4; i += 4) {
+                __m128i px = _mm_loadu_si128((const __m128i*)(src + i));
+                // Each pixel yields two partial sums, r+g and b+a.
+                __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(px, zero), weights);
+                __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(px, zero), weights);
+                __m128i t0 = _mm_unpacklo_epi32(lo, hi);
+                __m128i t1 = _mm_unpackhi_epi32(lo, hi);
+                __m128i sum = _mm_add_epi32(_mm_unpacklo_epi64(t0, t1), _mm_unpackhi_epi64(t0, t1));
+                sum = _mm_shuffle_epi32(sum, _MM_SHUFFLE(3, 1, 2, 0));
+                sum = _mm_srli_epi32(_mm_add_epi32(sum, bias), 8);
+                sum = _mm_packs_epi32(sum, sum);
+                int packed = _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+                std::memcpy(dst + i, &packed, 4);
+            }
+#endif
+            for (; i != end; ++i) {
+                dst[i] = luminance(src[i]);
+            }
+        });
+    }
+
+    void luminanceToRgba(const GLubyte* src, GLuint* dst, GLuint width, GLuint height, JobPool* pPool)
+    {
+        parallelFor(pPool, 0, height, rowGrain(width), [=](std::size_t rowBegin, std::size_t rowEnd)
+        {
+            std::size_t i = rowBegin * width;
+            const std::size_t end = rowEnd * width;
+#ifdef TE_IMAGE_OPS_SSE2
+            const __m128i opaque = _mm_set1_epi32((int)0xff000000);
+            for (; end - i >= 16; i += 16) {
+                __m128i l = _mm_loadu_si128((const __m128i*)(src + i));
+                __m128i lo = _mm_unpacklo_epi8(l, l);
+                __m128i hi = _mm_unpackhi_epi8(l, l);
+                __m128i* out = (__m128i*)(dst + i);
+                _mm_storeu_si128(out + 0, _mm_or_si128(_mm_unpacklo_epi16(lo, lo), opaque));
+                _mm_storeu_si128(out + 1, _mm_or_si128(_mm_unpackhi_epi16(lo, lo), opaque));
+                _mm_storeu_si128(out + 2, _mm_or_si128(_mm_unpacklo_epi16(hi, hi), opaque));
+                _mm_storeu_si128(out + 3, _mm_or_si128(_mm_unpackhi_epi16(hi, hi), opaque));
+            }
+#endif
+            for (; i != end; ++i) {
+                dst[i] = packRGBA(src[i], src[i], src[i], 255);
+            }
+        });
+    }
+}
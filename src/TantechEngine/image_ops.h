@@ -0,0 +1,42 @@
+#ifndef TE_IMAGE_OPS_H
+#define TE_IMAGE_OPS_H
+
+#include "gl.h"
+
+#include <vector>
+
+namespace te
+{
+    class JobPool;
+
+    // Kernels work on tightly packed images. 32-bit pixels are RGBA in memory
+    // order, 8-bit pixels are luminance. Rows are split across pPool when one
+    // is given, otherwise the kernel runs on the calling thread.
+
+    // Pixels matching r, g, b (and a, unless it is 0) become transparent white.
+    void applyColorKey(GLuint* pixels, GLuint width, GLuint height,
+        GLubyte r, GLubyte g, GLubyte b, GLubyte a = 0, JobPool* pPool = nullptr);
+
+    void premultiplyAlpha(GLuint* pixels, GLuint width, GLuint height, JobPool* pPool = nullptr);
+
+    // Places the image in the upper left of a texWidth by texHeight canvas
+    // and fills the remainder with fill.
+    std::vector<GLuint> padCanvas32(const GLuint* pixels, GLuint width, GLuint height,
+        GLuint texWidth, GLuint texHeight, GLuint fill, JobPool* pPool = nullptr);
+    std::vector<GLubyte> padCanvas8(const GLubyte* pixels, GLuint width, GLuint height,
+        GLuint texWidth, GLuint texHeight, GLubyte fill, JobPool* pPool = nullptr);
+
+    // Repacks a tile sheet so every tile is surrounded by gutter pixels
+    // copied from its own edges, which stops filtering from bleeding in
+    // neighbouring tiles. Margin and spacing describe the source sheet.
+    std::vector<GLuint> extrudeTiles(const GLuint* pixels, GLuint width, GLuint height,
+        GLuint tileWidth, GLuint tileHeight, GLuint margin, GLuint spacing, GLuint gutter,
+        GLuint& outWidth, GLuint& outHeight, JobPool* pPool = nullptr);
+
+    // Rec. 709 weights, matching DevIL's IL_LUMINANCE conversion.
+    void rgbaToLuminance(const GLuint* src, GLubyte* dst, GLuint width, GLuint height, JobPool* pPool = nullptr);
+    // Expands to opaque grey.
+    void luminanceToRgba(const GLubyte* src, GLuint* dst, GLuint width, GLuint height, JobPool* pPool = nullptr);
+}
+
+#endif
@@ -0,0 +1,130 @@
+#include "job_pool.h"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+
+namespace te
+{
+    JobPool::JobPool(unsigned threadCount)
+        : mThreads()
+        , mJobs()
+        , mMutex()
+        , mCondition()
+        , mStopping(false)
+    {
+        if (threadCount == 0) {
+            unsigned hardware = std::thread::hardware_concurrency();
+            threadCount = hardware > 1 ? hardware - 1 : 1;
+        }
+
+        mThreads.reserve(threadCount);
+        for (unsigned i = 0; i < threadCount; ++i) {
+            mThreads.push_back(std::thread([this] { work(); }));
+        }
+    }
+
+    JobPool::~JobPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStopping = true;
+        }
+        mCondition.notify_all();
+        for (auto& thread : mThreads) {
+            thread.join();
+        }
+    }
+
+    std::future<void> JobPool::push(Job job)
+    {
+        // std::function must be copyable, packaged_task isn't.
+        auto pTask = std::make_shared<std::packaged_task<void()>>(std::move(job));
+        std::future<void> future = pTask->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mJobs.push_back([pTask] { (*pTask)(); });
+        }
+        mCondition.notify_one();
+        return future;
+    }
+
+    void JobPool::parallelFor(std::size_t begin, std::size_t end, std::size_t grain, const RangeJob& fn)
+    {
+        if (end <= begin) return;
+
+        std::size_t count = end - begin;
+        grain = std::max<std::size_t>(grain, 1);
+        std::size_t blocks = std::min((count + grain - 1) / grain, mThreads.size() + 1);
+        if (blocks <= 1) {
+            fn(begin, end);
+            return;
+        }
+
+        std::size_t blockSize = (count + blocks - 1) / blocks;
+        std::vector<std::future<void>> pending;
+        pending.reserve(blocks - 1);
+        for (std::size_t blockBegin = begin + blockSize; blockBegin < end; blockBegin += blockSize) {
+            std::size_t blockEnd = std::min(end, blockBegin + blockSize);
+            pending.push_back(push([&fn, blockBegin, blockEnd] { fn(blockBegin, blockEnd); }));
+        }
+
+        // Every block refers to fn, so all must finish before anything
+        // is rethrown.
+        std::exception_ptr pException;
+        try {
+            fn(begin, begin + blockSize);
+        } catch (...) {
+            pException = std::current_exception();
+        }
+        for (auto& future : pending) {
+            wait(future);
+        }
+        if (pException) std::rethrow_exception(pException);
+        for (auto& future : pending) {
+            future.get();
+        }
+    }
+
+    unsigned JobPool::getThreadCount() const
+    {
+        return (unsigned)mThreads.size();
+    }
+
+    void JobPool::work()
+    {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mCondition.wait(lock, [this] { return mStopping || !mJobs.empty(); });
+                if (mJobs.empty()) return;
+                job = std::move(mJobs.front());
+                mJobs.pop_front();
+            }
+            job();
+        }
+    }
+
+    bool JobPool::tryRunOne()
+    {
+        Job job;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mJobs.empty()) return false;
+            job = std::move(mJobs.front());
+            mJobs.pop_front();
+        }
+        job();
+        return true;
+    }
+
+    void parallelFor(JobPool* pPool, std::size_t begin, std::size_t end, std::size_t grain, const JobPool::RangeJob& fn)
+    {
+        if (pPool) {
+            pPool->parallelFor(begin, end, grain, fn);
+        } else if (begin < end) {
+            fn(begin, end);
+        }
+    }
+}
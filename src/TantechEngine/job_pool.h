@@ -0,0 +1,64 @@
+#ifndef TE_JOB_POOL_H
+#define TE_JOB_POOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace te
+{
+    class JobPool {
+    public:
+        typedef std::function<void()> Job;
+        typedef std::function<void(std::size_t, std::size_t)> RangeJob;
+
+        // A thread count of 0 starts one worker per hardware thread,
+        // leaving one for the caller.
+        explicit JobPool(unsigned threadCount = 0);
+        ~JobPool();
+
+        std::future<void> push(Job job);
+
+        // Splits [begin, end) into blocks of at least grain elements and runs
+        // fn(blockBegin, blockEnd) on each. The caller runs a block itself and
+        // helps with queued jobs while it waits, so nesting is safe.
+        // Rethrows the first exception thrown by a block.
+        void parallelFor(std::size_t begin, std::size_t end, std::size_t grain, const RangeJob& fn);
+
+        // Blocks until the future is ready, running queued jobs meanwhile.
+        template <typename Future>
+        void wait(const Future& future)
+        {
+            while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                if (!tryRunOne()) {
+                    future.wait();
+                }
+            }
+        }
+
+        unsigned getThreadCount() const;
+    private:
+        JobPool(const JobPool&) = delete;
+        JobPool& operator=(const JobPool&) = delete;
+
+        void work();
+        bool tryRunOne();
+
+        std::vector<std::thread> mThreads;
+        std::deque<Job> mJobs;
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        bool mStopping;
+    };
+
+    // Runs on pPool when given, otherwise calls fn(begin, end) inline.
+    void parallelFor(JobPool* pPool, std::size_t begin, std::size_t end, std::size_t grain, const JobPool::RangeJob& fn);
+}
+
+#endif
@@ -3,6 +3,11 @@
 #include "tmx.h"
 #include "shader.h"
 #include "tiled_map.h"
+#include "texture_manager.h"
+#include "asset_pools.h"
+#include "asset_pack.h"
+#include "job_pool.h"
+#include "stage_timer.h"
 #include "camera.h"
 #include "command_system.h"
 #include "view.h"
@@ -10,6 +15,7 @@
 #include <glm/gtx/transform.hpp>
 #include <SDL_events.h>
 
+#include <future>
 #include <iostream>
 #include <cassert>
 
@@ -21,21 +27,49 @@ namespace te
     LuaGameState::LuaGameState(const std::shared_ptr<const TMX>& pTMX, const std::shared_ptr<Shader>& pShader, const glm::mat4& model, const AssetManager& assets)
         : GameState()
         , mAssets(assets)
-        , mpTiledMap(new TiledMap(pTMX, pShader, model, assets.pTextureManager.get()))
+        , mScope(mAssets.pPools->beginScope())
+        , mpTiledMap()
         , mECS()
-        , mECSWatchers(mECS, pShader)
+        , mECSWatchers(mECS, pShader, mAssets.pPools, mAssets.pTextureManager)
         , mLuaStateECS(mECS, mECSWatchers)
     {
         assert(pTMX && pShader);
 
-        loadObjects(*pTMX, model, mAssets, mECS);
+        // Stages that need no GL context or Lua state run on workers while
+        // this thread uploads and instantiates.
+        JobPool& pool = *mAssets.pJobPool;
+        std::shared_ptr<StageTimer> pTimer(new StageTimer());
+        std::string scriptPath = pTMX->meta.path + "/main.lua";
+        std::shared_ptr<std::string> pBytecode(new std::string());
+        std::future<void> script = pool.push([pTimer, scriptPath, pBytecode] {
+            pTimer->run("compile main.lua", [&] { *pBytecode = compileLuaAsset(scriptPath); });
+        });
+
+        mpTiledMap.reset(new TiledMap(pTMX, pShader, model, *mAssets.pTextureManager, mAssets.pPools, &pool, pTimer.get()));
+        pTimer->run("objects", [&] { loadObjects(*pTMX, model, mAssets, mECS); });
+
         try {
-            mLuaStateECS.loadScript(pTMX->meta.path + "/main.lua");
-            mLuaStateECS.runScript();
+            pool.wait(script);
+            script.get();
+            pTimer->run("run main.lua", [&] {
+                mLuaStateECS.loadScript(scriptPath, *pBytecode);
+                mLuaStateECS.runScript();
+            });
         } catch (const std::runtime_error& ex) {
             std::clog << "Warning: LuaGameState: Could not load main.lua." << std::endl;
             std::clog << ex.what() << std::endl;
         }
+
+        pTimer->report(std::clog, "LuaGameState: loaded " + pTMX->meta.path);
+    }
+
+    LuaGameState::~LuaGameState()
+    {
+        TextureResidencyStats textureStats = mAssets.pTextureManager->getStats();
+        std::clog << "LuaGameState: textures: " << textureStats.residentCount << " resident in " << textureStats.residentBytes / 1024 << " KB"
+            << " (budget " << textureStats.budgetBytes / 1024 << " KB), "
+            << textureStats.evictions << " evictions, " << textureStats.reloads << " reloads" << std::endl;
+        mAssets.pPools->endScope(mScope);
     }
 
     bool LuaGameState::processInput(const SDL_Event& evt) {
@@ -49,6 +83,7 @@ namespace te
     bool LuaGameState::update(float dt)
     {
         te::update(mECSWatchers, dt);
+        mAssets.pTextureManager->nextFrame();
         return false;
     }
     void LuaGameState::draw()
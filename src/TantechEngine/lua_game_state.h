@@ -3,6 +3,7 @@
 
 #include "game_state.h"
 #include "ecs.h"
+#include "asset_pool.h"
 
 #include <memory>
 
@@ -16,6 +17,7 @@ namespace te
     public:
         LuaGameState(const std::shared_ptr<const TMX>&, const std::shared_ptr<Shader>& pShader, const glm::mat4& model);
         LuaGameState(const std::shared_ptr<const TMX>&, const std::shared_ptr<Shader>& pShader, const glm::mat4& model, const AssetManager&);
+        ~LuaGameState();
 
         bool processInput(const SDL_Event&);
         bool update(float dt);
@@ -25,6 +27,8 @@ namespace te
 
     private:
         AssetManager mAssets;
+        // Everything the level loads is released with it.
+        AssetScope mScope;
         std::shared_ptr<TiledMap> mpTiledMap;
         ECS mECS;
         ECSWatchers mECSWatchers;
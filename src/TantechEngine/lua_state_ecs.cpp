@@ -4,9 +4,12 @@
 #include "data_component.h"
 #include "transform_component.h"
 #include "command_component.h"
+#include "bounding_box_component.h"
+#include "spatial_index.h"
 #include "camera.h"
 #include "command_system.h"
 #include "commands.h"
+#include "asset_pack.h"
 
 #include <lua.hpp>
 #include <LuaBridge.h>
@@ -15,15 +18,31 @@
 
 #include <functional>
 #include <iostream>
+#include <vector>
 
 namespace te
 {
+    static luabridge::LuaRef makeEntityTable(lua_State* L, const std::vector<Entity>& entities, unsigned begin, unsigned end)
+    {
+        luabridge::LuaRef table = luabridge::newTable(L);
+        for (unsigned i = begin; i < end; ++i) {
+            table[i - begin + 1] = entities[i];
+        }
+        return table;
+    }
+
     struct LuaStateECS::Impl {
         // members
         std::unique_ptr<lua_State, std::function<void(lua_State*)>> pL;
         ECS ecs;
         ECSWatchers ecsWatchers;
         luabridge::LuaRef mainRef;
+        // Query results, kept to reuse their storage.
+        std::vector<Entity> entities;
+        std::vector<unsigned> offsets;
+        std::vector<BoundingBox> regions;
+        std::vector<glm::vec3> circles;
+        std::vector<RaycastHit> hits;
 
         // methods for Lua
         Entity getEntity(unsigned tiledId)
@@ -69,6 +88,72 @@ namespace te
             return ecs.pTransformComponent->multiplyTransform(entity, glm::scale(scale));
         }
 
+        void setBoundingBox(const Entity& entity, float w, float h, float offsetX, float offsetY)
+        {
+            ecs.pBoundingBoxComponent->setBoundingBox(entity, glm::vec2(w, h), glm::vec2(offsetX, offsetY));
+        }
+
+        // Spatial queries return arrays of entities, so scripts need not
+        // walk every entity to find what is nearby.
+        luabridge::LuaRef queryRect(float x, float y, float w, float h)
+        {
+            ecs.pSpatialIndex->queryRegion({ x, y, w, h }, entities);
+            return makeEntityTable(pL.get(), entities, 0, entities.size());
+        }
+        luabridge::LuaRef queryRadius(float x, float y, float radius)
+        {
+            ecs.pSpatialIndex->queryRadius(glm::vec2(x, y), radius, entities);
+            return makeEntityTable(pL.get(), entities, 0, entities.size());
+        }
+        luabridge::LuaRef queryNearest(float x, float y, unsigned k)
+        {
+            ecs.pSpatialIndex->queryNearest(glm::vec2(x, y), k, entities);
+            return makeEntityTable(pL.get(), entities, 0, entities.size());
+        }
+        // Returns { { entity = e, distance = d }, ... }, closest first.
+        luabridge::LuaRef raycast(float x, float y, float dx, float dy, float maxDistance)
+        {
+            ecs.pSpatialIndex->raycast(glm::vec2(x, y), glm::vec2(dx, dy), maxDistance, hits);
+            luabridge::LuaRef table = luabridge::newTable(pL.get());
+            for (unsigned i = 0; i < hits.size(); ++i) {
+                luabridge::LuaRef hit = luabridge::newTable(pL.get());
+                hit["entity"] = hits[i].entity;
+                hit["distance"] = hits[i].distance;
+                table[i + 1] = hit;
+            }
+            return table;
+        }
+        // Takes { { x, y, w, h }, ... } and returns one array per rect.
+        luabridge::LuaRef queryRects(luabridge::LuaRef rects)
+        {
+            regions.clear();
+            for (int i = 1; i <= rects.length(); ++i) {
+                luabridge::LuaRef rect = rects[i];
+                regions.push_back({ rect[1].cast<float>(), rect[2].cast<float>(), rect[3].cast<float>(), rect[4].cast<float>() });
+            }
+            ecs.pSpatialIndex->queryRegions(regions, entities, offsets);
+            return makeResultTables(regions.size());
+        }
+        // Takes { { x, y, radius }, ... } and returns one array per circle.
+        luabridge::LuaRef queryRadii(luabridge::LuaRef centers)
+        {
+            circles.clear();
+            for (int i = 1; i <= centers.length(); ++i) {
+                luabridge::LuaRef circle = centers[i];
+                circles.push_back(glm::vec3(circle[1].cast<float>(), circle[2].cast<float>(), circle[3].cast<float>()));
+            }
+            ecs.pSpatialIndex->queryRadii(circles, entities, offsets);
+            return makeResultTables(circles.size());
+        }
+        luabridge::LuaRef makeResultTables(unsigned count)
+        {
+            luabridge::LuaRef table = luabridge::newTable(pL.get());
+            for (unsigned i = 0; i < count; ++i) {
+                table[i + 1] = makeEntityTable(pL.get(), entities, offsets[i], offsets[i + 1]);
+            }
+            return table;
+        }
+
         void printEntities()
         {
             ecs.pDataComponent->forEach([](const Entity& entity, const DataInstance& instance) {
@@ -88,9 +173,15 @@ namespace te
             , ecs(ecs)
             , ecsWatchers(watchers)
             , mainRef(luabridge::LuaRef(pL.get()))
+            , entities()
+            , offsets()
+            , regions()
+            , circles()
+            , hits()
         {
             lua_State* L = pL.get();
             luaL_openlibs(L);
+            openAssetLoaders(L);
             luabridge::getGlobalNamespace(L)
                 .beginNamespace("tt")
 
@@ -115,6 +206,13 @@ namespace te
                         .addFunction("translateWorldv", &Impl::translateWorldv)
                         .addFunction("scalef", &Impl::scalef)
                         .addFunction("scalev", &Impl::scalev)
+                        .addFunction("setBoundingBox", &Impl::setBoundingBox)
+                        .addFunction("queryRect", &Impl::queryRect)
+                        .addFunction("queryRadius", &Impl::queryRadius)
+                        .addFunction("queryNearest", &Impl::queryNearest)
+                        .addFunction("raycast", &Impl::raycast)
+                        .addFunction("queryRects", &Impl::queryRects)
+                        .addFunction("queryRadii", &Impl::queryRadii)
                         .addFunction("printEntities", &Impl::printEntities)
                     .endClass()
 
@@ -134,20 +232,35 @@ namespace te
         delete mpImpl;
     }
 
+    static luabridge::LuaRef getMainFunction(lua_State* L)
+    {
+        luabridge::LuaRef mainRef(luabridge::getGlobal(L, "main"));
+        if (mainRef.isNil() || !mainRef.isFunction()) {
+            throw std::runtime_error("LuaStateECS::loadScript: Could not find main function.");
+        }
+        return mainRef;
+    }
+
     void LuaStateECS::loadScript(const std::string& path) const
     {
         lua_State* L = mpImpl->pL.get();
-        int status = luaL_dofile(L, path.c_str());
+        int status = doLuaAsset(L, path);
         if (status) {
             throw std::runtime_error("LuaStateECS::loadScript: Could not load Lua script.");
         }
 
-        luabridge::LuaRef mainRef(luabridge::getGlobal(L, "main"));
-        if (mainRef.isNil() || !mainRef.isFunction()) {
-            throw std::runtime_error("LuaStateECS::loadScript: Could not find main function.");
+        mpImpl->mainRef = getMainFunction(L);
+    }
+
+    void LuaStateECS::loadScript(const std::string& path, const std::string& bytecode) const
+    {
+        lua_State* L = mpImpl->pL.get();
+        int status = loadLuaBytecode(L, bytecode, path) || lua_pcall(L, 0, LUA_MULTRET, 0);
+        if (status) {
+            throw std::runtime_error("LuaStateECS::loadScript: Could not load Lua script.");
         }
 
-        mpImpl->mainRef = mainRef;
+        mpImpl->mainRef = getMainFunction(L);
     }
 
     void LuaStateECS::runScript() const
@@ -163,7 +276,7 @@ namespace te
     void LuaStateECS::runConsole() const
     {
         lua_State* L = mpImpl->pL.get();
-        int status = luaL_dofile(L, "assets/lua/console.lua");
+        int status = doLuaAsset(L, "assets/lua/console.lua");
         if (status) {
             throw std::runtime_error("LuaGameState::runConsole: Could not load console.lua");
         }
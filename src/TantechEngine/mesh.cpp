@@ -4,7 +4,7 @@ namespace te
 {
     Mesh::Mesh(const std::vector<Vertex>& vertices,
         const std::vector<GLuint>& indices,
-        const std::vector<std::shared_ptr<const Texture>>& textures)
+        const std::vector<TextureHandle>& textures)
         : mVAO(0), mVBO(0), mEBO(0), mElementCount(indices.size()), mTextures(textures)
     {
         glGenVertexArrays(1, &mVAO);
@@ -92,8 +92,13 @@ namespace te
         return mElementCount;
     }
 
-    std::shared_ptr<const Texture> Mesh::getTexture(unsigned i) const
+    TextureHandle Mesh::getTexture(unsigned i) const
     {
         return mTextures.at(i);
     }
+
+    const std::vector<TextureHandle>& Mesh::getTextures() const
+    {
+        return mTextures;
+    }
 }
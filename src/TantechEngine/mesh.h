@@ -2,6 +2,7 @@
 #define TE_MESH_H
 
 #include "gl.h"
+#include "texture.h"
 #include <glm/glm.hpp>
 
 #include <vector>
@@ -9,8 +10,6 @@
 
 namespace te
 {
-    class Texture;
-
     struct Vertex {
         struct Position {
             GLfloat x;
@@ -27,7 +26,7 @@ namespace te
     public:
         Mesh(const std::vector<Vertex>& vertices,
              const std::vector<GLuint>& indices,
-             const std::vector<std::shared_ptr<const Texture>>& textures);
+             const std::vector<TextureHandle>& textures);
         ~Mesh();
         Mesh(Mesh&&);
         Mesh& operator=(Mesh&&);
@@ -36,18 +35,21 @@ namespace te
         GLuint getVBO() const;
         GLuint getEBO() const;
         GLsizei getElementCount() const;
-        std::shared_ptr<const Texture> getTexture(unsigned i) const;
+        TextureHandle getTexture(unsigned i) const;
+        const std::vector<TextureHandle>& getTextures() const;
 
     private:
         void destroy();
 
         GLuint mVAO, mVBO, mEBO;
         GLsizei mElementCount;
-        std::vector<std::shared_ptr<const Texture>> mTextures;
+        std::vector<TextureHandle> mTextures;
 
         Mesh(const Mesh&) = delete;
         Mesh& operator=(const Mesh&) = delete;
     };
+
+    typedef Handle<Mesh> MeshHandle;
 }
 
 #endif
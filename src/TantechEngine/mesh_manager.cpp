@@ -4,22 +4,24 @@
 #include "texture_manager.h"
 #include "texture.h"
 #include "mesh.h"
+#include "asset_pools.h"
 
 #include <vector>
 #include <algorithm>
 
 namespace te
 {
-    MeshManager::MeshManager(std::shared_ptr<const TMX> pTMX, std::shared_ptr<TextureManager> pTextureManager)
+    MeshManager::MeshManager(std::shared_ptr<const TMX> pTMX, std::shared_ptr<TextureManager> pTextureManager, std::shared_ptr<AssetPools> pPools)
         : mpTMX(pTMX)
         , mpTextureManager(pTextureManager)
+        , mpPools(pPools)
         , mMeshes()
     {}
 
-    std::shared_ptr<const Mesh> MeshManager::operator[](unsigned gid)
+    MeshHandle MeshManager::operator[](unsigned gid)
     {
         auto it = mMeshes.find(gid);
-        if (it != mMeshes.end()) {
+        if (it != mMeshes.end() && mpPools->meshes.contains(it->second)) {
             return it->second;
         }
         else {
@@ -28,7 +30,7 @@ namespace te
 
             unsigned tilesetIndex = getTilesetIndex(tmx, gid);
             const TMX::Tileset& tileset = tmx.tilesets.at(tilesetIndex);
-            std::shared_ptr<Texture> pTexture(textureManager[tileset.image]);
+            TextureHandle texture = textureManager[tileset.image];
 
             std::vector<Vertex> vertices(4);
             vertices[0].position = { 0, 0, 0 };
@@ -61,16 +63,13 @@ namespace te
             indices[4] = 2;
             indices[5] = 3;
 
-            std::vector<std::shared_ptr<const Texture>> textures;
-            textures.push_back(pTexture);
+            std::vector<TextureHandle> textures;
+            textures.push_back(texture);
 
-            std::shared_ptr<const Mesh> pMesh(new Mesh(vertices, indices, textures));
-            mMeshes.insert(std::pair<unsigned, std::shared_ptr<const Mesh>>{
-                gid,
-                pMesh
-            });
+            MeshHandle mesh = mpPools->meshes.insert(Mesh(vertices, indices, textures), mpPools->getScope());
+            mMeshes[gid] = mesh;
 
-            return pMesh;
+            return mesh;
         }
     }
 }
@@ -1,6 +1,8 @@
 #ifndef TE_MESH_MANAGER_H
 #define TE_MESH_MANAGER_H
 
+#include "mesh.h"
+
 #include <map>
 #include <memory>
 
@@ -8,17 +10,20 @@ namespace te
 {
     struct TMX;
     class TextureManager;
-    class Mesh;
+    struct AssetPools;
 
+    // Builds the quad for a tile on first use and keeps its handle. Meshes
+    // whose scope has ended are built again.
     class MeshManager {
     public:
-        MeshManager(std::shared_ptr<const TMX>, std::shared_ptr<TextureManager>);
+        MeshManager(std::shared_ptr<const TMX>, std::shared_ptr<TextureManager>, std::shared_ptr<AssetPools>);
 
-        std::shared_ptr<const Mesh> operator[](unsigned);
+        MeshHandle operator[](unsigned);
     private:
         std::shared_ptr<const TMX> mpTMX;
         std::shared_ptr<TextureManager> mpTextureManager;
-        std::map<unsigned, std::shared_ptr<const Mesh>> mMeshes;
+        std::shared_ptr<AssetPools> mpPools;
+        std::map<unsigned, MeshHandle> mMeshes;
 
         MeshManager(const MeshManager&) = delete;
         MeshManager& operator=(const MeshManager&) = delete;
@@ -1,19 +1,21 @@
 #include "model.h"
 #include "shader.h"
+#include "asset_pools.h"
+#include "texture_manager.h"
 
 #include <algorithm>
 
 namespace te
 {
-    Model::Model(const std::vector<std::shared_ptr<const Mesh>>& meshes)
+    Model::Model(const std::vector<MeshHandle>& meshes)
         : mMeshes(meshes) {}
-    Model::Model(std::vector<std::shared_ptr<const Mesh>>&& meshes)
+    Model::Model(std::vector<MeshHandle>&& meshes)
         : mMeshes(std::move(meshes)) {}
 
-    void Model::draw(const Shader& shader, const glm::mat4& view) const
+    void Model::draw(const Shader& shader, const AssetPools& pools, TextureManager& textures, const glm::mat4& view) const
     {
-        std::for_each(std::begin(mMeshes), std::end(mMeshes), [&](const std::shared_ptr<const Mesh>& pMesh) {
-            shader.draw(view, *pMesh);
+        std::for_each(std::begin(mMeshes), std::end(mMeshes), [&](MeshHandle mesh) {
+            shader.draw(view, pools.meshes[mesh], textures.use(pools.meshes[mesh].getTexture(0)));
         });
     }
 }
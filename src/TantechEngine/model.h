@@ -1,24 +1,26 @@
 #ifndef TE_MODEL_H
 #define TE_MODEL_H
 
+#include "mesh.h"
+
 #include <glm/glm.hpp>
 
 #include <vector>
-#include <memory>
 
 namespace te
 {
-    class Mesh;
     class Shader;
+    class TextureManager;
+    struct AssetPools;
 
     class Model {
     public:
-        Model(const std::vector<std::shared_ptr<const Mesh>>& meshes);
-        Model(std::vector<std::shared_ptr<const Mesh>>&& meshes);
+        Model(const std::vector<MeshHandle>& meshes);
+        Model(std::vector<MeshHandle>&& meshes);
 
-        void draw(const Shader& shader, const glm::mat4& modelview) const;
+        void draw(const Shader& shader, const AssetPools& pools, TextureManager& textures, const glm::mat4& modelview) const;
     private:
-        std::vector<std::shared_ptr<const Mesh>> mMeshes;
+        std::vector<MeshHandle> mMeshes;
     };
 }
 
@@ -31,7 +31,10 @@ namespace te
         void addObserver(std::shared_ptr<Observer<EventType>> newObserver)
         {
             assert(newObserver);
-            if (std::find(mObservers.begin(), mObservers.end(), newObserver) == mObservers.end()) {
+            auto isNew = std::find_if(mObservers.begin(), mObservers.end(), [&newObserver](const std::weak_ptr<Observer<EventType>>& wpObserver) {
+                return wpObserver.lock() == newObserver;
+            }) == mObservers.end();
+            if (isNew) {
                 mObservers.push_back(newObserver);
             }
         }
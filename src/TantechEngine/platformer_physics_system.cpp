@@ -5,6 +5,8 @@
 #include "tiled_map.h"
 #include <glm/gtx/transform.hpp>
 
+#include <algorithm>
+
 namespace te
 {
     PlatformerPhysicsSystem::PlatformerPhysicsSystem(
@@ -25,32 +27,40 @@ namespace te
         mpPhysics->forEach([dt, padding, this](const Entity& entity, PhysicsInstance& instance)
         {
             instance.velocity += dt * mGravityAcceleration;
-            glm::vec3 directionVector(dt * glm::vec3(instance.velocity.x, instance.velocity.y, 0));
-            mpTransform->setLocalTransform(
-                entity,
-                glm::translate(mpTransform->getLocalTransform(entity), directionVector));
 
-            while (mpTiledMap->getIntersections(mpBoundingBox->getBoundingBox(entity), mIntersections).size() > 0)
+            BoundingBox bb = mpBoundingBox->getBoundingBox(entity);
+            glm::vec2 remaining = dt * instance.velocity;
+            glm::vec2 moved(0.f);
+            for (int slide = 0; slide < MAX_SLIDES && (remaining.x != 0 || remaining.y != 0); ++slide)
             {
-                instance.velocity.y = 0;
-                BoundingBox& intersection = mIntersections[0];
-                float translateX = 0, translateY = 0;
-                if (intersection.w < intersection.h)
+                glm::vec2 normal;
+                float toi = mpTiledMap->sweep(bb, remaining, normal);
+                if (toi < 1.f)
                 {
-                    translateX = directionVector.x > 0 ?
-                        -intersection.w - padding: // padding prevents floating point errors
-                        intersection.w + padding;
+                    // Stop short of the contact so rounding never leaves
+                    // the box inside the tile.
+                    toi = std::max(0.f, toi - padding / glm::length(remaining));
                 }
-                else
+
+                glm::vec2 step = toi * remaining;
+                bb.x += step.x;
+                bb.y += step.y;
+                moved += step;
+                if (normal == glm::vec2(0.f)) { break; }
+
+                // Keep moving along the surface hit, but not into it.
+                remaining -= step;
+                remaining -= glm::dot(remaining, normal) * normal;
+                float into = glm::dot(instance.velocity, normal);
+                if (into < 0)
                 {
-                    translateY = directionVector.y > 0 ?
-                        -intersection.h - padding :
-                        intersection.h + padding;
+                    instance.velocity -= into * normal;
                 }
-                mpTransform->setLocalTransform(
-                    entity,
-                    glm::translate(mpTransform->getLocalTransform(entity), glm::vec3(translateX, translateY, 0)));
-                mIntersections.clear();
+            }
+
+            if (moved != glm::vec2(0.f))
+            {
+                mpTransform->multiplyTransform(entity, glm::translate(glm::vec3(moved, 0)), TransformComponent::Space::WORLD);
             }
         });
     }
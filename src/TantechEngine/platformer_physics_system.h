@@ -22,7 +22,14 @@ namespace te
             std::shared_ptr<TiledMap> pTiledMap,
             float gravityAcceleration);
 
-        void update(float dt, float padding = 0.001);
+        // Sweeps each body's box through the map, sliding along whatever it
+        // hits, so no step is too long to tunnel through a tile. padding
+        // keeps bodies that distance short of what they hit.
+        void update(float dt, float padding = 0.001f);
+
+        // A body can slide along a wall and then land in one step, and
+        // stops there for the rest of the step.
+        static const int MAX_SLIDES = 3;
 
     private:
         std::shared_ptr<PhysicsComponent> mpPhysics;
@@ -30,7 +37,6 @@ namespace te
         std::shared_ptr<BoundingBoxComponent> mpBoundingBox;
         std::shared_ptr<TiledMap> mpTiledMap;
         glm::vec2 mGravityAcceleration;
-        std::vector<BoundingBox> mIntersections;
     };
 }
 
@@ -4,7 +4,8 @@
 #include "animation_component.h"
 #include "shader.h"
 #include "texture.h"
-#include "model.h"
+#include "asset_pools.h"
+#include "texture_manager.h"
 
 #include <glm/gtc/type_ptr.hpp>
 
@@ -12,22 +13,28 @@ namespace te
 {
     RenderSystem::RenderSystem(
         const ECS& ecs,
-        std::shared_ptr<const Shader> pShader)
+        std::shared_ptr<const Shader> pShader,
+        std::shared_ptr<const AssetPools> pPools,
+        std::shared_ptr<TextureManager> pTextureManager)
         : System(ecs)
         , mpShader(pShader)
+        , mpPools(pPools)
+        , mpTextureManager(pTextureManager)
     {}
 
     void RenderSystem::update(float dt) const
     {
-        get<AnimationComponent>().forEach([dt](const Entity& entity, AnimationInstance& instance) {
-            // Frozen animations require no update
-            if (instance.currAnimation->frozen) { return; }
+        const AssetPool<Animation>& animations = mpPools->animations;
+        get<AnimationComponent>().forEach([dt, &animations](const Entity& entity, AnimationInstance& instance) {
+            // Frozen animations require no update, nor do ones whose scope has ended
+            const Animation* pAnimation = animations.find(instance.currAnimation);
+            if (!pAnimation || pAnimation->frozen) { return; }
 
             instance.currDuration += dt * 1000;
-            if ((unsigned)instance.currDuration > instance.currAnimation->frames[instance.currFrameIndex].duration) {
+            if ((unsigned)instance.currDuration > pAnimation->frames[instance.currFrameIndex].duration) {
                 instance.currDuration = 0;
                 ++instance.currFrameIndex;
-                if (instance.currFrameIndex >= instance.currAnimation->frames.size()) {
+                if (instance.currFrameIndex >= pAnimation->frames.size()) {
                     instance.currFrameIndex = 0;
                 }
             }
@@ -36,8 +43,13 @@ namespace te
 
     void RenderSystem::draw(const glm::mat4& viewTransform) const
     {
+        const AssetPools& pools = *mpPools;
         get<AnimationComponent>().forEach([&, this](const Entity& entity, AnimationInstance& instance) {
-            instance.currAnimation->frames[instance.currFrameIndex].model->draw(*mpShader, viewTransform * get<TransformComponent>().getWorldTransform(entity));
+            const Animation* pAnimation = pools.animations.find(instance.currAnimation);
+            if (!pAnimation) { return; }
+
+            const Mesh& mesh = pools.meshes[pAnimation->frames[instance.currFrameIndex].mesh];
+            mpShader->draw(viewTransform * get<TransformComponent>().getWorldTransform(entity), mesh, mpTextureManager->use(mesh.getTexture(0)));
         });
     }
 }
@@ -13,19 +13,25 @@ namespace te
     class SimpleRenderComponent;
     class AnimationComponent;
     class TransformComponent;
+    class TextureManager;
+    struct AssetPools;
 
     class RenderSystem : public System
     {
     public:
         RenderSystem(
             const ECS& ecs,
-            std::shared_ptr<const Shader> pShader);
+            std::shared_ptr<const Shader> pShader,
+            std::shared_ptr<const AssetPools> pPools,
+            std::shared_ptr<TextureManager> pTextureManager);
 
         void update(float dt) const;
         void draw(const glm::mat4& viewTransform = glm::mat4()) const;
 
     private:
         std::shared_ptr<const Shader> mpShader;
+        std::shared_ptr<const AssetPools> mpPools;
+        std::shared_ptr<TextureManager> mpTextureManager;
     };
 }
 
@@ -2,13 +2,13 @@
 #include "mesh.h"
 #include "texture.h"
 #include "view.h"
+#include "asset_pack.h"
 
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/transform.hpp>
 #include <SDL.h>
 
 #include <stdexcept>
-#include <fstream>
 
 namespace te
 {
@@ -71,16 +71,12 @@ namespace te
     GLuint loadShader(const std::string& path, GLenum shaderType)
     {
         GLuint shaderID = 0;
-        std::string shaderString;
-        std::ifstream srcFile(path.c_str());
-
-        if (!srcFile) { throw std::runtime_error("Unable to open file."); }
-
-        shaderString.assign(std::istreambuf_iterator<char>(srcFile), std::istreambuf_iterator<char>());
+        AssetSpan source(readAsset(path));
         shaderID = glCreateShader(shaderType);
 
-        const GLchar* shaderSrc = shaderString.c_str();
-        glShaderSource(shaderID, 1, (const GLchar**)&shaderSrc, NULL);
+        const GLchar* shaderSrc = source.data();
+        GLint shaderLength = (GLint)source.size();
+        glShaderSource(shaderID, 1, &shaderSrc, &shaderLength);
 
         glCompileShader(shaderID);
 
@@ -214,14 +210,14 @@ namespace te
         mProjection = projection;
     }
 
-    void Shader::draw(const glm::mat4& modelview, const Mesh& mesh) const
+    void Shader::draw(const glm::mat4& modelview, const Mesh& mesh, const Texture& texture) const
     {
         glUseProgram(mProgram);
 
         glUniformMatrix4fv(mModelViewLocation, 1, GL_FALSE, glm::value_ptr(modelview));
 
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, mesh.getTexture(0)->getID());
+        glBindTexture(GL_TEXTURE_2D, texture.getID());
         glBindVertexArray(mesh.getVAO());
         glDrawElements(GL_TRIANGLES, mesh.getElementCount(), GL_UNSIGNED_INT, 0);
         glBindVertexArray(0);
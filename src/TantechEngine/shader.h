@@ -13,6 +13,7 @@ namespace te
 {
     class View;
     class Mesh;
+    class Texture;
 
     std::string getShaderLog(GLuint shader);
     std::string getProgramLog(GLuint program);
@@ -29,7 +30,7 @@ namespace te
         glm::mat4 getProjection() const;
 
         void setProjection(const glm::mat4& projection);
-        void draw(const glm::mat4& view, const Mesh&) const;
+        void draw(const glm::mat4& view, const Mesh&, const Texture&) const;
 
         static void* operator new(std::size_t);
         static void operator delete(void*);
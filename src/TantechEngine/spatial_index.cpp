@@ -0,0 +1,192 @@
+#include "spatial_index.h"
+#include "bounding_box_component.h"
+#include "transform_component.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace te
+{
+    static AABB toAABB(const BoundingBox& bb)
+    {
+        return{ { bb.x, bb.y }, { bb.x + bb.w, bb.y + bb.h } };
+    }
+
+    SpatialIndex::SpatialIndex(std::shared_ptr<BoundingBoxComponent> pBoundingBox, float margin)
+        : mpBoundingBox(pBoundingBox)
+        , mTree(margin)
+        , mProxies()
+        , mDirty()
+        , mNearest()
+    {
+        assert(pBoundingBox);
+    }
+
+    void SpatialIndex::onNotify(const DestroyEvent& evt)
+    {
+        auto it = mProxies.find(evt.entity);
+        if (it == mProxies.end()) { return; }
+
+        if (it->second.id != AABBTree::NULL_NODE) {
+            mTree.destroyProxy(it->second.id);
+        }
+        mProxies.erase(it);
+    }
+
+    void SpatialIndex::onNotify(const TransformUpdateEvent& evt)
+    {
+        markDirty(evt.entity, false);
+    }
+
+    void SpatialIndex::onNotify(const BoundingBoxUpdateEvent& evt)
+    {
+        markDirty(evt.entity, true);
+    }
+
+    // Only entities with a bounding box are indexed, and transforms change
+    // far more often than boxes are added, so only box updates add entries.
+    void SpatialIndex::markDirty(const Entity& entity, bool create)
+    {
+        auto it = mProxies.find(entity);
+        if (it == mProxies.end()) {
+            if (!create) { return; }
+            it = mProxies.insert(std::make_pair(entity, Proxy{ AABBTree::NULL_NODE, false })).first;
+        }
+        if (!it->second.dirty) {
+            it->second.dirty = true;
+            mDirty.push_back(entity);
+        }
+    }
+
+    void SpatialIndex::update()
+    {
+        BoundingBoxComponent& bbcomponent = *mpBoundingBox;
+        for (const Entity& entity : mDirty) {
+            auto it = mProxies.find(entity);
+            if (it == mProxies.end()) { continue; }
+            Proxy& proxy = it->second;
+            proxy.dirty = false;
+
+            if (!bbcomponent.hasInstance(entity)) {
+                if (proxy.id != AABBTree::NULL_NODE) {
+                    mTree.destroyProxy(proxy.id);
+                }
+                mProxies.erase(it);
+                continue;
+            }
+
+            AABB aabb = toAABB(bbcomponent.getBoundingBox(entity, bbcomponent.at(entity)));
+            if (proxy.id == AABBTree::NULL_NODE) {
+                proxy.id = mTree.createProxy(aabb, entity);
+            } else {
+                mTree.moveProxy(proxy.id, aabb);
+            }
+        }
+        mDirty.clear();
+    }
+
+    void SpatialIndex::appendRegion(const AABB& region, std::vector<Entity>& out) const
+    {
+        const AABBTree& tree = mTree;
+        tree.query(region, [&](int proxy) {
+            if (overlaps(tree.getAABB(proxy), region)) {
+                out.push_back(tree.getEntity(proxy));
+            }
+            return true;
+        });
+    }
+
+    void SpatialIndex::appendRadius(const glm::vec2& center, float radius, std::vector<Entity>& out) const
+    {
+        const AABBTree& tree = mTree;
+        float radiusSquared = radius * radius;
+        tree.query({ center - radius, center + radius }, [&](int proxy) {
+            if (distanceSquared(tree.getAABB(proxy), center) <= radiusSquared) {
+                out.push_back(tree.getEntity(proxy));
+            }
+            return true;
+        });
+    }
+
+    void SpatialIndex::queryRegion(const BoundingBox& region, std::vector<Entity>& out)
+    {
+        update();
+        out.clear();
+        appendRegion(toAABB(region), out);
+    }
+
+    void SpatialIndex::queryRadius(const glm::vec2& center, float radius, std::vector<Entity>& out)
+    {
+        update();
+        out.clear();
+        appendRadius(center, radius, out);
+    }
+
+    void SpatialIndex::queryNearest(const glm::vec2& point, unsigned k, std::vector<Entity>& out)
+    {
+        update();
+        out.clear();
+        mTree.nearest(point, k, mNearest);
+        for (const auto& candidate : mNearest) {
+            out.push_back(mTree.getEntity(candidate.second));
+        }
+    }
+
+    void SpatialIndex::raycast(const glm::vec2& origin, const glm::vec2& direction, float maxDistance, std::vector<RaycastHit>& out)
+    {
+        update();
+        out.clear();
+
+        float length = glm::length(direction);
+        if (length == 0.f) { return; }
+        glm::vec2 unit = direction / length;
+        glm::vec2 invDirection(1.f / unit.x, 1.f / unit.y);
+
+        const AABBTree& tree = mTree;
+        tree.raycast(origin, unit, maxDistance, [&](int proxy) {
+            float distance = rayEntry(tree.getAABB(proxy), origin, invDirection, maxDistance);
+            if (distance >= 0.f) {
+                out.push_back({ tree.getEntity(proxy), distance });
+            }
+        });
+        std::sort(out.begin(), out.end(), [](const RaycastHit& a, const RaycastHit& b) {
+            return a.distance < b.distance;
+        });
+    }
+
+    void SpatialIndex::queryRegions(const std::vector<BoundingBox>& regions, std::vector<Entity>& out, std::vector<unsigned>& offsets)
+    {
+        update();
+        out.clear();
+        offsets.clear();
+        offsets.reserve(regions.size() + 1);
+        for (const BoundingBox& region : regions) {
+            offsets.push_back((unsigned)out.size());
+            appendRegion(toAABB(region), out);
+        }
+        offsets.push_back((unsigned)out.size());
+    }
+
+    void SpatialIndex::queryRadii(const std::vector<glm::vec3>& circles, std::vector<Entity>& out, std::vector<unsigned>& offsets)
+    {
+        update();
+        out.clear();
+        offsets.clear();
+        offsets.reserve(circles.size() + 1);
+        for (const glm::vec3& circle : circles) {
+            offsets.push_back((unsigned)out.size());
+            appendRadius({ circle.x, circle.y }, circle.z, out);
+        }
+        offsets.push_back((unsigned)out.size());
+    }
+
+    unsigned SpatialIndex::getCount() const
+    {
+        return mTree.getProxyCount();
+    }
+
+    const AABBTree& SpatialIndex::getTree() const
+    {
+        return mTree;
+    }
+}
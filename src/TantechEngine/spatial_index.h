@@ -0,0 +1,88 @@
+#ifndef TE_SPATIAL_INDEX_H
+#define TE_SPATIAL_INDEX_H
+
+#include "aabb_tree.h"
+#include "entity_manager.h"
+#include "observer.h"
+
+#include <glm/glm.hpp>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace te
+{
+    class BoundingBoxComponent;
+    struct BoundingBox;
+    struct BoundingBoxUpdateEvent;
+    struct TransformUpdateEvent;
+
+    struct RaycastHit {
+        Entity entity;
+        float distance;
+    };
+
+    // Answers which entities are in a region, near a point or along a ray
+    // without visiting every bounding box. Listens for transform and
+    // bounding box changes and refits only the boxes that changed, on the
+    // next query or update.
+    class SpatialIndex : public Observer<DestroyEvent>,
+                         public Observer<TransformUpdateEvent>,
+                         public Observer<BoundingBoxUpdateEvent>
+    {
+    public:
+        explicit SpatialIndex(std::shared_ptr<BoundingBoxComponent> pBoundingBox, float margin = 0.25f);
+
+        void onNotify(const DestroyEvent& evt);
+        void onNotify(const TransformUpdateEvent& evt);
+        void onNotify(const BoundingBoxUpdateEvent& evt);
+
+        // Refits boxes changed since the last call. Queries do this
+        // themselves; calling it once a frame keeps the cost out of them.
+        void update();
+
+        // Each query replaces out. Regions and radii include entities that
+        // only touch them.
+        void queryRegion(const BoundingBox& region, std::vector<Entity>& out);
+        void queryRadius(const glm::vec2& center, float radius, std::vector<Entity>& out);
+        // Closest first, by the distance from point to each box.
+        void queryNearest(const glm::vec2& point, unsigned k, std::vector<Entity>& out);
+        // Every entity the ray enters within maxDistance, closest first.
+        // Entities containing the origin are hit at distance 0.
+        void raycast(const glm::vec2& origin, const glm::vec2& direction, float maxDistance, std::vector<RaycastHit>& out);
+
+        // Batched forms, one tree refit for the lot. The results of query i
+        // are out[offsets[i]] up to out[offsets[i + 1]].
+        void queryRegions(const std::vector<BoundingBox>& regions, std::vector<Entity>& out, std::vector<unsigned>& offsets);
+        void queryRadii(const std::vector<glm::vec3>& circles, std::vector<Entity>& out, std::vector<unsigned>& offsets);
+
+        unsigned getCount() const;
+        const AABBTree& getTree() const;
+
+    private:
+        SpatialIndex(const SpatialIndex&) = delete;
+        SpatialIndex& operator=(const SpatialIndex&) = delete;
+
+        struct Proxy {
+            int id;
+            bool dirty;
+        };
+
+        void markDirty(const Entity& entity, bool create);
+        void appendRegion(const AABB& region, std::vector<Entity>& out) const;
+        void appendRadius(const glm::vec2& center, float radius, std::vector<Entity>& out) const;
+
+        std::shared_ptr<BoundingBoxComponent> mpBoundingBox;
+        AABBTree mTree;
+        std::map<Entity, Proxy> mProxies;
+        std::vector<Entity> mDirty;
+
+        // Kept to reuse its storage.
+        std::vector<std::pair<float, int>> mNearest;
+    };
+
+    typedef std::shared_ptr<SpatialIndex> SpatialIndexPtr;
+}
+
+#endif
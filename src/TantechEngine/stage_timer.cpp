@@ -0,0 +1,56 @@
+#include "stage_timer.h"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace te
+{
+    StageTimer::StageTimer()
+        : mStart(Clock::now())
+        , mCreator(std::this_thread::get_id())
+        , mStages()
+        , mMutex()
+    {}
+
+    void StageTimer::run(const std::string& stage, const std::function<void()>& fn)
+    {
+        double start = elapsed();
+        bool onCreator = std::this_thread::get_id() == mCreator;
+        try {
+            fn();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStages.push_back({ stage + " (failed)", start, elapsed(), onCreator });
+            throw;
+        }
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStages.push_back({ stage, start, elapsed(), onCreator });
+    }
+
+    void StageTimer::report(std::ostream& os, const std::string& title) const
+    {
+        std::vector<Stage> stages;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            stages = mStages;
+        }
+        std::stable_sort(stages.begin(), stages.end(), [](const Stage& a, const Stage& b) {
+            return a.start < b.start;
+        });
+
+        os << title << ": " << std::fixed << std::setprecision(1) << elapsed() << "ms" << std::endl;
+        for (const auto& stage : stages) {
+            os << "    " << std::left << std::setw(24) << stage.name << std::right
+               << std::setw(8) << stage.start << " -" << std::setw(8) << stage.end << "ms  "
+               << std::setw(7) << stage.end - stage.start << "ms "
+               << (stage.onCreator ? "main" : "worker") << std::endl;
+        }
+        os.unsetf(std::ios_base::floatfield);
+        os << std::setprecision(6);
+    }
+
+    double StageTimer::elapsed() const
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - mStart).count();
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef TE_STAGE_TIMER_H
+#define TE_STAGE_TIMER_H
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace te
+{
+    // Records when each stage of a multi-threaded load started and ended,
+    // relative to the timer's construction, so overlapping stages and the
+    // critical path can be read off the report.
+    class StageTimer {
+    public:
+        StageTimer();
+
+        // Runs fn and records it under the given name, also if it throws.
+        // May be called from any thread.
+        void run(const std::string& stage, const std::function<void()>& fn);
+
+        // One line per stage in order of starting, marked with whether it ran
+        // on the thread that created the timer.
+        void report(std::ostream& os, const std::string& title) const;
+
+    private:
+        typedef std::chrono::high_resolution_clock Clock;
+
+        struct Stage {
+            std::string name;
+            double start;
+            double end;
+            bool onCreator;
+        };
+
+        double elapsed() const;
+
+        Clock::time_point mStart;
+        std::thread::id mCreator;
+        std::vector<Stage> mStages;
+        mutable std::mutex mMutex;
+
+        StageTimer(const StageTimer&) = delete;
+        StageTimer& operator=(const StageTimer&) = delete;
+    };
+}
+
+#endif
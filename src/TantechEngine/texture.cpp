@@ -1,13 +1,21 @@
 #include "texture.h"
+#include "image_ops.h"
+#include "asset_pack.h"
 #include <stdexcept>
 #include <IL/il.h>
-#include <IL/ilu.h>
 #include <vector>
 #include <algorithm>
 #include <iostream>
+#include <mutex>
 
 namespace te
 {
+    // Matches ilClearColour, which used to fill enlarged canvases.
+    static const GLuint CLEAR_PIXEL = 0x00ffffff;
+
+    // DevIL keeps the bound image in global state.
+    static std::mutex ilMutex;
+
     GLuint powerOfTwo(GLuint num)
     {
         if (num != 0)
@@ -24,10 +32,10 @@ namespace te
     }
 
     Texture::Texture()
-        : mID(0), mImgWidth(0), mImgHeight(0), mTexWidth(0), mTexHeight(0) {}
+        : mID(0), mImgWidth(0), mImgHeight(0), mTexWidth(0), mTexHeight(0), mFormat(GL_RGBA) {}
 
     Texture::Texture(Texture&& o)
-        : mID(o.mID), mImgWidth(o.mImgWidth), mImgHeight(o.mImgHeight), mTexWidth(o.mTexWidth), mTexHeight(o.mTexHeight)
+        : mID(o.mID), mImgWidth(o.mImgWidth), mImgHeight(o.mImgHeight), mTexWidth(o.mTexWidth), mTexHeight(o.mTexHeight), mFormat(o.mFormat)
     {
         o.mID = 0;
         o.mImgWidth = 0;
@@ -45,6 +53,7 @@ namespace te
         mImgHeight = o.mImgHeight;
         mTexWidth = o.mTexWidth;
         mTexHeight = o.mTexHeight;
+        mFormat = o.mFormat;
 
         o.mID = 0;
         o.mImgWidth = 0;
@@ -60,6 +69,38 @@ namespace te
         glDeleteTextures(1, &mID);
     }
 
+    // Decodes to tightly packed RGBA. DevIL reads from memory so images can
+    // come out of an asset pack, and only this part runs under ilMutex.
+    static std::vector<GLuint> decodeRGBA(const std::string& path, GLuint& width, GLuint& height)
+    {
+        AssetSpan file(readAsset(path));
+        std::lock_guard<std::mutex> lock(ilMutex);
+
+        ILuint imgID = 0;
+        ilGenImages(1, &imgID);
+        ilBindImage(imgID);
+
+        const char* error = nullptr;
+        if (ilLoadL(IL_TYPE_UNKNOWN, file.data(), (ILuint)file.size()) != IL_TRUE) {
+            error = "Error loading image";
+        } else if (ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE) != IL_TRUE) {
+            error = "Error converting image";
+        }
+        if (error) {
+            ilDeleteImages(1, &imgID);
+            throw std::runtime_error(error);
+        }
+
+        width = (GLuint)ilGetInteger(IL_IMAGE_WIDTH);
+        height = (GLuint)ilGetInteger(IL_IMAGE_HEIGHT);
+        const GLuint* data = (const GLuint*)ilGetData();
+        std::vector<GLuint> pixels(data, data + width * height);
+
+        ilDeleteImages(1, &imgID);
+
+        return pixels;
+    }
+
     GLuint loadTexture32(GLuint* pixels, GLuint width, GLuint height)
     {
         GLuint texID;
@@ -81,38 +122,15 @@ namespace te
         return texID;
     }
 
-    std::vector<GLuint> loadPixels32(const std::string& path, GLuint& imgWidth, GLuint& imgHeight, GLuint& texWidth, GLuint& texHeight)
+    std::vector<GLuint> loadPixels32(const std::string& path, GLuint& imgWidth, GLuint& imgHeight, GLuint& texWidth, GLuint& texHeight, JobPool* pPool)
     {
-        ILuint imgID = 0;
-        ilGenImages(1, &imgID);
-        ilBindImage(imgID);
-
-        ILboolean success = ilLoadImage(path.c_str());
-        if (success != IL_TRUE) throw std::runtime_error("Error loading image");
-
-        success = ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE);
-        if (success != IL_TRUE) throw std::runtime_error("Error converting image");
-
-        imgWidth = (GLuint)ilGetInteger(IL_IMAGE_WIDTH);
-        imgHeight = (GLuint)ilGetInteger(IL_IMAGE_HEIGHT);
+        std::vector<GLuint> pixels(decodeRGBA(path, imgWidth, imgHeight));
 
         texWidth = powerOfTwo(imgWidth);
         texHeight = powerOfTwo(imgHeight);
 
-        if (imgWidth != texWidth || imgHeight != texHeight)
-        {
-            iluImageParameter(ILU_PLACEMENT, ILU_UPPER_LEFT);
-            iluEnlargeCanvas((int)texWidth, (int)texHeight, 1);
-        }
-
-        GLuint size = texWidth * texHeight;
-        std::vector<GLuint> pixels(size);
-
-        std::memcpy(pixels.data(), ilGetData(), size * 4);
-
-        ilDeleteImages(1, &imgID);
-
-        return pixels;
+        if (imgWidth == texWidth && imgHeight == texHeight) return pixels;
+        return padCanvas32(pixels.data(), imgWidth, imgHeight, texWidth, texHeight, CLEAR_PIXEL, pPool);
     }
 
     GLuint loadTexture8(GLubyte* pixels, GLuint width, GLuint height)
@@ -136,38 +154,17 @@ namespace te
         return texID;
     }
 
-    std::vector<GLubyte> loadPixels8(const std::string& path, GLuint& imgWidth, GLuint& imgHeight, GLuint& texWidth, GLuint& texHeight)
+    std::vector<GLubyte> loadPixels8(const std::string& path, GLuint& imgWidth, GLuint& imgHeight, GLuint& texWidth, GLuint& texHeight, JobPool* pPool)
     {
-        ILuint imgID = 0;
-        ilGenImages(1, &imgID);
-        ilBindImage(imgID);
-
-        ILboolean success = ilLoadImage(path.c_str());
-        if (success != IL_TRUE) throw std::runtime_error("Unable to load image.");
-
-        success = ilConvertImage(IL_LUMINANCE, IL_UNSIGNED_BYTE);
-        if (success != IL_TRUE) throw std::runtime_error("Unable to load image.");
-
-        imgWidth = (GLuint)ilGetInteger(IL_IMAGE_WIDTH);
-        imgHeight = (GLuint)ilGetInteger(IL_IMAGE_HEIGHT);
+        std::vector<GLuint> pixels(decodeRGBA(path, imgWidth, imgHeight));
 
         texWidth = powerOfTwo(imgWidth);
         texHeight = powerOfTwo(imgHeight);
 
-        if (imgWidth != texWidth || imgHeight != texHeight)
-        {
-            iluImageParameter(ILU_PLACEMENT, ILU_UPPER_LEFT);
-            iluEnlargeCanvas((int)texWidth, (int)texHeight, 1);
-        }
-
-        GLuint size = texWidth * texHeight;
-        std::vector<GLubyte> pixels(size, 0);
-
-        memcpy(pixels.data(), ilGetData(), size);
-
-        ilDeleteImages(1, &imgID);
+        std::vector<GLubyte> luminance(imgWidth * imgHeight);
+        rgbaToLuminance(pixels.data(), luminance.data(), imgWidth, imgHeight, pPool);
 
-        return pixels;
+        return padCanvas8(luminance.data(), imgWidth, imgHeight, texWidth, texHeight, 0, pPool);
     }
 
     Texture::Texture(GLuint* pixels, GLuint width, GLuint height)
@@ -176,59 +173,73 @@ namespace te
         , mImgHeight(height)
         , mTexWidth(width)
         , mTexHeight(height)
+        , mFormat(GL_RGBA)
+    {}
+
+    Texture::Texture(const TextureImage& image)
+        : mID(loadTexture32((GLuint*)image.pixels.data(), image.texWidth, image.texHeight))
+        , mImgWidth(image.imgWidth)
+        , mImgHeight(image.imgHeight)
+        , mTexWidth(image.texWidth)
+        , mTexHeight(image.texHeight)
+        , mFormat(GL_RGBA)
     {}
 
-    Texture::Texture(const std::string& path, GLuint format)
-        : mID(0), mImgWidth(0), mImgHeight(0), mTexWidth(0), mTexHeight(0)
+    TextureImage decodeTexture(const std::string& path, JobPool* pPool)
+    {
+        TextureImage image;
+        image.pixels = loadPixels32(path, image.imgWidth, image.imgHeight, image.texWidth, image.texHeight, pPool);
+        return image;
+    }
+
+    TextureImage decodeTexture(const TMX::Tileset& tileset, JobPool* pPool)
+    {
+        TextureImage image(decodeTexture(tileset.image, pPool));
+        if (tileset.transparentcolor.inUse) {
+            applyColorKey(
+                image.pixels.data(),
+                image.texWidth,
+                image.texHeight,
+                tileset.transparentcolor.r,
+                tileset.transparentcolor.g,
+                tileset.transparentcolor.b,
+                0,
+                pPool);
+        }
+        return image;
+    }
+
+    Texture::Texture(const std::string& path, GLuint format, JobPool* pPool)
+        : mID(0), mImgWidth(0), mImgHeight(0), mTexWidth(0), mTexHeight(0), mFormat(GL_RGBA)
     {
         if (format == GL_RGBA) {
-            std::vector<GLuint> pixels(loadPixels32(path, mImgWidth, mImgHeight, mTexWidth, mTexHeight));
+            std::vector<GLuint> pixels(loadPixels32(path, mImgWidth, mImgHeight, mTexWidth, mTexHeight, pPool));
             mID = loadTexture32(pixels.data(), mTexWidth, mTexHeight);
         } else if (format == GL_ALPHA) {
-            std::vector<GLubyte> pixels{ loadPixels8(path, mImgWidth, mImgHeight, mTexWidth, mTexHeight) };
+            mFormat = GL_ALPHA;
+            std::vector<GLubyte> pixels{ loadPixels8(path, mImgWidth, mImgHeight, mTexWidth, mTexHeight, pPool) };
             mID = loadTexture8(pixels.data(), mTexWidth, mTexHeight);
         }
     }
 
-    void Texture::loadWithColorMask(const std::string& path, GLubyte r, GLubyte g, GLubyte b, GLubyte a)
+    void Texture::loadWithColorMask(const std::string& path, GLubyte r, GLubyte g, GLubyte b, GLubyte a, JobPool* pPool)
     {
-        std::vector<GLuint> pixels(loadPixels32(path, mImgWidth, mImgHeight, mTexWidth, mTexHeight));
+        std::vector<GLuint> pixels(loadPixels32(path, mImgWidth, mImgHeight, mTexWidth, mTexHeight, pPool));
 
-        std::for_each(std::begin(pixels), std::end(pixels), [r,g,b,a](GLuint& pixel)
-        {
-            GLubyte* colors = (GLubyte*)&pixel;
-            if (colors[0] == r && colors[1] == g && colors[2] == b && (a == 0 || colors[3] == a))
-            {
-                colors[0] = 255;
-                colors[1] = 255;
-                colors[2] = 255;
-                colors[3] = 000;
-            }
-        });
+        applyColorKey(pixels.data(), mTexWidth, mTexHeight, r, g, b, a, pPool);
 
         mID = loadTexture32(pixels.data(), mTexWidth, mTexHeight);
     }
 
-    Texture::Texture(const std::string& path, GLubyte r, GLubyte g, GLubyte b, GLubyte a)
-        : mID(0), mImgWidth(0), mImgHeight(0), mTexWidth(0), mTexHeight(0)
+    Texture::Texture(const std::string& path, GLubyte r, GLubyte g, GLubyte b, GLubyte a, JobPool* pPool)
+        : mID(0), mImgWidth(0), mImgHeight(0), mTexWidth(0), mTexHeight(0), mFormat(GL_RGBA)
     {
-        loadWithColorMask(path, r, g, b, a);
+        loadWithColorMask(path, r, g, b, a, pPool);
     }
 
-    Texture::Texture(const TMX::Tileset& tileset)
-        : mID(0), mImgWidth(0), mImgHeight(0), mTexWidth(0), mTexHeight(0)
-    {
-        if (tileset.transparentcolor.inUse) {
-            loadWithColorMask(
-                tileset.image,
-                tileset.transparentcolor.r,
-                tileset.transparentcolor.g,
-                tileset.transparentcolor.b);
-        } else {
-            std::vector<GLuint> pixels(loadPixels32(tileset.image, mImgWidth, mImgHeight, mTexWidth, mTexHeight));
-            mID = loadTexture32(pixels.data(), mTexWidth, mTexHeight);
-        }
-    }
+    Texture::Texture(const TMX::Tileset& tileset, JobPool* pPool)
+        : Texture(decodeTexture(tileset, pPool))
+    {}
 
     GLuint Texture::getID() const
     {
@@ -254,4 +265,9 @@ namespace te
     {
         return mTexHeight;
     }
+
+    GLuint Texture::getByteSize() const
+    {
+        return mTexWidth * mTexHeight * (mFormat == GL_ALPHA ? 1 : 4);
+    }
 }
@@ -2,20 +2,38 @@
 #define TE_TEXTURE_H
 
 #include <string>
+#include <vector>
 #include "gl.h"
 
 #include "tmx.h"
+#include "asset_pool.h"
 
 namespace te
 {
+    class JobPool;
+
+    // Pixels decoded and padded to power of two dimensions, ready to upload.
+    // Decoding needs no GL context, so it may run on a worker thread.
+    struct TextureImage {
+        std::vector<GLuint> pixels;
+        GLuint imgWidth;
+        GLuint imgHeight;
+        GLuint texWidth;
+        GLuint texHeight;
+    };
+
+    TextureImage decodeTexture(const std::string& path, JobPool* pPool = nullptr);
+    TextureImage decodeTexture(const TMX::Tileset& tileset, JobPool* pPool = nullptr);
+
     class Texture
     {
     public:
         Texture();
         Texture::Texture(GLuint* pixels, GLuint width, GLuint height);
-        Texture(const std::string& path, GLuint format = GL_RGBA);
-        Texture(const std::string& path, GLubyte r, GLubyte g, GLubyte b, GLubyte a = 0);
-        Texture(const TMX::Tileset& tileset);
+        Texture(const std::string& path, GLuint format = GL_RGBA, JobPool* pPool = nullptr);
+        Texture(const std::string& path, GLubyte r, GLubyte g, GLubyte b, GLubyte a = 0, JobPool* pPool = nullptr);
+        Texture(const TMX::Tileset& tileset, JobPool* pPool = nullptr);
+        Texture(const TextureImage& image);
 
         Texture(Texture&&);
         Texture& operator=(Texture&&);
@@ -28,19 +46,24 @@ namespace te
         GLuint Texture::getImgHeight() const;
         GLuint Texture::getTexWidth() const;
         GLuint Texture::getTexHeight() const;
+        // Video memory taken by the uploaded texture.
+        GLuint getByteSize() const;
     private:
         Texture(const Texture&) = delete;
         Texture& operator=(const Texture&) = delete;
 
-        void loadWithColorMask(const std::string& path, GLubyte r, GLubyte g, GLubyte b, GLubyte a = 0);
+        void loadWithColorMask(const std::string& path, GLubyte r, GLubyte g, GLubyte b, GLubyte a, JobPool* pPool);
 
         GLuint mID;
         GLuint mImgWidth;
         GLuint mImgHeight;
         GLuint mTexWidth;
         GLuint mTexHeight;
+        GLuint mFormat;
     };
 
+    typedef Handle<Texture> TextureHandle;
+
     GLuint powerOfTwo(GLuint n);
 }
 
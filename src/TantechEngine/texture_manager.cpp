@@ -1,31 +1,192 @@
 #include "texture_manager.h"
-#include "texture.h"
+#include "asset_pools.h"
+#include "image_ops.h"
+#include "job_pool.h"
 
 namespace te
 {
-    TextureManager::TextureManager() : mTextures() {}
+    TextureManager::TextureManager(std::shared_ptr<AssetPools> pPools, std::shared_ptr<JobPool> pJobPool, std::size_t budgetBytes)
+        : mTextures()
+        , mEntryOfSlot()
+        , mpPools(pPools)
+        , mpJobPool(pJobPool)
+        , mBudget(budgetBytes)
+        , mResidentBytes(0)
+        , mFrame(0)
+        , mEvictions(0)
+        , mReloads(0)
+    {}
 
-    std::shared_ptr<Texture> TextureManager::operator[](const std::string& key)
+    TextureHandle TextureManager::operator[](const std::string& key)
     {
-        auto it = mTextures.find(key);
-        if (it != mTextures.end()) {
-            return it->second;
+        return acquire(getEntry(key, { 0, 0, 0, false }));
+    }
+
+    TextureHandle TextureManager::operator[](const TMX::Tileset& tileset)
+    {
+        return acquire(getEntry(tileset.image, tileset.transparentcolor));
+    }
+
+    const Texture& TextureManager::use(TextureHandle handle)
+    {
+        // Called for every mesh drawn, so no map lookup. A handle whose
+        // generation differs was not issued here.
+        std::uint32_t slot = handle.value & AssetPool<Texture>::INDEX_MASK;
+        if (slot < mEntryOfSlot.size() && mEntryOfSlot[slot].handle == handle) {
+            handle = acquire(*mEntryOfSlot[slot].pEntry);
+        }
+        return mpPools->textures[handle];
+    }
+
+    void TextureManager::prefetch(const std::string& key)
+    {
+        Entry& entry = getEntry(key, { 0, 0, 0, false });
+        if (!isResident(entry) && !entry.pending.valid()) {
+            startDecode(entry);
+        }
+    }
+
+    void TextureManager::prefetch(const TMX::Tileset& tileset)
+    {
+        Entry& entry = getEntry(tileset.image, tileset.transparentcolor);
+        if (!isResident(entry) && !entry.pending.valid()) {
+            startDecode(entry);
+        }
+    }
+
+    void TextureManager::nextFrame()
+    {
+        ++mFrame;
+        evict();
+    }
+
+    void TextureManager::setBudget(std::size_t budgetBytes)
+    {
+        mBudget = budgetBytes;
+        evict();
+    }
+
+    TextureResidencyStats TextureManager::getStats() const
+    {
+        TextureResidencyStats stats{ mBudget, 0, 0, mEvictions, mReloads };
+        for (const auto& pair : mTextures) {
+            if (isResident(pair.second)) {
+                stats.residentBytes += pair.second.bytes;
+                ++stats.residentCount;
+            }
+        }
+        return stats;
+    }
+
+    TextureManager::Entry& TextureManager::getEntry(const std::string& path, const TMX::Tileset::TransparentColor& transparentColor)
+    {
+        auto it = mTextures.find(path);
+        if (it == mTextures.end()) {
+            Entry entry{ path, transparentColor, { 0 }, {}, 0, mFrame, false };
+            it = mTextures.insert(std::pair<std::string, Entry>(path, std::move(entry))).first;
+        }
+        return it->second;
+    }
+
+    void TextureManager::startDecode(Entry& entry)
+    {
+        std::string path = entry.path;
+        TMX::Tileset::TransparentColor key = entry.transparentColor;
+        JobPool* pPool = mpJobPool.get();
+        auto decode = [path, key, pPool]() {
+            TextureImage image(decodeTexture(path, pPool));
+            if (key.inUse) {
+                applyColorKey(image.pixels.data(), image.texWidth, image.texHeight, key.r, key.g, key.b, 0, pPool);
+            }
+            return image;
+        };
+
+        if (pPool) {
+            auto pTask = std::make_shared<std::packaged_task<TextureImage()>>(decode);
+            entry.pending = pTask->get_future().share();
+            pPool->push([pTask]() { (*pTask)(); });
         } else {
-            std::shared_ptr<Texture> pTexture(new Texture{ key });
-            mTextures.insert(std::pair<std::string, std::shared_ptr<Texture>>(key, pTexture));
-            return pTexture;
+            std::promise<TextureImage> promise;
+            promise.set_value(decode());
+            entry.pending = promise.get_future().share();
         }
     }
 
-    std::shared_ptr<Texture> TextureManager::operator[](const TMX::Tileset& tileset)
+    TextureHandle TextureManager::acquire(Entry& entry)
     {
-        auto it = mTextures.find(tileset.image);
-        if (it != mTextures.end()) {
-            return it->second;
+        entry.lastUse = mFrame;
+        if (isResident(entry)) {
+            return entry.handle;
+        }
+
+        if (!entry.pending.valid()) {
+            startDecode(entry);
+        }
+        std::shared_future<TextureImage> pending(entry.pending);
+        entry.pending = std::shared_future<TextureImage>();
+        if (mpJobPool) {
+            mpJobPool->wait(pending);
+        }
+
+        // Uploading needs the GL context, so it stays on the calling thread.
+        Texture texture(pending.get());
+        entry.bytes = texture.getByteSize();
+        if (mpPools->textures.contains(entry.handle)) {
+            // Evicted in place, so meshes keep their handle to it.
+            mpPools->textures[entry.handle] = std::move(texture);
         } else {
-            std::shared_ptr<Texture> pTexture(new Texture{ tileset });
-            mTextures.insert(std::pair<std::string, std::shared_ptr<Texture>>(tileset.image, pTexture));
-            return pTexture;
+            entry.handle = mpPools->textures.insert(std::move(texture), mpPools->getScope());
+            std::uint32_t slot = entry.handle.value & AssetPool<Texture>::INDEX_MASK;
+            if (slot >= mEntryOfSlot.size()) {
+                mEntryOfSlot.resize(slot + 1, HandleEntry{ { 0 }, nullptr });
+            }
+            mEntryOfSlot[slot] = HandleEntry{ entry.handle, &entry };
+        }
+        mResidentBytes += entry.bytes;
+        if (entry.evicted) {
+            ++mReloads;
+            entry.evicted = false;
+        }
+
+        evict();
+        return entry.handle;
+    }
+
+    bool TextureManager::isResident(const Entry& entry) const
+    {
+        return !entry.evicted && mpPools->textures.contains(entry.handle);
+    }
+
+    void TextureManager::evict()
+    {
+        // Forget textures whose scope has ended.
+        mResidentBytes = 0;
+        for (auto& pair : mTextures) {
+            if (isResident(pair.second)) {
+                mResidentBytes += pair.second.bytes;
+            }
+        }
+
+        while (mBudget != 0 && mResidentBytes > mBudget) {
+            // Anything used last frame is likely drawn again this one.
+            Entry* pVictim = nullptr;
+            for (auto& pair : mTextures) {
+                Entry& entry = pair.second;
+                if (isResident(entry) && entry.lastUse + 1 < mFrame) {
+                    if (!pVictim || entry.lastUse < pVictim->lastUse) {
+                        pVictim = &entry;
+                    }
+                }
+            }
+            if (!pVictim) {
+                break;
+            }
+
+            // Frees the video memory but keeps the slot, so the handle stays valid.
+            mpPools->textures[pVictim->handle] = Texture();
+            mResidentBytes -= pVictim->bytes;
+            pVictim->evicted = true;
+            ++mEvictions;
         }
     }
 }
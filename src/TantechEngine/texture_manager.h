@@ -1,27 +1,91 @@
 #ifndef TE_TEXTURE_MANAGER_H
 #define TE_TEXTURE_MANAGER_H
 
+#include "texture.h"
 #include "tmx.h"
 
 #include "gl.h"
 
+#include <cstddef>
+#include <future>
 #include <map>
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace te
 {
-    class Texture;
+    class JobPool;
+    struct AssetPools;
 
+    struct TextureResidencyStats {
+        std::size_t budgetBytes;
+        std::size_t residentBytes;
+        unsigned residentCount;
+        unsigned evictions;
+        unsigned reloads;
+    };
+
+    // Loads textures into the texture pool, at most once per image path,
+    // and keeps their video memory under a byte budget. A texture neither
+    // looked up nor drawn through use() this frame or the last may be
+    // evicted. Its handle stays valid, and the next lookup or use() decodes
+    // it again into the same handle.
     class TextureManager {
     public:
-        TextureManager();
+        // A budget of 0 never evicts.
+        TextureManager(std::shared_ptr<AssetPools> pPools, std::shared_ptr<JobPool> pJobPool = nullptr, std::size_t budgetBytes = 0);
+
+        TextureHandle operator[](const std::string&);
+        TextureHandle operator[](const TMX::Tileset&);
+
+        // The texture to draw a mesh with. Counts as a use this frame and
+        // reloads the texture first if it was evicted.
+        const Texture& use(TextureHandle);
+
+        // Starts decoding on the job pool so the later lookup only uploads.
+        void prefetch(const std::string&);
+        void prefetch(const TMX::Tileset&);
 
-        std::shared_ptr<Texture> operator[](const std::string&);
-        std::shared_ptr<Texture> operator[](const TMX::Tileset&);
+        // Advances the frame counter used for recency and evicts down to
+        // the budget. Call once per frame.
+        void nextFrame();
+
+        void setBudget(std::size_t budgetBytes);
+        TextureResidencyStats getStats() const;
 
     private:
-        std::map<std::string, std::shared_ptr<Texture>> mTextures;
+        struct Entry {
+            std::string path;
+            TMX::Tileset::TransparentColor transparentColor;
+            TextureHandle handle;
+            std::shared_future<TextureImage> pending;
+            std::size_t bytes;
+            unsigned lastUse;
+            bool evicted;
+        };
+
+        // The entry that issued a handle, stored at the handle's slot.
+        struct HandleEntry {
+            TextureHandle handle;
+            Entry* pEntry;
+        };
+
+        Entry& getEntry(const std::string& path, const TMX::Tileset::TransparentColor& transparentColor);
+        void startDecode(Entry& entry);
+        TextureHandle acquire(Entry& entry);
+        bool isResident(const Entry& entry) const;
+        void evict();
+
+        std::map<std::string, Entry> mTextures;
+        std::vector<HandleEntry> mEntryOfSlot;
+        std::shared_ptr<AssetPools> mpPools;
+        std::shared_ptr<JobPool> mpJobPool;
+        std::size_t mBudget;
+        std::size_t mResidentBytes;
+        unsigned mFrame;
+        unsigned mEvictions;
+        unsigned mReloads;
 
         TextureManager(const TextureManager&) = delete;
         TextureManager& operator=(const TextureManager&) = delete;
@@ -6,6 +6,9 @@
 #include "model.h"
 #include "texture.h"
 #include "texture_manager.h"
+#include "asset_pools.h"
+#include "job_pool.h"
+#include "stage_timer.h"
 #include "auxiliary.h"
 
 #include <glm/gtc/type_ptr.hpp>
@@ -13,158 +16,262 @@
 
 #include <algorithm>
 #include <array>
+#include <cmath>
+#include <limits>
 
 namespace te
 {
-    TiledMap::TiledMap(const std::string& path, const std::string& file, std::shared_ptr<const Shader> pShader, const glm::mat4& model, TextureManager* tm)
+    TiledMap::TiledMap(const std::string& path, const std::string& file, std::shared_ptr<const Shader> pShader, const glm::mat4& model, TextureManager& tm, std::shared_ptr<AssetPools> pPools, JobPool* pPool, StageTimer* pTimer)
         : mModelMatrix(model)
+        , mWorldToUnits()
+        , mUnitsToWorld()
         , mpShader(pShader)
         , mpTMX(new TMX{path, file})
+        , mpPools(pPools)
+        , mpTextureManager(&tm)
         , mLayers()
-        , mCollisionRects()
+        , mShapeOfGid()
+        , mTileShapes()
+        , mCollisionLayers()
     {
-        init(*mpTMX, tm);
+        init(*mpTMX, tm, pPool, pTimer);
     }
 
-    TiledMap::TiledMap(std::shared_ptr<const TMX> pTMX, std::shared_ptr<const Shader> pShader, const glm::mat4& model, TextureManager* tm)
+    TiledMap::TiledMap(std::shared_ptr<const TMX> pTMX, std::shared_ptr<const Shader> pShader, const glm::mat4& model, TextureManager& tm, std::shared_ptr<AssetPools> pPools, JobPool* pPool, StageTimer* pTimer)
         : mModelMatrix(model)
+        , mWorldToUnits()
+        , mUnitsToWorld()
         , mpShader(pShader)
         , mpTMX(pTMX)
+        , mpPools(pPools)
+        , mpTextureManager(&tm)
         , mLayers()
-        , mCollisionRects()
+        , mShapeOfGid()
+        , mTileShapes()
+        , mCollisionLayers()
     {
-        init(*mpTMX, tm);
+        init(*mpTMX, tm, pPool, pTimer);
     }
 
-    void TiledMap::init(const TMX& tmx, TextureManager* tm)
-    {
-        if (!mpShader) {
-            throw std::runtime_error{ "TiledMap ctor: requires Shader." };
-        }
-
-        std::vector<std::shared_ptr<const Texture>> textures;
-        std::for_each(std::begin(tmx.tilesets), std::end(tmx.tilesets), [&, this](const TMX::Tileset& tileset) {
-            if (tm) {
-                textures.push_back((*tm)[tileset]);
-            } else {
-                textures.push_back(std::shared_ptr<Texture>(new Texture{ tileset }));
-            }
-
-            std::for_each(std::begin(tileset.tiles), std::end(tileset.tiles), [&, this](const TMX::Tileset::Tile& tile) {
-                std::for_each(std::begin(tile.objectGroup.objects), std::end(tile.objectGroup.objects), [&, this](const TMX::Tileset::Tile::ObjectGroup::Object& object) {
-                    if (object.shape == TMX::Tileset::Tile::ObjectGroup::Object::Shape::RECTANGLE) {
-                        mCollisionRects.insert(std::pair<unsigned, const BoundingBox>{
-                            tileset.firstgid + tile.id,
-                            {
-                                object.x / tileset.tilewidth,
-                                object.y / tileset.tileheight,
-                                object.width / tileset.tilewidth,
-                                object.height / tileset.tileheight
-                            }
-                        });
-                    }
-                });
-            });
-        });
-
+    namespace {
+        // Geometry of one layer, one mesh per tileset. Needs no GL context.
         struct ProtoMesh {
             std::vector<Vertex> vertices;
             std::vector<GLuint> indices;
-            std::vector<std::shared_ptr<const Texture>> textures;
             unsigned elementIndex;
-            ProtoMesh() : vertices(), indices(), textures(), elementIndex(0) {}
+            ProtoMesh() : vertices(), indices(), elementIndex(0) {}
         };
+    }
+
+    static std::vector<ProtoMesh> buildLayerMeshes(const TMX& tmx, unsigned layerIndex)
+    {
         std::vector<ProtoMesh> protoMeshes(tmx.tilesets.size());
+        const TMX::Layer& layer = tmx.layers[layerIndex];
+
+        for (auto it = layer.data.begin(); it != layer.data.end(); ++it) {
 
-        for (auto it = tmx.layers.begin(); it != tmx.layers.end(); ++it) {
-            const TMX::Layer& layer = *it;
-            unsigned layerIndex = it - tmx.layers.begin();
+            unsigned tileID = *it;
+            if (tileID == 0) { continue; }
 
-            for (auto it = layer.data.begin(); it != layer.data.end(); ++it) {
+            std::array<Vertex, 4> corners{};
 
-                unsigned tileID = *it;
-                if (tileID == 0) { continue; }
+            int tilesetTextureIndex = getTilesetIndex(tmx, tileID);
+            const TMX::Tileset& tileset = tmx.tilesets.at(tilesetTextureIndex);
 
-                std::array<Vertex, 4> corners{};
+            unsigned i = it - layer.data.begin();
 
-                int tilesetTextureIndex = getTilesetIndex(tmx, tileID);
-                const TMX::Tileset& tileset = tmx.tilesets.at(tilesetTextureIndex);
+            unsigned xUnit = tileset.tilewidth;
+            float x = (float)((i % layer.width) * xUnit);
 
-                unsigned i = it - layer.data.begin();
+            unsigned yUnit = tileset.tileheight;
+            float y = (float)((i / layer.width) * yUnit);
 
-                unsigned xUnit = tileset.tilewidth;
-                float x = (float)((i % layer.width) * xUnit);
+            corners[0].position = { x, y, (float)layerIndex };
+            corners[1].position = { x + xUnit, y, (float)layerIndex };
+            corners[2].position = { x + xUnit, y + yUnit, (float)layerIndex };
+            corners[3].position = { x, y + yUnit, (float)layerIndex };
 
-                unsigned yUnit = tileset.tileheight;
-                float y = (float)((i / layer.width) * yUnit);
+            unsigned localIndex = tileID - tileset.firstgid;
 
-                corners[0].position = { x, y, (float)layerIndex };
-                corners[1].position = { x + xUnit, y, (float)layerIndex };
-                corners[2].position = { x + xUnit, y + yUnit, (float)layerIndex };
-                corners[3].position = { x, y + yUnit, (float)layerIndex };
+            unsigned sUnits = localIndex % ((tileset.imagewidth + tileset.spacing) / (tileset.tilewidth + tileset.spacing));
+            unsigned sPixels = sUnits * (tileset.tilewidth + tileset.spacing) + tileset.margin;
+            GLfloat s1 = (GLfloat)sPixels / (GLfloat)powerOfTwo(tileset.imagewidth);
+            GLfloat s2 = (GLfloat)(sPixels + tileset.tilewidth) / (GLfloat)powerOfTwo(tileset.imagewidth);
 
-                unsigned localIndex = tileID - tileset.firstgid;
+            unsigned tUnits = localIndex / ((tileset.imagewidth + tileset.spacing) / (tileset.tilewidth + tileset.spacing));
+            unsigned tPixels = tUnits * (tileset.tileheight + tileset.spacing) + tileset.margin;
+            GLfloat t1 = (GLfloat)tPixels / (GLfloat)powerOfTwo(tileset.imageheight);
+            GLfloat t2 = (GLfloat)(tPixels + tileset.tileheight) / (GLfloat)powerOfTwo(tileset.imageheight);
 
-                unsigned sUnits = localIndex % ((tileset.imagewidth + tileset.spacing) / (tileset.tilewidth + tileset.spacing));
-                unsigned sPixels = sUnits * (tileset.tilewidth + tileset.spacing) + tileset.margin;
-                GLfloat s1 = (GLfloat)sPixels / (GLfloat)powerOfTwo(tileset.imagewidth);
-                GLfloat s2 = (GLfloat)(sPixels + tileset.tilewidth) / (GLfloat)powerOfTwo(tileset.imagewidth);
+            corners[0].texCoords = { s1, t1 };
+            corners[1].texCoords = { s2, t1 };
+            corners[2].texCoords = { s2, t2 };
+            corners[3].texCoords = { s1, t2 };
 
-                unsigned tUnits = localIndex / ((tileset.imagewidth + tileset.spacing) / (tileset.tilewidth + tileset.spacing));
-                unsigned tPixels = tUnits * (tileset.tileheight + tileset.spacing) + tileset.margin;
-                GLfloat t1 = (GLfloat)tPixels / (GLfloat)powerOfTwo(tileset.imageheight);
-                GLfloat t2 = (GLfloat)(tPixels + tileset.tileheight) / (GLfloat)powerOfTwo(tileset.imageheight);
+            assert(s1 < 1.f && t1 < 1.f);
+
+            ProtoMesh& currMesh = protoMeshes.at(tilesetTextureIndex);
+            std::for_each(std::begin(corners), std::end(corners), [&currMesh](Vertex& vertex) {
+                currMesh.vertices.push_back(std::move(vertex));
+            });
 
-                corners[0].texCoords = { s1, t1 };
-                corners[1].texCoords = { s2, t1 };
-                corners[2].texCoords = { s2, t2 };
-                corners[3].texCoords = { s1, t2 };
+            currMesh.indices.push_back(currMesh.elementIndex * 4);
+            currMesh.indices.push_back(currMesh.elementIndex * 4 + 1);
+            currMesh.indices.push_back(currMesh.elementIndex * 4 + 2);
+            currMesh.indices.push_back(currMesh.elementIndex * 4);
+            currMesh.indices.push_back(currMesh.elementIndex * 4 + 2);
+            currMesh.indices.push_back(currMesh.elementIndex * 4 + 3);
+            ++currMesh.elementIndex;
+        }
+
+        return protoMeshes;
+    }
 
-                assert(s1 < 1.f && t1 < 1.f);
+    void TiledMap::buildCollisionGrid(const TMX& tmx)
+    {
+        // Flatten the first rectangle of each tile into a table indexed by
+        // gid, so a probe is two array reads instead of a map search.
+        mTileShapes.assign(1, BoundingBox{ 0, 0, 0, 0 });
+        mShapeOfGid.clear();
+        std::for_each(std::begin(tmx.tilesets), std::end(tmx.tilesets), [&](const TMX::Tileset& tileset) {
+            std::for_each(std::begin(tileset.tiles), std::end(tileset.tiles), [&](const TMX::Tileset::Tile& tile) {
+                auto object = std::find_if(std::begin(tile.objectGroup.objects), std::end(tile.objectGroup.objects), [](const TMX::Tileset::Tile::ObjectGroup::Object& object) {
+                    return object.shape == TMX::Tileset::Tile::ObjectGroup::Object::Shape::RECTANGLE;
+                });
+                if (object == std::end(tile.objectGroup.objects)) { return; }
 
-                ProtoMesh& currMesh = protoMeshes.at(tilesetTextureIndex);
-                std::for_each(std::begin(corners), std::end(corners), [&currMesh](Vertex& vertex) {
-                    currMesh.vertices.push_back(std::move(vertex));
+                unsigned gid = tileset.firstgid + tile.id;
+                if (gid >= mShapeOfGid.size()) {
+                    mShapeOfGid.resize(gid + 1, 0);
+                }
+                mShapeOfGid[gid] = (unsigned)mTileShapes.size();
+                mTileShapes.push_back({
+                    object->x / tileset.tilewidth,
+                    object->y / tileset.tileheight,
+                    object->width / tileset.tilewidth,
+                    object->height / tileset.tileheight
                 });
+            });
+        });
 
-                currMesh.indices.push_back(currMesh.elementIndex * 4);
-                currMesh.indices.push_back(currMesh.elementIndex * 4 + 1);
-                currMesh.indices.push_back(currMesh.elementIndex * 4 + 2);
-                currMesh.indices.push_back(currMesh.elementIndex * 4);
-                currMesh.indices.push_back(currMesh.elementIndex * 4 + 2);
-                currMesh.indices.push_back(currMesh.elementIndex * 4 + 3);
-                ++currMesh.elementIndex;
+        mCollisionLayers.clear();
+        for (const TMX::Layer& layer : tmx.layers) {
+            CollisionLayer collisionLayer{ layer.type == TMX::Layer::Type::TILELAYER, 0, 0, std::vector<unsigned>() };
+            if (collisionLayer.isTileLayer) {
+                collisionLayer.width = layer.width;
+                collisionLayer.height = std::min<unsigned>(layer.height, layer.width ? (unsigned)layer.data.size() / layer.width : 0);
+                collisionLayer.cells.resize(collisionLayer.width * collisionLayer.height);
+                for (std::size_t i = 0; i < collisionLayer.cells.size(); ++i) {
+                    unsigned gid = layer.data[i];
+                    collisionLayer.cells[i] = gid < mShapeOfGid.size() ? mShapeOfGid[gid] : 0;
+                }
             }
+            mCollisionLayers.push_back(std::move(collisionLayer));
+        }
+    }
+
+    void TiledMap::init(const TMX& tmx, TextureManager& tm, JobPool* pPool, StageTimer* pTimer)
+    {
+        if (!mpShader) {
+            throw std::runtime_error{ "TiledMap ctor: requires Shader." };
+        }
+        if (!mpPools) {
+            throw std::runtime_error{ "TiledMap ctor: requires AssetPools." };
+        }
 
-            for (auto it = protoMeshes.begin(); it != protoMeshes.end(); ++it) {
-                it->textures.push_back(textures.at(it - protoMeshes.begin()));
+        mWorldToUnits = glm::scale(glm::vec3(1.f / tmx.tilewidth, 1.f / tmx.tileheight, 1.f)) * glm::inverse(mModelMatrix);
+        mUnitsToWorld = mModelMatrix * glm::scale(glm::vec3((float)tmx.tilewidth, (float)tmx.tileheight, 1.f));
+
+        StageTimer localTimer;
+        StageTimer& timer = pTimer ? *pTimer : localTimer;
+
+        // Sheets decode on the job pool while the layers are built; only
+        // the uploads at the end need this thread.
+        for (const auto& tileset : tmx.tilesets) {
+            tm.prefetch(tileset);
+        }
+
+        std::future<void> grid;
+        auto buildGrid = [&, this] {
+            timer.run("collision grid", [&, this] { buildCollisionGrid(tmx); });
+        };
+
+        std::vector<std::vector<ProtoMesh>> protoLayers(tmx.layers.size());
+        std::vector<TextureHandle> textures;
+        try {
+            if (pPool) {
+                grid = pPool->push(buildGrid);
+            } else {
+                buildGrid();
             }
 
-            std::vector<std::shared_ptr<const Mesh>> meshes;
-            std::for_each(std::begin(protoMeshes), std::end(protoMeshes), [&meshes](ProtoMesh& proto) {
-                if (proto.indices.size() > 0) {
-                    meshes.push_back(std::shared_ptr<const Mesh>(new Mesh{ proto.vertices, proto.indices, proto.textures }));
+            timer.run("tile meshes", [&] {
+                parallelFor(pPool, 0, tmx.layers.size(), 1, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        protoLayers[i] = buildLayerMeshes(tmx, (unsigned)i);
+                    }
+                });
+            });
+
+            timer.run("texture upload", [&] {
+                for (const auto& tileset : tmx.tilesets) {
+                    textures.push_back(tm[tileset]);
                 }
             });
-            mLayers.push_back(Model{ std::move(meshes) });
 
-            protoMeshes.clear();
-            protoMeshes = std::vector<ProtoMesh>(tmx.tilesets.size());
+            timer.run("mesh upload", [&, this] {
+                for (auto& protoMeshes : protoLayers) {
+                    std::vector<MeshHandle> meshes;
+                    for (auto it = protoMeshes.begin(); it != protoMeshes.end(); ++it) {
+                        if (it->indices.size() > 0) {
+                            std::vector<TextureHandle> meshTextures{ textures.at(it - protoMeshes.begin()) };
+                            meshes.push_back(mpPools->meshes.insert(Mesh{ it->vertices, it->indices, meshTextures }, mpPools->getScope()));
+                        }
+                    }
+                    mLayers.push_back(Model{ std::move(meshes) });
+                }
+            });
+        } catch (...) {
+            // The job writes to the collision grid.
+            if (grid.valid()) grid.wait();
+            throw;
         }
 
+        if (grid.valid()) {
+            pPool->wait(grid);
+            grid.get();
+        }
     }
 
     TiledMap::TiledMap(TiledMap&& o)
-        : mpShader(std::move(o.mpShader))
+        : mModelMatrix(o.mModelMatrix)
+        , mWorldToUnits(o.mWorldToUnits)
+        , mUnitsToWorld(o.mUnitsToWorld)
+        , mpShader(std::move(o.mpShader))
+        , mpTMX(std::move(o.mpTMX))
+        , mpPools(std::move(o.mpPools))
+        , mpTextureManager(o.mpTextureManager)
         , mLayers(std::move(o.mLayers))
+        , mShapeOfGid(std::move(o.mShapeOfGid))
+        , mTileShapes(std::move(o.mTileShapes))
+        , mCollisionLayers(std::move(o.mCollisionLayers))
     {}
 
     TiledMap& TiledMap::operator=(TiledMap&& o)
     {
         destroy();
 
+        mModelMatrix = o.mModelMatrix;
+        mWorldToUnits = o.mWorldToUnits;
+        mUnitsToWorld = o.mUnitsToWorld;
         mpShader = std::move(o.mpShader);
+        mpTMX = std::move(o.mpTMX);
+        mpPools = std::move(o.mpPools);
+        mpTextureManager = o.mpTextureManager;
         mLayers = std::move(o.mLayers);
+        mShapeOfGid = std::move(o.mShapeOfGid);
+        mTileShapes = std::move(o.mTileShapes);
+        mCollisionLayers = std::move(o.mCollisionLayers);
 
         return *this;
     }
@@ -182,119 +289,219 @@ namespace te
     void TiledMap::draw(const glm::mat4& viewTransform) const
     {
         std::for_each(std::begin(mLayers), std::end(mLayers), [&, this](const Model& layer) {
-            layer.draw(*mpShader, viewTransform * mModelMatrix);
+            layer.draw(*mpShader, *mpPools, *mpTextureManager, viewTransform * mModelMatrix);
         });
     }
 
-    static unsigned getTileData(const TMX::Layer layer, int x, int y)
+    BoundingBox TiledMap::toUnits(const BoundingBox& worldBB) const
     {
-        int index = y * layer.width + x;
-        if (x < 0 || (unsigned)x >= layer.width || y < 0 || (unsigned)y >= layer.height || index < 0 || (unsigned)index >= layer.data.size()) {
-            return 0;
+        BoundingBox unitBB = mWorldToUnits * worldBB;
+        // A model matrix that flips an axis turns the box inside out.
+        if (unitBB.w < 0) {
+            unitBB.x += unitBB.w;
+            unitBB.w = -unitBB.w;
+        }
+        if (unitBB.h < 0) {
+            unitBB.y += unitBB.h;
+            unitBB.h = -unitBB.h;
         }
-        return layer.data[index];
+        return unitBB;
     }
 
-    bool TiledMap::checkUnitCollision(const BoundingBox& unitBB, const TMX::Layer& layer) const
+    const TiledMap::CollisionLayer& TiledMap::getCollisionLayer(unsigned layerIndex) const
     {
-        for (int x = (int)unitBB.x; x < (int)(unitBB.x + unitBB.w) + 1; ++x) {
-            for (int y = (int)unitBB.y; y < (int)(unitBB.y + unitBB.h) + 1; ++y) {
-                unsigned gid = getTileData(layer, x, y);
-
-                if (gid == 0) { continue; }
-
-                auto collisionRectIt = mCollisionRects.find(gid);
-                if (collisionRectIt != mCollisionRects.end()) {
-                    bool collision = te::checkCollision(
-                        unitBB,
-                        glm::translate(glm::vec3(x, y, 0)) * collisionRectIt->second);
-                    if (collision) {
-                        return true;
-                    }
+        const CollisionLayer& layer = mCollisionLayers.at(layerIndex);
+        if (!layer.isTileLayer) {
+            throw std::runtime_error{ "TiledMap: layer is not a tile layer." };
+        }
+        return layer;
+    }
+
+    // Calls fn(x, y, shape) for every tile with a collision shape that the
+    // box covers, the tiles clamped to the layer so the loop needs no
+    // bounds checks. Stops early when fn returns true.
+    template <typename Fn>
+    static bool forEachCoveredShape(const BoundingBox& unitBB, unsigned width, unsigned height, const std::vector<unsigned>& cells, Fn fn)
+    {
+        int x0 = std::max((int)std::floor(unitBB.x), 0);
+        int y0 = std::max((int)std::floor(unitBB.y), 0);
+        int x1 = std::min((int)std::floor(unitBB.x + unitBB.w), (int)width - 1);
+        int y1 = std::min((int)std::floor(unitBB.y + unitBB.h), (int)height - 1);
+
+        for (int y = y0; y <= y1; ++y) {
+            const unsigned* row = cells.data() + y * width;
+            for (int x = x0; x <= x1; ++x) {
+                if (row[x] != 0 && fn(x, y, row[x])) {
+                    return true;
                 }
             }
         }
         return false;
     }
 
-    //bool TiledMap::checkCollision(const BoundingBox& worldBB) const
-    //{
-    //    BoundingBox unitBB = glm::scale(glm::vec3(1.f/mpTMX->tilewidth, 1.f/mpTMX->tileheight, 1)) *
-    //        glm::inverse(mpShader->getModel()) * worldBB;
-
-    //    bool collision = false;
-    //    for (auto it = mpTMX->layers.begin(); it != mpTMX->layers.end(); ++it) {
-    //        if (it->type != TMX::Layer::Type::TILELAYER) {
-    //            continue;
-    //        }
-    //        collision = checkUnitCollision(unitBB, *it);
-    //        if (collision) {
-    //            break;
-    //        }
-    //    };
-    //    return collision;
-    //}
-
-    //bool TiledMap::checkCollision(const BoundingBox& worldBB, unsigned layerIndex) const
-    //{
-    //    BoundingBox unitBB = glm::scale(glm::vec3(1.f/mpTMX->tilewidth, 1.f/mpTMX->tileheight, 1)) *
-    //        glm::inverse(mpShader->getModel()) * worldBB;
-
-    //    const TMX::Layer& layer = mpTMX->layers.at(layerIndex);
-    //    if (layer.type != TMX::Layer::Type::TILELAYER) {
-    //        throw std::runtime_error{ "getTileData: layer is not a tile data." };
-    //    }
-
-    //    return checkUnitCollision(unitBB, layer);
-    //}
-
-    //std::vector<BoundingBox>& TiledMap::getIntersections(const BoundingBox& worldBB, std::vector<BoundingBox>& bbs) const
-    //{
-    //    BoundingBox unitBB = glm::scale(glm::vec3(1.f/mpTMX->tilewidth, 1.f/mpTMX->tileheight, 1)) *
-    //        glm::inverse(mpShader->getModel()) * worldBB;
-
-    //    for (auto it = mpTMX->layers.begin(); it != mpTMX->layers.end(); ++it) {
-    //        if (it->type != TMX::Layer::Type::TILELAYER) {
-    //            continue;
-    //        }
-    //        getUnitIntersections(unitBB, *it, bbs);
-    //    };
-
-    //    return bbs;
-    //}
-
-    //std::vector<BoundingBox>& TiledMap::getIntersections(const BoundingBox& worldBB, unsigned layerIndex, std::vector<BoundingBox>& bbs) const
-    //{
-    //    BoundingBox unitBB = glm::scale(glm::vec3(1.f/mpTMX->tilewidth, 1.f/mpTMX->tileheight, 1)) *
-    //        glm::inverse(mpShader->getModel()) * worldBB;
-
-    //    const TMX::Layer& layer = mpTMX->layers.at(layerIndex);
-    //    if (layer.type != TMX::Layer::Type::TILELAYER) {
-    //        throw std::runtime_error{ "getTileData: layer is not a tile data." };
-    //    }
-
-    //    getUnitIntersections(unitBB, layer, bbs);
-    //    return bbs;
-    //}
-
-    //void TiledMap::getUnitIntersections(const BoundingBox& unitBB, const TMX::Layer& layer, std::vector<BoundingBox>& bbs) const
-    //{
-    //    for (int x = (int)unitBB.x; x < (int)(unitBB.x + unitBB.w) + 1; ++x) {
-    //        for (int y = (int)unitBB.y; y < (int)(unitBB.y + unitBB.h) + 1; ++y) {
-    //            unsigned gid = getTileData(layer, x, y);
-
-    //            if (gid == 0) { continue; }
-
-    //            auto collisionRectIt = mCollisionRects.find(gid);
-    //            if (collisionRectIt != mCollisionRects.end()) {
-    //                BoundingBox translatedBB = glm::translate(glm::vec3(x, y, 0)) * collisionRectIt->second;
-    //                if (te::checkCollision(unitBB, translatedBB)) {
-    //                    bbs.push_back(mpShader->getModel() * glm::scale(glm::vec3(16.f, 16.f, 1.f)) * te::getIntersection(unitBB, translatedBB));
-    //                }
-    //            }
-    //        }
-    //    }
-    //}
+    static BoundingBox placeShape(const BoundingBox& shape, int x, int y)
+    {
+        return{ shape.x + x, shape.y + y, shape.w, shape.h };
+    }
+
+    bool TiledMap::checkUnitCollision(const BoundingBox& unitBB, const CollisionLayer& layer) const
+    {
+        const std::vector<BoundingBox>& shapes = mTileShapes;
+        return forEachCoveredShape(unitBB, layer.width, layer.height, layer.cells, [&](int x, int y, unsigned shape) {
+            return te::checkCollision(unitBB, placeShape(shapes[shape], x, y));
+        });
+    }
+
+    void TiledMap::getUnitIntersections(const BoundingBox& unitBB, const CollisionLayer& layer, std::vector<BoundingBox>& bbs) const
+    {
+        const std::vector<BoundingBox>& shapes = mTileShapes;
+        const glm::mat4& unitsToWorld = mUnitsToWorld;
+        forEachCoveredShape(unitBB, layer.width, layer.height, layer.cells, [&](int x, int y, unsigned shape) {
+            BoundingBox tileBB = placeShape(shapes[shape], x, y);
+            if (te::checkCollision(unitBB, tileBB)) {
+                bbs.push_back(unitsToWorld * te::getIntersection(unitBB, tileBB));
+            }
+            return false;
+        });
+    }
+
+    bool TiledMap::checkCollision(const BoundingBox& worldBB) const
+    {
+        BoundingBox unitBB = toUnits(worldBB);
+        for (const CollisionLayer& layer : mCollisionLayers) {
+            if (layer.isTileLayer && checkUnitCollision(unitBB, layer)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool TiledMap::checkCollision(const BoundingBox& worldBB, unsigned layerIndex) const
+    {
+        return checkUnitCollision(toUnits(worldBB), getCollisionLayer(layerIndex));
+    }
+
+    std::vector<BoundingBox>& TiledMap::getIntersections(const BoundingBox& worldBB, std::vector<BoundingBox>& bbs) const
+    {
+        BoundingBox unitBB = toUnits(worldBB);
+        for (const CollisionLayer& layer : mCollisionLayers) {
+            if (layer.isTileLayer) {
+                getUnitIntersections(unitBB, layer, bbs);
+            }
+        }
+        return bbs;
+    }
+
+    std::vector<BoundingBox>& TiledMap::getIntersections(const BoundingBox& worldBB, unsigned layerIndex, std::vector<BoundingBox>& bbs) const
+    {
+        getUnitIntersections(toUnits(worldBB), getCollisionLayer(layerIndex), bbs);
+        return bbs;
+    }
+
+    std::vector<bool>& TiledMap::checkCollisions(const std::vector<BoundingBox>& boxes, std::vector<bool>& collisions) const
+    {
+        collisions.assign(boxes.size(), false);
+        for (const CollisionLayer& layer : mCollisionLayers) {
+            if (!layer.isTileLayer) { continue; }
+            for (std::size_t i = 0; i < boxes.size(); ++i) {
+                if (!collisions[i]) {
+                    collisions[i] = checkUnitCollision(toUnits(boxes[i]), layer);
+                }
+            }
+        }
+        return collisions;
+    }
+
+    void TiledMap::getIntersections(const std::vector<BoundingBox>& boxes, std::vector<BoundingBox>& bbs, std::vector<unsigned>& offsets) const
+    {
+        bbs.clear();
+        offsets.clear();
+        offsets.reserve(boxes.size() + 1);
+        for (const BoundingBox& box : boxes) {
+            offsets.push_back((unsigned)bbs.size());
+            getIntersections(box, bbs);
+        }
+        offsets.push_back((unsigned)bbs.size());
+    }
+
+    // Time of impact of unitBB moving by d against a static shape, along
+    // each axis in turn, as a fraction of d. Negative when they never meet.
+    static float sweepShape(const BoundingBox& unitBB, const glm::vec2& d, const BoundingBox& shape, int& axis)
+    {
+        const float infinity = std::numeric_limits<float>::infinity();
+        float boxMin[2] = { unitBB.x, unitBB.y };
+        float boxMax[2] = { unitBB.x + unitBB.w, unitBB.y + unitBB.h };
+        float shapeMin[2] = { shape.x, shape.y };
+        float shapeMax[2] = { shape.x + shape.w, shape.y + shape.h };
+
+        float entry[2], exit[2];
+        for (int i = 0; i < 2; ++i) {
+            if (d[i] > 0) {
+                entry[i] = (shapeMin[i] - boxMax[i]) / d[i];
+                exit[i] = (shapeMax[i] - boxMin[i]) / d[i];
+            } else if (d[i] < 0) {
+                entry[i] = (shapeMax[i] - boxMin[i]) / d[i];
+                exit[i] = (shapeMin[i] - boxMax[i]) / d[i];
+            } else if (boxMax[i] <= shapeMin[i] || boxMin[i] >= shapeMax[i]) {
+                return -1.f;
+            } else {
+                entry[i] = -infinity;
+                exit[i] = infinity;
+            }
+        }
+
+        // Prefer the floor on exact corners, so bodies land rather than snag.
+        axis = entry[0] > entry[1] ? 0 : 1;
+        float tEntry = entry[axis];
+        float tExit = std::min(exit[0], exit[1]);
+
+        // Allow for boxes left touching a shape by rounding.
+        const float touching = -1e-4f;
+        if (tEntry >= tExit || tEntry < touching || tEntry > 1.f) {
+            return -1.f;
+        }
+        return std::max(tEntry, 0.f);
+    }
+
+    float TiledMap::sweep(const BoundingBox& box, const glm::vec2& displacement, glm::vec2& normal) const
+    {
+        BoundingBox unitBB = toUnits(box);
+        glm::vec2 d(mWorldToUnits * glm::vec4(displacement, 0, 0));
+        normal = glm::vec2(0.f);
+        if (d.x == 0 && d.y == 0) { return 1.f; }
+
+        // Every tile the box passes over.
+        BoundingBox swept{
+            unitBB.x + std::min(d.x, 0.f),
+            unitBB.y + std::min(d.y, 0.f),
+            unitBB.w + std::abs(d.x),
+            unitBB.h + std::abs(d.y)
+        };
+
+        const std::vector<BoundingBox>& shapes = mTileShapes;
+        float toi = 1.f;
+        int hitAxis = -1;
+        for (const CollisionLayer& layer : mCollisionLayers) {
+            if (!layer.isTileLayer) { continue; }
+            forEachCoveredShape(swept, layer.width, layer.height, layer.cells, [&](int x, int y, unsigned shape) {
+                int axis;
+                float t = sweepShape(unitBB, d, placeShape(shapes[shape], x, y), axis);
+                if (t >= 0 && t < toi) {
+                    toi = t;
+                    hitAxis = axis;
+                }
+                return false;
+            });
+        }
+
+        if (hitAxis >= 0) {
+            glm::vec2 unitNormal(0.f);
+            unitNormal[hitAxis] = d[hitAxis] > 0 ? -1.f : 1.f;
+            // Normals transform by the inverse transpose.
+            normal = glm::normalize(glm::vec2(glm::transpose(mWorldToUnits) * glm::vec4(unitNormal, 0, 0)));
+        }
+        return toi;
+    }
 
     void* TiledMap::operator new(std::size_t sz)
     {
@@ -8,12 +8,14 @@
 
 #include <string>
 #include <vector>
-#include <map>
 #include <memory>
 
 namespace te
 {
     class TextureManager;
+    struct AssetPools;
+    class JobPool;
+    class StageTimer;
     struct BoundingBox;
     class Mesh;
     class Model;
@@ -21,35 +23,74 @@ namespace te
 
     class TiledMap {
     public:
-        TiledMap(const std::string& path, const std::string& file, std::shared_ptr<const Shader> pShader, const glm::mat4& model, TextureManager* tm = nullptr);
-        TiledMap(std::shared_ptr<const TMX> pTMX, std::shared_ptr<const Shader> pShader, const glm::mat4& model, TextureManager* tm = nullptr);
+        // Layer meshes go into the pools' current scope. Given a job pool,
+        // layers are built and collision rects gathered on workers while
+        // textures decode; pTimer, if given, records each stage.
+        TiledMap(const std::string& path, const std::string& file, std::shared_ptr<const Shader> pShader, const glm::mat4& model, TextureManager& tm, std::shared_ptr<AssetPools> pPools, JobPool* pPool = nullptr, StageTimer* pTimer = nullptr);
+        TiledMap(std::shared_ptr<const TMX> pTMX, std::shared_ptr<const Shader> pShader, const glm::mat4& model, TextureManager& tm, std::shared_ptr<AssetPools> pPools, JobPool* pPool = nullptr, StageTimer* pTimer = nullptr);
         ~TiledMap();
         TiledMap(TiledMap&&);
         TiledMap& operator=(TiledMap&&);
 
         void draw(const glm::mat4& viewTransform = glm::mat4()) const;
 
+        // Boxes are in world space, as are the intersections appended.
         bool checkCollision(const BoundingBox&) const;
         bool checkCollision(const BoundingBox&, unsigned layerIndex) const;
         std::vector<BoundingBox>& getIntersections(const BoundingBox&, std::vector<BoundingBox>& intersections) const;
         std::vector<BoundingBox>& getIntersections(const BoundingBox&, unsigned layerIndex, std::vector<BoundingBox>& intersections) const;
 
+        // Tests many boxes against every tile layer in one call.
+        // collisions[i] tells whether boxes[i] hits a tile.
+        std::vector<bool>& checkCollisions(const std::vector<BoundingBox>& boxes, std::vector<bool>& collisions) const;
+        // Replaces intersections; those of boxes[i] are intersections[offsets[i]]
+        // up to intersections[offsets[i + 1]].
+        void getIntersections(const std::vector<BoundingBox>& boxes, std::vector<BoundingBox>& intersections, std::vector<unsigned>& offsets) const;
+
+        // Moves a world space box along displacement and returns the
+        // fraction travelled before it first touches a tile shape, 1 if it
+        // touches none. normal is set to the face hit. Shapes the box
+        // already overlaps are ignored so it can move out of them.
+        float sweep(const BoundingBox& box, const glm::vec2& displacement, glm::vec2& normal) const;
+
         static void* operator new(std::size_t);
         static void operator delete(void*);
     private:
         TiledMap(const TiledMap&) = delete;
         TiledMap& operator=(const TiledMap&) = delete;
 
-        void init(const TMX& tmx, TextureManager* tm);
+        // One per map layer. Cells hold indices into mTileShapes, 0 where
+        // the tile has no collision shape. Empty for object layers.
+        struct CollisionLayer {
+            bool isTileLayer;
+            unsigned width;
+            unsigned height;
+            std::vector<unsigned> cells;
+        };
+
+        void init(const TMX& tmx, TextureManager& tm, JobPool* pPool, StageTimer* pTimer);
+        void buildCollisionGrid(const TMX& tmx);
         void destroy();
-        bool checkUnitCollision(const BoundingBox& unitBB, const TMX::Layer& layer) const;
-        void getUnitIntersections(const BoundingBox& unitBB, const TMX::Layer& layer, std::vector<BoundingBox>& intersections) const;
+        BoundingBox toUnits(const BoundingBox& worldBB) const;
+        const CollisionLayer& getCollisionLayer(unsigned layerIndex) const;
+        bool checkUnitCollision(const BoundingBox& unitBB, const CollisionLayer& layer) const;
+        void getUnitIntersections(const BoundingBox& unitBB, const CollisionLayer& layer, std::vector<BoundingBox>& intersections) const;
 
         glm::mat4 mModelMatrix;
+        // Between world space and tile units, where tile (x, y) spans
+        // x to x + 1 and y to y + 1.
+        glm::mat4 mWorldToUnits;
+        glm::mat4 mUnitsToWorld;
         std::shared_ptr<const Shader> mpShader;
         std::shared_ptr<const TMX> mpTMX;
+        std::shared_ptr<AssetPools> mpPools;
+        // Outlived by whoever passed it in, which owns the map.
+        TextureManager* mpTextureManager;
         std::vector<Model> mLayers;
-        std::map<unsigned, const BoundingBox> mCollisionRects;
+        // Indexed by gid. The first shape is a placeholder for index 0.
+        std::vector<unsigned> mShapeOfGid;
+        std::vector<BoundingBox> mTileShapes;
+        std::vector<CollisionLayer> mCollisionLayers;
     };
 }
 
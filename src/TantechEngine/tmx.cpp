@@ -3,8 +3,11 @@
 #include "transform_component.h"
 #include "animation_component.h"
 #include "animation_factory.h"
+#include "asset_pools.h"
 #include "data_component.h"
+#include "bounding_box_component.h"
 #include "ecs.h"
+#include "asset_pack.h"
 
 #include <lua.hpp>
 #include <LuaBridge.h>
@@ -72,7 +75,8 @@ namespace te
     static luabridge::LuaRef getTMXRef(lua_State *L, const std::string& path, const std::string& filename)
     {
         luaL_openlibs(L);
-        int status = luaL_dofile(L, "assets/tiled/map_loader.lua");
+        openAssetLoaders(L);
+        int status = doLuaAsset(L, "assets/tiled/map_loader.lua");
 
         if (status) { throw std::runtime_error("Could not load script."); }
 
@@ -379,13 +383,17 @@ namespace te
                         glm::translate(glm::vec3((float)object.x / (float)tmx.tilewidth, (float)(object.y - object.height) / (float)tmx.tileheight, layerIndex)),
                         glm::vec3((float)object.width / (float)tileset.tilewidth, (float)object.height / (float)tileset.tileheight, 1.f)));
 
-                std::shared_ptr<const Animation> pAnimation(new Animation{
-                    assets.pAnimationFactory->create(object.gid)
-                });
+                AnimationHandle animation = assets.pPools->animations.insert(
+                    assets.pAnimationFactory->create(object.gid),
+                    assets.pPools->getScope());
                 ecs.pAnimationComponent->setAnimations(entity, {
-                    {0, pAnimation}
+                    {0, animation}
                 }, 0);
 
+                // The box covers the object's mesh, whose origin is its corner.
+                glm::vec2 tileSize((float)tileset.tilewidth / (float)tmx.tilewidth, (float)tileset.tileheight / (float)tmx.tileheight);
+                ecs.pBoundingBoxComponent->setBoundingBox(entity, tileSize, tileSize / 2.f);
+
                 ecs.pDataComponent->create(entity, object.id);
                 ecs.pDataComponent->setData(entity, { "name", object.name });
             });
@@ -22,10 +22,19 @@ namespace te
     void TransformComponent::setParent(const Entity& child, const Entity& parent)
     {
         if (!hasInstance(child)) { createInstance(child, createTransformInstance(child)); }
+        if (!hasInstance(parent)) { createInstance(parent, createTransformInstance(parent)); }
+        unlink(child);
+
+        // Pushed to the front of the parent's children.
         TransformInstance& childInstance = at(child);
+        TransformInstance& parentInstance = at(parent);
         childInstance.parent = parent;
-        glm::mat4 parentTransform = at(parent).world;
-        transformTree(childInstance, parentTransform);
+        if (parentInstance.firstChild != parent) {
+            childInstance.nextSibling = parentInstance.firstChild;
+            at(parentInstance.firstChild).prevSibling = child;
+        }
+        parentInstance.firstChild = child;
+        transformTree(child, parentInstance.world);
     }
 
     glm::mat4 TransformComponent::setLocalTransform(const Entity& entity, const glm::mat4& transform)
@@ -37,8 +46,7 @@ namespace te
             instance.parent != entity ?
             at(instance.parent).world :
             glm::mat4();
-        transformTree(instance, parentTransform);
-        notify({ entity, instance.world });
+        transformTree(entity, parentTransform);
         return instance.local;
     }
 
@@ -64,8 +72,7 @@ namespace te
             throw std::runtime_error("TransformComponent::multiplyTransform: Invalid space.");
         }
 
-        transformTree(instance, parentTransform);
-        notify({ entity, instance.world });
+        transformTree(entity, parentTransform);
         return instance.local;
     }
 
@@ -93,22 +100,40 @@ namespace te
         }
     }
 
-    void TransformComponent::transformTree(TransformInstance& instance, const glm::mat4& parentTransform)
+    // Every entity whose world transform changes is notified, so observers
+    // such as the spatial index see children move with their parent.
+    void TransformComponent::transformTree(const Entity& entity, const glm::mat4& parentTransform)
     {
+        TransformInstance& instance = at(entity);
         instance.world = parentTransform * instance.local;
+        notify({ entity, instance.world });
 
-        TransformInstance& childInstance = at(instance.firstChild);
-        while (&instance != &childInstance)
-        {
-            transformTree(childInstance, instance.world);
-            if (&at(childInstance.nextSibling) != &childInstance)
-            {
-                childInstance = at(childInstance.nextSibling);
-            }
-            else
-            {
-                childInstance = instance;
-            }
+        // Links to the entity itself end the child and sibling lists.
+        Entity child = instance.firstChild;
+        while (child != entity) {
+            transformTree(child, instance.world);
+            const TransformInstance& childInstance = at(child);
+            child = childInstance.nextSibling != child ? childInstance.nextSibling : entity;
+        }
+    }
+
+    void TransformComponent::unlink(const Entity& child)
+    {
+        TransformInstance& instance = at(child);
+        if (instance.parent == child) { return; }
+
+        bool hasPrev = instance.prevSibling != child;
+        bool hasNext = instance.nextSibling != child;
+        if (hasPrev) {
+            at(instance.prevSibling).nextSibling = hasNext ? instance.nextSibling : instance.prevSibling;
+        } else {
+            at(instance.parent).firstChild = hasNext ? instance.nextSibling : instance.parent;
+        }
+        if (hasNext) {
+            at(instance.nextSibling).prevSibling = hasPrev ? instance.prevSibling : instance.nextSibling;
         }
+        instance.parent = child;
+        instance.nextSibling = child;
+        instance.prevSibling = child;
     }
 }
@@ -48,7 +48,8 @@ namespace te
         TransformComponent(const TransformComponent&) = delete;
         TransformComponent& operator=(const TransformComponent&) = delete;
 
-        void transformTree(TransformInstance& instance, const glm::mat4& parentTransform);
+        void transformTree(const Entity& entity, const glm::mat4& parentTransform);
+        void unlink(const Entity& child);
     };
 
     typedef std::shared_ptr<TransformComponent> TransformPtr;
@@ -0,0 +1,46 @@
+#include <asset_pool.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace te
+{
+    TEST(AssetPool, Handles) {
+        AssetPool<std::string> pool;
+        Handle<std::string> a = pool.insert("a");
+        Handle<std::string> b = pool.insert("b");
+        Handle<std::string> c = pool.insert("c");
+        EXPECT_EQ(3u, pool.size());
+        EXPECT_EQ("b", pool[b]);
+
+        // Erasing moves the last asset into the hole; handles still resolve.
+        pool.erase(a);
+        EXPECT_FALSE(pool.contains(a));
+        EXPECT_EQ(nullptr, pool.find(a));
+        EXPECT_EQ("b", pool[b]);
+        EXPECT_EQ("c", pool[c]);
+
+        // The slot is reused under a new generation.
+        Handle<std::string> d = pool.insert("d");
+        EXPECT_NE(a, d);
+        EXPECT_FALSE(pool.contains(a));
+        EXPECT_EQ("d", pool[d]);
+        EXPECT_FALSE(pool.contains(Handle<std::string>{ 0 }));
+    }
+
+    TEST(AssetPool, Scopes) {
+        AssetPool<std::string> pool;
+        Handle<std::string> global = pool.insert("global");
+        Handle<std::string> level1 = pool.insert("level1", 1);
+        Handle<std::string> level2 = pool.insert("level2", 2);
+        Handle<std::string> level1b = pool.insert("level1b", 1);
+
+        pool.eraseScope(1);
+        EXPECT_EQ(2u, pool.size());
+        EXPECT_FALSE(pool.contains(level1));
+        EXPECT_FALSE(pool.contains(level1b));
+        EXPECT_EQ("global", pool[global]);
+        EXPECT_EQ("level2", pool[level2]);
+    }
+}
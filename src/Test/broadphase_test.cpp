@@ -0,0 +1,54 @@
+#include <broadphase.h>
+#include <bounding_box_component.h>
+#include <auxiliary.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace te
+{
+    static AABBArray makeBoxes(unsigned count, float worldSize, float maxSize)
+    {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> position(0.f, worldSize);
+        std::uniform_real_distribution<float> size(0.f, maxSize);
+
+        AABBArray boxes;
+        for (unsigned i = 0; i < count; ++i) {
+            boxes.push({ position(rng), position(rng), size(rng), size(rng) });
+        }
+        // Edges that only touch do not collide.
+        boxes.push({ 0.f, 0.f, 1.f, 1.f });
+        boxes.push({ 1.f, 0.f, 1.f, 1.f });
+        return boxes;
+    }
+
+    static std::vector<IndexPair> bruteForce(const AABBArray& boxes)
+    {
+        std::vector<IndexPair> pairs;
+        for (unsigned a = 0; a < boxes.size(); ++a) {
+            for (unsigned b = a + 1; b < boxes.size(); ++b) {
+                if (checkCollision(boxes.get(a), boxes.get(b))) {
+                    pairs.push_back({ a, b });
+                }
+            }
+        }
+        return pairs;
+    }
+
+    TEST(Broadphase, MatchesAllPairs) {
+        AABBArray boxes = makeBoxes(500, 100.f, 8.f);
+
+        std::vector<IndexPair> pairs;
+        std::vector<unsigned> order;
+        sweepAndPrune(boxes, pairs, order);
+        std::sort(pairs.begin(), pairs.end());
+
+        std::vector<IndexPair> expected = bruteForce(boxes);
+        ASSERT_FALSE(expected.empty());
+        EXPECT_EQ(expected, pairs);
+    }
+}
@@ -0,0 +1,102 @@
+#include <image_ops.h>
+#include <job_pool.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace te
+{
+    // Odd sizes so the vector loops leave a scalar tail on every row.
+    static std::vector<GLuint> makePixels(GLuint width, GLuint height)
+    {
+        std::vector<GLuint> pixels(width * height);
+        GLuint state = 12345;
+        for (auto& pixel : pixels) {
+            state = state * 1664525 + 1013904223;
+            pixel = state;
+        }
+        for (GLuint i = 0; i < pixels.size(); i += 7) {
+            pixels[i] = 0x40ff00ff;
+        }
+        return pixels;
+    }
+
+    TEST(ImageOps, ColorKey) {
+        auto pixels = makePixels(37, 29);
+        auto keyed = pixels;
+        JobPool pool(3);
+        applyColorKey(keyed.data(), 37, 29, 255, 0, 255, 0, &pool);
+
+        for (GLuint i = 0; i < pixels.size(); ++i) {
+            GLuint expected = (pixels[i] & 0x00ffffff) == 0x00ff00ff ? 0x00ffffff : pixels[i];
+            ASSERT_EQ(expected, keyed[i]) << "Pixel " << i;
+        }
+    }
+
+    TEST(ImageOps, PremultiplyAlpha) {
+        auto pixels = makePixels(37, 29);
+        auto premultiplied = pixels;
+        premultiplyAlpha(premultiplied.data(), 37, 29);
+
+        for (GLuint i = 0; i < pixels.size(); ++i) {
+            GLuint alpha = pixels[i] >> 24;
+            for (GLuint shift = 0; shift < 24; shift += 8) {
+                GLuint expected = (((pixels[i] >> shift) & 0xff) * alpha + 127) / 255;
+                ASSERT_EQ(expected, (premultiplied[i] >> shift) & 0xff) << "Pixel " << i;
+            }
+            ASSERT_EQ(alpha, premultiplied[i] >> 24);
+        }
+    }
+
+    TEST(ImageOps, Luminance) {
+        auto pixels = makePixels(37, 29);
+        std::vector<GLubyte> luminance(pixels.size());
+        std::vector<GLuint> grey(pixels.size());
+        rgbaToLuminance(pixels.data(), luminance.data(), 37, 29);
+        luminanceToRgba(luminance.data(), grey.data(), 37, 29);
+
+        for (GLuint i = 0; i < pixels.size(); ++i) {
+            GLuint p = pixels[i];
+            GLuint expected = (54 * (p & 0xff) + 183 * ((p >> 8) & 0xff) + 19 * ((p >> 16) & 0xff) + 128) >> 8;
+            ASSERT_EQ(expected, luminance[i]) << "Pixel " << i;
+            ASSERT_EQ(expected * 0x010101 | 0xff000000, grey[i]) << "Pixel " << i;
+        }
+    }
+
+    TEST(ImageOps, PadCanvas) {
+        auto pixels = makePixels(37, 29);
+        auto canvas = padCanvas32(pixels.data(), 37, 29, 64, 32, 0x00ffffff);
+
+        ASSERT_EQ(64u * 32u, canvas.size());
+        for (GLuint y = 0; y < 32; ++y) {
+            for (GLuint x = 0; x < 64; ++x) {
+                GLuint expected = x < 37 && y < 29 ? pixels[y * 37 + x] : 0x00ffffff;
+                ASSERT_EQ(expected, canvas[y * 64 + x]) << x << ", " << y;
+            }
+        }
+        EXPECT_THROW(padCanvas32(pixels.data(), 37, 29, 32, 32, 0), std::runtime_error);
+    }
+
+    TEST(ImageOps, ExtrudeTiles) {
+        // Three by two tiles of 5x4, margin 2 and spacing 1.
+        const GLuint width = 2 * 2 + 3 * 5 + 2, height = 2 * 2 + 2 * 4 + 1;
+        std::vector<GLuint> sheet(width * height);
+        for (GLuint i = 0; i < sheet.size(); ++i) sheet[i] = i;
+
+        GLuint outWidth = 0, outHeight = 0;
+        auto extruded = extrudeTiles(sheet.data(), width, height, 5, 4, 2, 1, 2, outWidth, outHeight);
+        ASSERT_EQ(3u * 9u, outWidth);
+        ASSERT_EQ(2u * 8u, outHeight);
+
+        for (GLuint y = 0; y < outHeight; ++y) {
+            for (GLuint x = 0; x < outWidth; ++x) {
+                int tileX = std::min(std::max((int)(x % 9) - 2, 0), 4);
+                int tileY = std::min(std::max((int)(y % 8) - 2, 0), 3);
+                GLuint expected = sheet[(2 + y / 8 * 5 + tileY) * width + 2 + x / 9 * 6 + tileX];
+                ASSERT_EQ(expected, extruded[y * outWidth + x]) << x << ", " << y;
+            }
+        }
+    }
+}
@@ -0,0 +1,203 @@
+#include <spatial_index.h>
+#include <bounding_box_component.h>
+#include <transform_component.h>
+#include <entity_manager.h>
+
+#include <gtest/gtest.h>
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace te
+{
+    class SpatialIndexTest : public ::testing::Test {
+    protected:
+        SpatialIndexTest()
+            : pTransform(new TransformComponent())
+            , pBoundingBox(new BoundingBoxComponent(pTransform))
+            , pIndex(new SpatialIndex(pBoundingBox))
+            , entityManager(EntityManager::ObserverVector{ pTransform, pBoundingBox, pIndex })
+            , entities()
+            , rng(42)
+        {
+            pTransform->addObserver(pIndex);
+            pBoundingBox->addObserver(pIndex);
+        }
+
+        void createEntities(unsigned count)
+        {
+            std::uniform_real_distribution<float> size(0.5f, 3.f);
+            for (unsigned i = 0; i < count; ++i) {
+                Entity entity = entityManager.create();
+                pBoundingBox->setBoundingBox(entity, glm::vec2(size(rng), size(rng)), glm::vec2(0.f));
+                entities.push_back(entity);
+            }
+            moveEntities(100.f);
+        }
+
+        void moveEntities(float worldSize)
+        {
+            std::uniform_real_distribution<float> position(0.f, worldSize);
+            for (const Entity& entity : entities) {
+                pTransform->setLocalTransform(entity, glm::translate(glm::vec3(position(rng), position(rng), 0.f)));
+            }
+        }
+
+        std::vector<Entity> bruteForceRegion(const BoundingBox& region) const
+        {
+            std::vector<Entity> result;
+            for (const Entity& entity : entities) {
+                BoundingBox bb = pBoundingBox->getBoundingBox(entity);
+                if (bb.x <= region.x + region.w && region.x <= bb.x + bb.w &&
+                    bb.y <= region.y + region.h && region.y <= bb.y + bb.h) {
+                    result.push_back(entity);
+                }
+            }
+            std::sort(result.begin(), result.end());
+            return result;
+        }
+
+        float distanceTo(const Entity& entity, const glm::vec2& point) const
+        {
+            BoundingBox bb = pBoundingBox->getBoundingBox(entity);
+            return distanceSquared({ { bb.x, bb.y }, { bb.x + bb.w, bb.y + bb.h } }, point);
+        }
+
+        std::shared_ptr<TransformComponent> pTransform;
+        std::shared_ptr<BoundingBoxComponent> pBoundingBox;
+        std::shared_ptr<SpatialIndex> pIndex;
+        EntityManager entityManager;
+        std::vector<Entity> entities;
+        std::mt19937 rng;
+    };
+
+    TEST_F(SpatialIndexTest, RegionAndRadius) {
+        createEntities(500);
+        std::vector<Entity> found;
+
+        for (int pass = 0; pass < 3; ++pass) {
+            BoundingBox region{ 20.f + pass, 30.f, 25.f, 10.f };
+            pIndex->queryRegion(region, found);
+            std::sort(found.begin(), found.end());
+            EXPECT_EQ(bruteForceRegion(region), found);
+
+            glm::vec2 center(50.f, 50.f + pass);
+            pIndex->queryRadius(center, 12.f, found);
+            std::sort(found.begin(), found.end());
+            std::vector<Entity> expected;
+            for (const Entity& entity : entities) {
+                if (distanceTo(entity, center) <= 144.f) { expected.push_back(entity); }
+            }
+            std::sort(expected.begin(), expected.end());
+            EXPECT_EQ(expected, found);
+
+            // Everything moves, most of it out of its fat box.
+            moveEntities(100.f);
+        }
+
+        EXPECT_EQ(500u, pIndex->getCount());
+        EXPECT_LE(pIndex->getTree().getHeight(), 20);
+    }
+
+    TEST_F(SpatialIndexTest, Batched) {
+        createEntities(300);
+        std::vector<BoundingBox> regions{ { 0.f, 0.f, 10.f, 10.f }, { 40.f, 40.f, 30.f, 5.f }, { 200.f, 200.f, 1.f, 1.f } };
+        std::vector<Entity> found;
+        std::vector<unsigned> offsets;
+        pIndex->queryRegions(regions, found, offsets);
+
+        ASSERT_EQ(regions.size() + 1, offsets.size());
+        for (unsigned i = 0; i < regions.size(); ++i) {
+            std::vector<Entity> batch(found.begin() + offsets[i], found.begin() + offsets[i + 1]);
+            std::sort(batch.begin(), batch.end());
+            EXPECT_EQ(bruteForceRegion(regions[i]), batch);
+        }
+    }
+
+    TEST_F(SpatialIndexTest, Nearest) {
+        createEntities(400);
+        glm::vec2 point(37.f, 61.f);
+        std::vector<Entity> found;
+        pIndex->queryNearest(point, 10, found);
+
+        std::vector<float> expected;
+        for (const Entity& entity : entities) {
+            expected.push_back(distanceTo(entity, point));
+        }
+        std::sort(expected.begin(), expected.end());
+
+        ASSERT_EQ(10u, found.size());
+        for (unsigned i = 0; i < found.size(); ++i) {
+            EXPECT_FLOAT_EQ(expected[i], distanceTo(found[i], point));
+        }
+    }
+
+    TEST_F(SpatialIndexTest, Raycast) {
+        Entity near = entityManager.create();
+        Entity far = entityManager.create();
+        Entity beside = entityManager.create();
+        pBoundingBox->setBoundingBox(near, glm::vec2(2.f), glm::vec2(0.f));
+        pBoundingBox->setBoundingBox(far, glm::vec2(2.f), glm::vec2(0.f));
+        pBoundingBox->setBoundingBox(beside, glm::vec2(2.f), glm::vec2(0.f));
+        pTransform->setLocalTransform(near, glm::translate(glm::vec3(5.f, 0.f, 0.f)));
+        pTransform->setLocalTransform(far, glm::translate(glm::vec3(10.f, 0.f, 0.f)));
+        pTransform->setLocalTransform(beside, glm::translate(glm::vec3(5.f, 5.f, 0.f)));
+
+        std::vector<RaycastHit> hits;
+        pIndex->raycast(glm::vec2(0.f), glm::vec2(2.f, 0.f), 100.f, hits);
+        ASSERT_EQ(2u, hits.size());
+        EXPECT_EQ(near, hits[0].entity);
+        EXPECT_FLOAT_EQ(4.f, hits[0].distance);
+        EXPECT_EQ(far, hits[1].entity);
+        EXPECT_FLOAT_EQ(9.f, hits[1].distance);
+
+        pIndex->raycast(glm::vec2(0.f), glm::vec2(1.f, 0.f), 6.f, hits);
+        ASSERT_EQ(1u, hits.size());
+
+        entityManager.destroy(near);
+        pIndex->raycast(glm::vec2(0.f), glm::vec2(1.f, 0.f), 100.f, hits);
+        ASSERT_EQ(1u, hits.size());
+        EXPECT_EQ(far, hits[0].entity);
+        EXPECT_EQ(2u, pIndex->getCount());
+    }
+
+    TEST_F(SpatialIndexTest, ChildrenMoveWithParent) {
+        Entity parent = entityManager.create();
+        Entity child = entityManager.create();
+        pBoundingBox->setBoundingBox(parent, glm::vec2(1.f), glm::vec2(0.f));
+        pBoundingBox->setBoundingBox(child, glm::vec2(1.f), glm::vec2(0.f));
+        pTransform->setLocalTransform(child, glm::translate(glm::vec3(10.f, 0.f, 0.f)));
+        pTransform->setParent(child, parent);
+
+        pTransform->setLocalTransform(parent, glm::translate(glm::vec3(0.f, 50.f, 0.f)));
+        std::vector<Entity> found;
+        pIndex->queryRegion({ 9.f, 49.f, 3.f, 3.f }, found);
+        ASSERT_EQ(1u, found.size());
+        EXPECT_EQ(child, found[0]);
+        pIndex->queryRegion({ 9.f, -1.f, 3.f, 3.f }, found);
+        EXPECT_TRUE(found.empty());
+    }
+
+    TEST_F(SpatialIndexTest, NestedTreeQuery) {
+        createEntities(200);
+        // Brings the tree up to date.
+        std::vector<Entity> found;
+        pIndex->queryRegion({ -10.f, -10.f, 120.f, 120.f }, found);
+        ASSERT_EQ(200u, found.size());
+
+        const AABBTree& tree = pIndex->getTree();
+        AABB all{ glm::vec2(-10.f), glm::vec2(110.f) };
+        unsigned outer = 0, inner = 0;
+        tree.query(all, [&](int) {
+            ++outer;
+            tree.query(all, [&](int) { ++inner; return true; });
+            return true;
+        });
+        EXPECT_EQ(200u, outer);
+        EXPECT_EQ(200u * 200u, inner);
+    }
+}
@@ -0,0 +1,12 @@
+#include "asset_loading.h"
+
+#include <SFML/Graphics/Texture.hpp>
+
+namespace te
+{
+	bool loadFromAsset(sf::Texture& texture, const std::string& filename)
+	{
+		AssetSpan image = readAsset(filename);
+		return texture.loadFromMemory(image.data(), image.size());
+	}
+}
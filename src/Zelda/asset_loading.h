@@ -0,0 +1,25 @@
+#ifndef TE_ASSET_LOADING_H
+#define TE_ASSET_LOADING_H
+
+#include "../TantechEngine/asset_pack.h"
+
+#include <string>
+
+namespace sf
+{
+	class Texture;
+}
+
+namespace te
+{
+	// ResourceManager loads through these. Resources that parse their own
+	// files already read them with readAsset, SFML ones are handed the bytes.
+	template <typename Resource>
+	bool loadFromAsset(Resource& resource, const std::string& filename)
+	{
+		return resource.loadFromFile(filename);
+	}
+	bool loadFromAsset(sf::Texture& texture, const std::string& filename);
+}
+
+#endif
@@ -19,15 +19,19 @@ namespace te
 			b2Vec2{rect.left, rect.top + rect.height}
 		};
 		mShape.Set(points, 4);
-
-		mWalls.push_back(Wall2f({ rect.left, rect.top }, { rect.left, rect.top + rect.height }));
-		mWalls.push_back(Wall2f({ rect.left, rect.top + rect.height }, { rect.left + rect.width, rect.top + rect.height }));
-		mWalls.push_back(Wall2f({ rect.left + rect.width, rect.top + rect.height }, { rect.left + rect.width, rect.top }));
-		mWalls.push_back(Wall2f({ rect.left + rect.width, rect.top }, { rect.left, rect.top }));
 	}
 
 	const std::vector<Wall2f>& BoxCollider::getWalls() const
 	{
+		if (mWalls.empty())
+		{
+			const sf::FloatRect& rect = mRect;
+			mWalls.reserve(4);
+			mWalls.push_back(Wall2f({ rect.left, rect.top }, { rect.left, rect.top + rect.height }));
+			mWalls.push_back(Wall2f({ rect.left, rect.top + rect.height }, { rect.left + rect.width, rect.top + rect.height }));
+			mWalls.push_back(Wall2f({ rect.left + rect.width, rect.top + rect.height }, { rect.left + rect.width, rect.top }));
+			mWalls.push_back(Wall2f({ rect.left + rect.width, rect.top }, { rect.left, rect.top }));
+		}
 		return mWalls;
 	}
 
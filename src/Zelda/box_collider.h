@@ -30,7 +30,8 @@ namespace te
 
 		sf::FloatRect mRect;
 		b2PolygonShape mShape;
-		std::vector<Wall2f> mWalls;
+		// Only steering asks for walls, so they are made on first use.
+		mutable std::vector<Wall2f> mWalls;
 	};
 }
 
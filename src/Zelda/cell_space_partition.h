@@ -1,117 +1,174 @@
 #ifndef TE_CELL_SPACE_PARTITION_H
 #define TE_CELL_SPACE_PARTITION_H
 
+#include "vector_ops.h"
+
 #include <SFML/Graphics.hpp>
 
-#include <list>
-#include <vector>
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
 
 namespace te
 {
-	template <class Entity>
-	struct Cell
-	{
-		std::list<Entity> members;
-		sf::FloatRect boundingBox;
-
-		Cell(sf::FloatRect bb) : boundingBox(bb) {}
-	};
-
+	// A uniform grid over a width by height space for finding the entities
+	// near a point. Entities are kept in one array sorted by cell, with
+	// where each cell starts in it, and are sorted again by counting only
+	// when something was added or changed cell since the last query, so
+	// both static and moving entities are cheap to keep.
+	//
+	// Entity is a pointer-like type with getPosition(). Positions outside
+	// the space count as being in the nearest cell.
 	template <class Entity>
 	class CellSpacePartition
 	{
 	public:
-		CellSpacePartition(float width, float height, int cellsX, int cellsY, int maxEntities)
-			: mCells()
-			, mNeighbors(maxEntities, Entity())
-			, mCurrNeighbor(mNeighbors.begin())
-			, mSpaceWidth(width)
+		CellSpacePartition(float width, float height, int cellsX, int cellsY, int maxEntities = 0)
+			: mSpaceWidth(width)
 			, mSpaceHeight(height)
-			, mNumCellsX(cellsX)
-			, mNumCellsY(cellsY)
-			, mCellSizeX(width / cellsX)
-			, mCellSizeY(height / cellsY)
+			, mNumCellsX(std::max(cellsX, 1))
+			, mNumCellsY(std::max(cellsY, 1))
+			, mCellSizeX(width / mNumCellsX)
+			, mCellSizeY(height / mNumCellsY)
+			, mEntities()
+			, mCellOfEntity()
+			, mIndexOfEntity()
+			, mCellStarts(mNumCellsX * mNumCellsY + 1, 0)
+			, mSorted()
+			, mScratch()
+			, mSortedDirty(false)
+			, mNeighbors()
 		{
-			for (int y = 0; y < mNumCellsY; ++y)
-			{
-				for (int x = 0; x < mNumCellsX; ++x)
-				{
-					mCells.push_back(Cell<Entity>(sf::FloatRect(x * mCellSizeX, y * mCellSizeY, mCellSizeX, mCellSizeY)));
-				}
-			}
+			mEntities.reserve(maxEntities);
+			mCellOfEntity.reserve(maxEntities);
+			mSorted.reserve(maxEntities);
+			mNeighbors.reserve(maxEntities);
 		}
 
-		inline void addEntity(const Entity& entity)
+		void addEntity(const Entity& entity)
 		{
-			int index = positionToIndex(entity->getPosition());
-			assert(index < (int)mCells.size());
-			mCells[index].members.push_back(entity);
+			assert(mIndexOfEntity.find(entity) == mIndexOfEntity.end());
+			mIndexOfEntity[entity] = static_cast<int>(mEntities.size());
+			mEntities.push_back(entity);
+			mCellOfEntity.push_back(positionToIndex(entity->getPosition()));
+			mSortedDirty = true;
 		}
 
-		inline void updateEntity(const Entity& entity, sf::Vector2f oldPosition)
-		{}
-
-		inline Entity& begin()
+		// Call after the entity has moved. Only a change of cell costs
+		// anything, and then only a sort by the next query.
+		void updateEntity(const Entity& entity)
 		{
-			mCurrNeighbor = mNeighbors.begin();
-			return *mCurrNeighbor;
-		}
+			auto found = mIndexOfEntity.find(entity);
+			assert(found != mIndexOfEntity.end());
 
-		inline Entity& next()
-		{
-			++mCurrNeighbor;
-			return *mCurrNeighbor;
+			int cell = positionToIndex(entity->getPosition());
+			if (cell != mCellOfEntity[found->second])
+			{
+				mCellOfEntity[found->second] = cell;
+				mSortedDirty = true;
+			}
 		}
 
-		inline bool end()
+		void removeEntity(const Entity& entity)
 		{
-			return (mCurrNeighbor == mNeighbors.end() || *mCurrNeighbor == 0);
+			auto found = mIndexOfEntity.find(entity);
+			assert(found != mIndexOfEntity.end());
+
+			int index = found->second;
+			mIndexOfEntity.erase(found);
+			if (index != static_cast<int>(mEntities.size()) - 1)
+			{
+				mEntities[index] = mEntities.back();
+				mCellOfEntity[index] = mCellOfEntity.back();
+				mIndexOfEntity[mEntities[index]] = index;
+			}
+			mEntities.pop_back();
+			mCellOfEntity.pop_back();
+			mSortedDirty = true;
 		}
 
 		void emptyCells()
 		{
-			for (auto& cell : mCells)
-				cell.members.clear();
+			mEntities.clear();
+			mCellOfEntity.clear();
+			mIndexOfEntity.clear();
+			mSortedDirty = true;
 		}
 
-		void calculateNeighbors(sf::Vector2f targetPos, float queryRadius)
+		// The entities closer to targetPos than queryRadius, looking only
+		// in the cells the query's box overlaps. The result stays valid
+		// until the next query.
+		const std::vector<Entity>& calculateNeighbors(sf::Vector2f targetPos, float queryRadius)
 		{
-			typename std::vector<Entity>::iterator currNeighbor = mNeighbors.begin();
-			sf::FloatRect queryBox{ targetPos.x - queryRadius, targetPos.y - queryRadius, 2 * queryRadius, 2 * queryRadius };
+			sortByCell();
+
+			mNeighbors.clear();
+			const int minX = clampCellX(targetPos.x - queryRadius), maxX = clampCellX(targetPos.x + queryRadius);
+			const int minY = clampCellY(targetPos.y - queryRadius), maxY = clampCellY(targetPos.y + queryRadius);
+			const float radiusSq = queryRadius * queryRadius;
 
-			for (auto& cell : mCells)
+			for (int y = minY; y <= maxY; ++y)
 			{
-				if (cell.boundingBox.intersects(queryBox) && !cell.members.empty())
+				const int row = y * mNumCellsX;
+				for (int i = mCellStarts[row + minX]; i < mCellStarts[row + maxX + 1]; ++i)
 				{
-					for (auto& member : cell.members)
-					{
-						if (distanceSq(member->getPosition(), targetPos) < queryRadius * queryRadius)
-						{
-							*currNeighbor++ = member;
-						}
-					}
+					if (distanceSq(mSorted[i]->getPosition(), targetPos) < radiusSq)
+						mNeighbors.push_back(mSorted[i]);
 				}
 			}
 
-			*currNeighbor = 0;
+			return mNeighbors;
+		}
+
+		const std::vector<Entity>& getNeighbors() const
+		{
+			return mNeighbors;
+		}
+
+		int numEntities() const
+		{
+			return static_cast<int>(mEntities.size());
 		}
 
 	private:
-		inline int positionToIndex(const sf::Vector2f& position) const
+		int clampCellX(float x) const
 		{
-			int index = (int)(mNumCellsX * position.x / mSpaceWidth) +
-				((int)(mNumCellsY * position.y / mSpaceHeight) * mNumCellsX);
-			if (index > (int)mCells.size() - 1)
-			{
-				index = (int)mCells.size() - 1;
-			}
-			return index;
+			return std::min(std::max(static_cast<int>(std::floor(x / mCellSizeX)), 0), mNumCellsX - 1);
 		}
 
-		std::vector<Cell<Entity>> mCells;
-		std::vector<Entity> mNeighbors;
-		typename std::vector<Entity>::iterator mCurrNeighbor;
+		int clampCellY(float y) const
+		{
+			return std::min(std::max(static_cast<int>(std::floor(y / mCellSizeY)), 0), mNumCellsY - 1);
+		}
+
+		int positionToIndex(const sf::Vector2f& position) const
+		{
+			return clampCellY(position.y) * mNumCellsX + clampCellX(position.x);
+		}
+
+		// Counting sort of the entities by cell into mSorted, with
+		// mCellStarts[c] to mCellStarts[c + 1] the entities of cell c. The
+		// cells of a row are next to each other, so a query reads one run
+		// per row.
+		void sortByCell()
+		{
+			if (!mSortedDirty) return;
+			mSortedDirty = false;
+
+			std::fill(mCellStarts.begin(), mCellStarts.end(), 0);
+			for (int cell : mCellOfEntity)
+				++mCellStarts[cell + 1];
+			for (std::size_t cell = 1; cell < mCellStarts.size(); ++cell)
+				mCellStarts[cell] += mCellStarts[cell - 1];
+
+			mSorted.resize(mEntities.size());
+			std::vector<int>& next = mScratch;
+			next.assign(mCellStarts.begin(), mCellStarts.end() - 1);
+			for (std::size_t i = 0; i < mEntities.size(); ++i)
+				mSorted[next[mCellOfEntity[i]]++] = mEntities[i];
+		}
 
 		float mSpaceWidth;
 		float mSpaceHeight;
@@ -121,6 +178,17 @@ namespace te
 
 		float mCellSizeX;
 		float mCellSizeY;
+
+		std::vector<Entity> mEntities;
+		std::vector<int> mCellOfEntity;
+		std::unordered_map<Entity, int> mIndexOfEntity;
+
+		std::vector<int> mCellStarts;
+		std::vector<Entity> mSorted;
+		std::vector<int> mScratch;
+		bool mSortedDirty;
+
+		std::vector<Entity> mNeighbors;
 	};
 }
 
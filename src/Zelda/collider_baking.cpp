@@ -0,0 +1,81 @@
+#include "collider_baking.h"
+
+#include <Box2D/Box2D.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace te
+{
+	// One pass along an axis. major selects the rect's position and size
+	// along the run, minor those across it.
+	template <typename Major, typename Minor>
+	static void mergeRuns(std::vector<sf::FloatRect>& rects, float tolerance, Major major, Minor minor)
+	{
+		std::sort(rects.begin(), rects.end(), [&](const sf::FloatRect& a, const sf::FloatRect& b)
+		{
+			auto minorA = minor(a), minorB = minor(b);
+			if (minorA != minorB) return minorA < minorB;
+			return major(a).first < major(b).first;
+		});
+
+		std::vector<sf::FloatRect> merged;
+		merged.reserve(rects.size());
+		for (const auto& rect : rects)
+		{
+			if (!merged.empty())
+			{
+				sf::FloatRect& last = merged.back();
+				auto lastMinor = minor(last), currMinor = minor(rect);
+				auto lastMajor = major(last), currMajor = major(rect);
+				bool sameRow = std::abs(lastMinor.first - currMinor.first) <= tolerance &&
+					std::abs(lastMinor.second - currMinor.second) <= tolerance;
+				if (sameRow && currMajor.first <= lastMajor.first + lastMajor.second + tolerance)
+				{
+					float end = std::max(lastMajor.first + lastMajor.second, currMajor.first + currMajor.second);
+					major(last, end - lastMajor.first);
+					continue;
+				}
+			}
+			merged.push_back(rect);
+		}
+		rects.swap(merged);
+	}
+
+	void mergeRects(std::vector<sf::FloatRect>& rects, float tolerance)
+	{
+		typedef std::pair<float, float> Span;
+
+		struct Horizontal
+		{
+			Span operator()(const sf::FloatRect& r) const { return{ r.left, r.width }; }
+			void operator()(sf::FloatRect& r, float width) const { r.width = width; }
+		};
+		struct Vertical
+		{
+			Span operator()(const sf::FloatRect& r) const { return{ r.top, r.height }; }
+			void operator()(sf::FloatRect& r, float height) const { r.height = height; }
+		};
+
+		// Rows first, then stack rows of equal extent.
+		mergeRuns(rects, tolerance, Horizontal{}, Vertical{});
+		mergeRuns(rects, tolerance, Vertical{}, Horizontal{});
+	}
+
+	void createRectFixtures(b2Body& body, const std::vector<sf::FloatRect>& rects)
+	{
+		for (const auto& rect : rects)
+		{
+			b2PolygonShape shape;
+			std::array<b2Vec2, 4> points = {
+				b2Vec2{ rect.left, rect.top },
+				b2Vec2{ rect.left + rect.width, rect.top },
+				b2Vec2{ rect.left + rect.width, rect.top + rect.height },
+				b2Vec2{ rect.left, rect.top + rect.height }
+			};
+			shape.Set(points.data(), 4);
+			body.CreateFixture(&shape, 0);
+		}
+	}
+}
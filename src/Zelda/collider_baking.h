@@ -0,0 +1,23 @@
+#ifndef TE_COLLIDER_BAKING_H
+#define TE_COLLIDER_BAKING_H
+
+#include <SFML/Graphics/Rect.hpp>
+
+#include <vector>
+
+class b2Body;
+
+namespace te
+{
+	// Replaces rects with fewer, larger rects covering exactly the same
+	// area. Rects of equal height that touch along a row merge first, then
+	// rects of equal width that touch down a column, so a solid block of
+	// tiles becomes one rect per run of equal rows. Edges closer than
+	// tolerance count as touching.
+	void mergeRects(std::vector<sf::FloatRect>& rects, float tolerance = 0.01f);
+
+	// A box fixture per rect, in body space.
+	void createRectFixtures(b2Body& body, const std::vector<sf::FloatRect>& rects);
+}
+
+#endif
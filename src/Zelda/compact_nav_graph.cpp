@@ -0,0 +1,63 @@
+#include "compact_nav_graph.h"
+
+#include <cassert>
+#include <utility>
+
+namespace te
+{
+	CompactNavGraph::CompactNavGraph()
+		: mX()
+		, mY()
+		, mFlags()
+		, mOffsets(1, 0)
+		, mTargets()
+		, mCosts()
+	{}
+
+	CompactNavGraph::CompactNavGraph(std::vector<float>&& x, std::vector<float>&& y, std::vector<int>&& offsets, std::vector<int>&& targets, std::vector<float>&& costs)
+		: mX(std::move(x))
+		, mY(std::move(y))
+		, mFlags(mX.size(), ACTIVE)
+		, mOffsets(std::move(offsets))
+		, mTargets(std::move(targets))
+		, mCosts(std::move(costs))
+	{
+		assert(mY.size() == mX.size() && mOffsets.size() == mX.size() + 1);
+		assert(mCosts.size() == mTargets.size() && mOffsets.back() == static_cast<int>(mTargets.size()));
+	}
+
+	int CompactNavGraph::numNodes() const
+	{
+		return static_cast<int>(mFlags.size());
+	}
+
+	int CompactNavGraph::numEdges() const
+	{
+		return static_cast<int>(mTargets.size());
+	}
+
+	bool CompactNavGraph::isActive(int node) const
+	{
+		return node >= 0 && node < numNodes() && (mFlags[node] & ACTIVE);
+	}
+
+	void CompactNavGraph::setActive(int node, bool active)
+	{
+		mFlags.at(node) = static_cast<uint8_t>(active ? mFlags[node] | ACTIVE : mFlags[node] & ~ACTIVE);
+	}
+
+	const std::vector<int>& CompactNavGraph::getOffsets() const
+	{
+		return mOffsets;
+	}
+
+	const std::vector<int>& CompactNavGraph::getTargets() const
+	{
+		return mTargets;
+	}
+
+	const std::vector<float>& CompactNavGraph::getCosts() const
+	{
+		return mCosts;
+	}
+}
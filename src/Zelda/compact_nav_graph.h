@@ -0,0 +1,99 @@
+#ifndef TE_COMPACT_NAV_GRAPH_H
+#define TE_COMPACT_NAV_GRAPH_H
+
+#include <SFML/System/Vector2.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace te
+{
+	// Read-only copy of a nav graph laid out for searching. Node positions
+	// and flags are kept in separate arrays, and the edges of node i are
+	// targets[offsets[i]] to targets[offsets[i + 1]] with their costs
+	// alongside. Node indices are the same as in the source graph; removed
+	// nodes stay in place, inactive and without edges. Nodes can be turned
+	// off and on again later, for doors and the like, and searches skip
+	// edges leading to inactive nodes.
+	class CompactNavGraph
+	{
+	public:
+		enum Flags : uint8_t
+		{
+			ACTIVE = 0x01
+		};
+
+		CompactNavGraph();
+
+		// Copies any graph with the SparseGraph interface.
+		template <class Graph>
+		explicit CompactNavGraph(const Graph& graph);
+		// Takes arrays already laid out as above, every node active.
+		CompactNavGraph(std::vector<float>&& x, std::vector<float>&& y, std::vector<int>&& offsets, std::vector<int>&& targets, std::vector<float>&& costs);
+
+		int numNodes() const;
+		int numEdges() const;
+
+		bool isActive(int node) const;
+		void setActive(int node, bool active);
+
+		// Searches call these for every node and edge they visit, so they
+		// are inline and do no bounds checks.
+		sf::Vector2f getPosition(int node) const { return{ mX[node], mY[node] }; }
+		float getX(int node) const { return mX[node]; }
+		float getY(int node) const { return mY[node]; }
+		uint8_t getFlags(int node) const { return mFlags[node]; }
+		const int* targetsBegin(int node) const { return mTargets.data() + mOffsets[node]; }
+		const int* targetsEnd(int node) const { return mTargets.data() + mOffsets[node + 1]; }
+		const float* costsBegin(int node) const { return mCosts.data() + mOffsets[node]; }
+
+		const std::vector<int>& getOffsets() const;
+		const std::vector<int>& getTargets() const;
+		const std::vector<float>& getCosts() const;
+
+	private:
+		std::vector<float> mX;
+		std::vector<float> mY;
+		std::vector<uint8_t> mFlags;
+		std::vector<int> mOffsets;
+		std::vector<int> mTargets;
+		std::vector<float> mCosts;
+	};
+
+	template <class Graph>
+	CompactNavGraph::CompactNavGraph(const Graph& graph)
+		: CompactNavGraph()
+	{
+		int count = graph.numNodes();
+		mX.assign(count, 0.f);
+		mY.assign(count, 0.f);
+		mFlags.assign(count, 0);
+		mOffsets.assign(count + 1, 0);
+
+		for (int node = 0; node < count; ++node)
+		{
+			if (!graph.isPresent(node)) continue;
+			sf::Vector2f position = graph.getNode(node).getPosition();
+			mX[node] = position.x;
+			mY[node] = position.y;
+			mFlags[node] = ACTIVE;
+		}
+
+		for (int node = 0; node < count; ++node)
+		{
+			mOffsets[node] = static_cast<int>(mTargets.size());
+			if (!mFlags[node]) continue;
+
+			// The iterator already skips edges to removed nodes.
+			typename Graph::ConstEdgeIterator edgeIter(graph, node);
+			for (auto* pEdge = edgeIter.begin(); !edgeIter.end(); pEdge = edgeIter.next())
+			{
+				mTargets.push_back(pEdge->getTo());
+				mCosts.push_back(static_cast<float>(pEdge->getCost()));
+			}
+		}
+		mOffsets[count] = static_cast<int>(mTargets.size());
+	}
+}
+
+#endif
@@ -5,6 +5,7 @@
 
 #include <boost/container/flat_map.hpp>
 
+#include <algorithm>
 #include <vector>
 
 namespace te
@@ -67,6 +68,14 @@ namespace te
 			m_Components.push_back({ index, std::forward<T>(component) });
 		}
 
+		template <typename Pred>
+		void eraseIf(EntityID index, Pred pred)
+		{
+			m_Components.erase(std::remove_if(m_Components.begin(), m_Components.end(), [index, &pred](const auto& componentPair) {
+				return componentPair.first == index && pred(componentPair.second);
+			}), m_Components.end());
+		}
+
 	private:
 		std::vector<std::pair<EntityID, Component>> m_Components;
 	};
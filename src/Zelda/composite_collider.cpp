@@ -1,45 +1,160 @@
 #include "composite_collider.h"
 
 #include <algorithm>
+#include <cmath>
 
 namespace te
 {
+	// Keeps a few huge boxes from making a grid with millions of cells.
+	static const int MAX_GRID_CELLS = 256;
+	// Box2D counts boxes a hair apart as touching, so the grid looks that
+	// much further out.
+	static const float GRID_SKIN = 0.01f;
+
+	CompositeCollider::CompositeCollider()
+		: mBoxColliders()
+		, mWalls()
+		, mWallsValid(true)
+		, mGrid()
+		, mGridValid(false)
+	{
+	}
+
 	void CompositeCollider::addCollider(const BoxCollider& collider)
 	{
 		mBoxColliders.push_back(collider);
-		std::vector<Wall2f> walls = collider.getWalls();
-		mWalls.insert(mWalls.end(), walls.begin(), walls.end());
+		mWallsValid = false;
+		mGridValid = false;
 	}
 
 	const std::vector<Wall2f>& CompositeCollider::getWalls() const
 	{
+		if (!mWallsValid)
+		{
+			mWalls.clear();
+			mWalls.reserve(mBoxColliders.size() * 4);
+			for (auto& boxCollider : mBoxColliders)
+			{
+				const std::vector<Wall2f>& walls = boxCollider.getWalls();
+				mWalls.insert(mWalls.end(), walls.begin(), walls.end());
+			}
+			mWallsValid = true;
+		}
 		return mWalls;
 	}
 
-	//std::vector<Wall2f> CompositeCollider::getWalls() const
-	//{
-	//	std::vector<Wall2f> walls;
-	//	std::for_each(mBoxColliders.begin(), mBoxColliders.end(), [&walls](const BoxCollider& collider) {
-	//		std::vector<Wall2f> currWalls = collider.getWalls();
-	//		walls.insert(walls.end(), currWalls.begin(), currWalls.end());
-	//	});
-	//	return walls;
-	//}
+	const CompositeCollider::Grid& CompositeCollider::getGrid() const
+	{
+		if (mGridValid)
+			return mGrid;
+
+		Grid& grid = mGrid;
+		grid.cellStarts.clear();
+		grid.boxes.clear();
+		mGridValid = true;
+		if (mBoxColliders.empty())
+		{
+			grid.bounds = { 0, 0, 0, 0 };
+			grid.cellSize = { 1, 1 };
+			grid.columns = 0;
+			grid.rows = 0;
+			return grid;
+		}
+
+		sf::FloatRect first = mBoxColliders.front().getRect();
+		float left = first.left, top = first.top;
+		float right = first.left + first.width, bottom = first.top + first.height;
+		sf::Vector2f totalSize;
+		for (auto& boxCollider : mBoxColliders)
+		{
+			sf::FloatRect rect = boxCollider.getRect();
+			left = std::min(left, rect.left);
+			top = std::min(top, rect.top);
+			right = std::max(right, rect.left + rect.width);
+			bottom = std::max(bottom, rect.top + rect.height);
+			totalSize += { rect.width, rect.height };
+		}
+		grid.bounds = { left, top, right - left, bottom - top };
+
+		// Cells about twice the average box put each box in a handful of
+		// cells and a handful of boxes in each cell.
+		float count = static_cast<float>(mBoxColliders.size());
+		grid.cellSize = { std::max(2 * totalSize.x / count, grid.bounds.width / MAX_GRID_CELLS),
+			std::max(2 * totalSize.y / count, grid.bounds.height / MAX_GRID_CELLS) };
+		grid.cellSize.x = std::max(grid.cellSize.x, GRID_SKIN);
+		grid.cellSize.y = std::max(grid.cellSize.y, GRID_SKIN);
+		grid.columns = std::min(MAX_GRID_CELLS, static_cast<int>(grid.bounds.width / grid.cellSize.x) + 1);
+		grid.rows = std::min(MAX_GRID_CELLS, static_cast<int>(grid.bounds.height / grid.cellSize.y) + 1);
+
+		auto forEachCell = [&grid](const sf::FloatRect& rect, auto fn) {
+			int x0 = std::max(0, static_cast<int>((rect.left - grid.bounds.left) / grid.cellSize.x));
+			int y0 = std::max(0, static_cast<int>((rect.top - grid.bounds.top) / grid.cellSize.y));
+			int x1 = std::min(grid.columns - 1, static_cast<int>((rect.left + rect.width - grid.bounds.left) / grid.cellSize.x));
+			int y1 = std::min(grid.rows - 1, static_cast<int>((rect.top + rect.height - grid.bounds.top) / grid.cellSize.y));
+			for (int y = y0; y <= y1; ++y)
+				for (int x = x0; x <= x1; ++x)
+					fn(y * grid.columns + x);
+		};
+
+		// Counting sort of the boxes into their cells.
+		grid.cellStarts.assign(grid.columns * grid.rows + 1, 0);
+		for (auto& boxCollider : mBoxColliders)
+			forEachCell(boxCollider.getRect(), [&grid](int cell) { ++grid.cellStarts[cell + 1]; });
+		for (size_t i = 1; i < grid.cellStarts.size(); ++i)
+			grid.cellStarts[i] += grid.cellStarts[i - 1];
+
+		grid.boxes.resize(grid.cellStarts.back());
+		std::vector<int> next(grid.cellStarts.begin(), grid.cellStarts.end() - 1);
+		for (int i = 0; i < static_cast<int>(mBoxColliders.size()); ++i)
+			forEachCell(mBoxColliders[i].getRect(), [&grid, &next, i](int cell) { grid.boxes[next[cell]++] = i; });
 
-	bool CompositeCollider::contains(float x, float y) const
+		return grid;
+	}
+
+	// Calls fn with every box in the cells rect covers until it returns
+	// true. A box spanning several cells can come up more than once.
+	template <typename Fn>
+	bool CompositeCollider::anyNearby(const sf::FloatRect& rect, Fn fn) const
 	{
-		for (auto it = mBoxColliders.begin(); it != mBoxColliders.end(); ++it)
+		const Grid& grid = getGrid();
+		if (grid.columns == 0)
+			return false;
+
+		float left = rect.left - GRID_SKIN - grid.bounds.left;
+		float top = rect.top - GRID_SKIN - grid.bounds.top;
+		float right = left + rect.width + 2 * GRID_SKIN;
+		float bottom = top + rect.height + 2 * GRID_SKIN;
+		if (right < 0 || bottom < 0 || left > grid.bounds.width || top > grid.bounds.height)
+			return false;
+
+		int x0 = std::max(0, static_cast<int>(std::floor(left / grid.cellSize.x)));
+		int y0 = std::max(0, static_cast<int>(std::floor(top / grid.cellSize.y)));
+		int x1 = std::min(grid.columns - 1, static_cast<int>(right / grid.cellSize.x));
+		int y1 = std::min(grid.rows - 1, static_cast<int>(bottom / grid.cellSize.y));
+		for (int y = y0; y <= y1; ++y)
 		{
-			if (it->contains(x, y)) return true;
+			for (int x = x0; x <= x1; ++x)
+			{
+				int cell = y * grid.columns + x;
+				for (int i = grid.cellStarts[cell]; i < grid.cellStarts[cell + 1]; ++i)
+					if (fn(mBoxColliders[grid.boxes[i]])) return true;
+			}
 		}
 		return false;
 	}
 
+	bool CompositeCollider::contains(float x, float y) const
+	{
+		return anyNearby({ x, y, 0, 0 }, [x, y](const BoxCollider& boxCollider) {
+			return boxCollider.contains(x, y);
+		});
+	}
+
 	bool CompositeCollider::intersects(const BoxCollider& o) const
 	{
-		for (auto& boxCollider : mBoxColliders)
-			if (boxCollider.intersects(o)) return true;
-		return false;
+		return anyNearby(o.getRect(), [&o](const BoxCollider& boxCollider) {
+			return boxCollider.intersects(o);
+		});
 	}
 
 	bool CompositeCollider::intersects(const BoxCollider& o, sf::FloatRect& collision) const
@@ -48,8 +163,7 @@ namespace te
 
 		sf::FloatRect currBest = { 0, 0, 0, 0 };
 		sf::FloatRect currCollision;
-		for (auto& boxCollider : mBoxColliders)
-		{
+		anyNearby(o.getRect(), [&](const BoxCollider& boxCollider) {
 			if (boxCollider.intersects(o, currCollision))
 			{
 				if (currCollision.width * currCollision.height > currBest.width * currBest.height)
@@ -58,14 +172,20 @@ namespace te
 				}
 				result = true;
 			}
-		}
+			return false;
+		});
 
 		collision = currBest;
 		return result;
 	}
 
+	// Both overloads walk the smaller collider and look its boxes up in the
+	// grid of the larger one.
 	bool CompositeCollider::intersects(const CompositeCollider& o) const
 	{
+		if (mBoxColliders.size() > o.mBoxColliders.size())
+			return o.intersects(*this);
+
 		for (auto& boxCollider : mBoxColliders)
 			if (o.intersects(boxCollider)) return true;
 		return false;
@@ -73,6 +193,9 @@ namespace te
 
 	bool CompositeCollider::intersects(const CompositeCollider& o, sf::FloatRect& collision) const
 	{
+		if (mBoxColliders.size() > o.mBoxColliders.size())
+			return o.intersects(*this, collision);
+
 		bool result = false;
 
 		sf::FloatRect currBest = { 0, 0, 0, 0 };
@@ -85,6 +208,7 @@ namespace te
 				{
 					currBest = currCollision;
 				}
+				result = true;
 			}
 		}
 
@@ -111,6 +235,11 @@ namespace te
 		}
 	}
 
+	size_t CompositeCollider::size() const
+	{
+		return mBoxColliders.size();
+	}
+
 	void CompositeCollider::draw(sf::RenderTarget& target, sf::RenderStates states) const
 	{
 		std::for_each(mBoxColliders.begin(), mBoxColliders.end(), [&target, &states](const BoxCollider& collider) {
@@ -14,8 +14,10 @@ namespace te
 	class CompositeCollider : public Collider
 	{
 	public:
+		CompositeCollider();
+
 		void addCollider(const BoxCollider& collider);
-		//virtual std::vector<Wall2f> getWalls() const;
+		// Gathered from the boxes on first use.
 		const std::vector<Wall2f>& getWalls() const;
 
 		bool contains(float x, float y) const;
@@ -27,10 +29,34 @@ namespace te
 		CompositeCollider transform(const sf::Transform&) const;
 		void createFixtures(b2Body& body, std::vector<b2Fixture*>& outFixtures) const;
 
+		size_t size() const;
+
 	private:
+		// Buckets box indices by the cells of a uniform grid over all the
+		// boxes, so a query only tests boxes in the cells it covers.
+		struct Grid
+		{
+			sf::FloatRect bounds;
+			sf::Vector2f cellSize;
+			int columns;
+			int rows;
+			// Boxes of cell i are boxes[cellStarts[i]] up to boxes[cellStarts[i + 1]].
+			std::vector<int> cellStarts;
+			std::vector<int> boxes;
+		};
+
+		const Grid& getGrid() const;
+		template <typename Fn>
+		bool anyNearby(const sf::FloatRect& rect, Fn fn) const;
+
 		virtual void draw(sf::RenderTarget&, sf::RenderStates) const;
 		std::vector<BoxCollider> mBoxColliders;
-		std::vector<Wall2f> mWalls;
+
+		// Rebuilt on first use after a box is added.
+		mutable std::vector<Wall2f> mWalls;
+		mutable bool mWallsValid;
+		mutable Grid mGrid;
+		mutable bool mGridValid;
 	};
 }
 
@@ -0,0 +1,105 @@
+#include "contact_events.h"
+
+#include <cassert>
+
+namespace te
+{
+	ContactEventBuffer::ContactEventBuffer(std::size_t capacity)
+		: m_Events(capacity)
+		, m_Start{ 0 }
+		, m_Size{ 0 }
+		, m_Dropped{ 0 }
+	{
+		assert(capacity > 0);
+	}
+
+	void ContactEventBuffer::push(const ContactEvent& evt)
+	{
+		std::size_t capacity = m_Events.size();
+		if (m_Size == capacity)
+		{
+			m_Events[m_Start] = evt;
+			m_Start = (m_Start + 1) % capacity;
+			++m_Dropped;
+			return;
+		}
+		m_Events[(m_Start + m_Size) % capacity] = evt;
+		++m_Size;
+	}
+
+	void ContactEventBuffer::append(const ContactEventBuffer& o)
+	{
+		for (std::size_t i = 0; i < o.m_Size; ++i)
+		{
+			push(o[i]);
+		}
+		m_Dropped += o.m_Dropped;
+	}
+
+	void ContactEventBuffer::clear()
+	{
+		m_Start = 0;
+		m_Size = 0;
+		m_Dropped = 0;
+	}
+
+	std::size_t ContactEventBuffer::size() const
+	{
+		return m_Size;
+	}
+
+	std::size_t ContactEventBuffer::capacity() const
+	{
+		return m_Events.size();
+	}
+
+	std::size_t ContactEventBuffer::dropped() const
+	{
+		return m_Dropped;
+	}
+
+	const ContactEvent& ContactEventBuffer::operator[](std::size_t index) const
+	{
+		assert(index < m_Size);
+		return m_Events[(m_Start + index) % m_Events.size()];
+	}
+
+	ContactListener::ContactListener(std::size_t capacity)
+		: m_Events{ capacity }
+	{}
+
+	void ContactListener::BeginContact(b2Contact* contact)
+	{
+		record(ContactEvent::BEGIN, *contact);
+	}
+
+	void ContactListener::EndContact(b2Contact* contact)
+	{
+		record(ContactEvent::END, *contact);
+	}
+
+	ContactEventBuffer& ContactListener::getEvents()
+	{
+		return m_Events;
+	}
+
+	void ContactListener::record(ContactEvent::Type type, b2Contact& contact)
+	{
+		const b2Fixture& fixtureA = *contact.GetFixtureA();
+		const b2Fixture& fixtureB = *contact.GetFixtureB();
+
+		b2WorldManifold manifold;
+		contact.GetWorldManifold(&manifold);
+		bool touching = contact.GetManifold()->pointCount > 0;
+
+		ContactEvent evt;
+		evt.type = type;
+		evt.a = toEntityID(fixtureA.GetBody()->GetUserData());
+		evt.b = toEntityID(fixtureB.GetBody()->GetUserData());
+		evt.categoryA = fixtureA.GetFilterData().categoryBits;
+		evt.categoryB = fixtureB.GetFilterData().categoryBits;
+		evt.normal = touching ? sf::Vector2f{ manifold.normal.x, manifold.normal.y } : sf::Vector2f{};
+		evt.point = touching ? sf::Vector2f{ manifold.points[0].x, manifold.points[0].y } : sf::Vector2f{};
+		m_Events.push(evt);
+	}
+}
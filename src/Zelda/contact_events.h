@@ -0,0 +1,101 @@
+#ifndef TE_CONTACT_EVENTS_H
+#define TE_CONTACT_EVENTS_H
+
+#include "typedefs.h"
+
+#include <SFML/System/Vector2.hpp>
+#include <Box2D/Box2D.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace te
+{
+	// Bodies keep their entity in their user data, offset by one so that
+	// bodies without an entity read back as NO_ENTITY.
+	const EntityID NO_ENTITY = -1;
+
+	inline void* toUserData(EntityID id)
+	{
+		return reinterpret_cast<void*>(static_cast<std::intptr_t>(id) + 1);
+	}
+
+	inline EntityID toEntityID(void* pUserData)
+	{
+		return static_cast<EntityID>(reinterpret_cast<std::intptr_t>(pUserData) - 1);
+	}
+
+	struct ContactEvent
+	{
+		enum Type { BEGIN, END };
+
+		Type type;
+		EntityID a;
+		EntityID b;
+		uint16 categoryA;
+		uint16 categoryB;
+		// From a to b, in world space. Ending contacts may have no point,
+		// in which case it is the origin.
+		sf::Vector2f normal;
+		sf::Vector2f point;
+	};
+
+	// Fixed size ring of contact events. Nothing is allocated after
+	// construction; when it is full the oldest events are dropped.
+	class ContactEventBuffer
+	{
+	public:
+		explicit ContactEventBuffer(std::size_t capacity);
+		ContactEventBuffer(ContactEventBuffer&&) = default;
+		ContactEventBuffer& operator=(ContactEventBuffer&&) = default;
+
+		void push(const ContactEvent& evt);
+		void append(const ContactEventBuffer& o);
+		void clear();
+
+		std::size_t size() const;
+		std::size_t capacity() const;
+		// Events lost to a full buffer since the last clear.
+		std::size_t dropped() const;
+		// Oldest first.
+		const ContactEvent& operator[](std::size_t index) const;
+
+		// Calls fn with every event, oldest first, where either fixture has
+		// a category in categoryBits.
+		template <typename Fn>
+		void forEach(uint16 categoryBits, Fn fn) const
+		{
+			for (std::size_t i = 0; i < m_Size; ++i)
+			{
+				const ContactEvent& evt = (*this)[i];
+				if ((evt.categoryA | evt.categoryB) & categoryBits)
+					fn(evt);
+			}
+		}
+	private:
+		std::vector<ContactEvent> m_Events;
+		std::size_t m_Start;
+		std::size_t m_Size;
+		std::size_t m_Dropped;
+	};
+
+	// Records the contacts of one world. Worlds may step on different
+	// threads, so each gets a listener with its own buffer, which is
+	// copied out after the step.
+	class ContactListener : public b2ContactListener
+	{
+	public:
+		explicit ContactListener(std::size_t capacity);
+
+		void BeginContact(b2Contact* contact) override;
+		void EndContact(b2Contact* contact) override;
+
+		ContactEventBuffer& getEvents();
+	private:
+		void record(ContactEvent::Type type, b2Contact& contact);
+
+		ContactEventBuffer m_Events;
+	};
+}
+
+#endif
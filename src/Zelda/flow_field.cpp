@@ -0,0 +1,357 @@
+#include "flow_field.h"
+#include "indexed_priority_queue.h"
+#include "../TantechEngine/job_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+
+namespace te
+{
+	static const float UNREACHABLE = std::numeric_limits<float>::max();
+
+	// The same moves JumpPointSearch makes, which cost the same both ways.
+	static bool canStep(const WalkableGrid& grid, JumpPointSearch::Moves moves, int x, int y, int dx, int dy)
+	{
+		if (!grid.isWalkable(x + dx, y + dy)) return false;
+		if (!dx || !dy) return true;
+		if (moves == JumpPointSearch::Moves::STRAIGHT) return false;
+		if (moves == JumpPointSearch::Moves::DIAGONAL_NO_CORNER_CUTTING) return grid.isWalkable(x + dx, y) && grid.isWalkable(x, y + dy);
+		return true;
+	}
+
+	static float stepCost(sf::Vector2f tileSize, int dx, int dy)
+	{
+		return dx && dy ? std::sqrt(tileSize.x * tileSize.x + tileSize.y * tileSize.y) : (dx ? tileSize.x : tileSize.y);
+	}
+
+	static int sign(float value)
+	{
+		return (value > 0.f) - (value < 0.f);
+	}
+
+	// Dijkstra from whatever is queued, lowering the cost of every tile it
+	// reaches more cheaply than before. Tiles whose cost drops are added to
+	// lowered when given.
+	static void propagate(const WalkableGrid& grid, JumpPointSearch::Moves moves, std::vector<float>& costs,
+		IndexedPriorityQueue<float>& pq, std::vector<int>* pLowered)
+	{
+		const int width = grid.getWidth();
+		const sf::Vector2f tileSize = grid.getTileSize();
+		while (!pq.empty())
+		{
+			int node = static_cast<int>(pq.pop());
+			int x = node % width, y = node / width;
+			for (int dy = -1; dy <= 1; ++dy)
+			{
+				for (int dx = -1; dx <= 1; ++dx)
+				{
+					if ((!dx && !dy) || !canStep(grid, moves, x, y, dx, dy)) continue;
+					int neighbour = (y + dy) * width + x + dx;
+					float cost = costs[node] + stepCost(tileSize, dx, dy);
+					if (cost >= costs[neighbour]) continue;
+
+					costs[neighbour] = cost;
+					if (pLowered) pLowered->push_back(neighbour);
+					if (pq.contains(neighbour)) pq.changePriority(neighbour);
+					else pq.insert(neighbour);
+				}
+			}
+		}
+	}
+
+	// Points the tile at the neighbour its cost comes through.
+	static void pointTile(const WalkableGrid& grid, JumpPointSearch::Moves moves, sf::Vector2i goal, int x, int y,
+		const std::vector<float>& costs, std::vector<sf::Vector2f>& directions)
+	{
+		const int width = grid.getWidth();
+		const int node = y * width + x;
+		directions[node] = sf::Vector2f(0.f, 0.f);
+		if ((x == goal.x && y == goal.y) || costs[node] == UNREACHABLE) return;
+
+		const sf::Vector2f tileSize = grid.getTileSize();
+		float best = UNREACHABLE;
+		int bestX = 0, bestY = 0;
+		for (int dy = -1; dy <= 1; ++dy)
+		{
+			for (int dx = -1; dx <= 1; ++dx)
+			{
+				if ((!dx && !dy) || !canStep(grid, moves, x, y, dx, dy)) continue;
+				float cost = costs[(y + dy) * width + x + dx] + stepCost(tileSize, dx, dy);
+				if (cost < best)
+				{
+					best = cost;
+					bestX = dx;
+					bestY = dy;
+				}
+			}
+		}
+
+		sf::Vector2f step(bestX * tileSize.x, bestY * tileSize.y);
+		float length = std::sqrt(step.x * step.x + step.y * step.y);
+		if (length > 0.f) directions[node] = step / length;
+	}
+
+	FlowField::FlowField(const WalkableGrid& grid, JumpPointSearch::Moves moves, JobPool* pPool)
+		: mGrid(grid)
+		, mMoves(moves)
+		, mGoal(0.f, 0.f)
+		, mGoalTolerance(0)
+		, mDirtyTiles()
+		, mFollowed(false)
+		, mpField(nullptr)
+		, mpSpare(std::make_unique<Field>())
+		, mpPool(pPool)
+		, mComputing()
+	{}
+
+	FlowField::~FlowField()
+	{
+		if (mComputing.valid()) mComputing.wait();
+	}
+
+	void FlowField::setGoal(sf::Vector2f position)
+	{
+		mGoal = position;
+	}
+
+	sf::Vector2f FlowField::getGoal() const
+	{
+		return mGoal;
+	}
+
+	void FlowField::setGoalTolerance(int tiles)
+	{
+		mGoalTolerance = std::max(tiles, 0);
+	}
+
+	void FlowField::markDirty(const std::vector<sf::Vector2i>& tiles)
+	{
+		mDirtyTiles.insert(mDirtyTiles.end(), tiles.begin(), tiles.end());
+	}
+
+	void FlowField::update()
+	{
+		if (mComputing.valid())
+		{
+			if (mComputing.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+			mComputing.get();
+			std::swap(mpField, mpSpare);
+			if (!mpSpare) mpSpare = std::make_unique<Field>();
+		}
+
+		bool followed = mFollowed;
+		mFollowed = false;
+		if (!followed) return;
+
+		Field* pField = mpSpare.get();
+		JumpPointSearch::Moves moves = mMoves;
+		std::function<void()> job;
+		if (needsRecompute())
+		{
+			sf::Vector2i goal = mGrid.getTile(mGoal);
+			if (!mGrid.isWalkable(goal.x, goal.y)) return;
+			job = [grid = mGrid, moves, goal, pField]() {
+				compute(grid, moves, goal, *pField);
+			};
+		}
+		else if (!mDirtyTiles.empty())
+		{
+			*pField = *mpField;
+			job = [grid = mGrid, moves, changed = mDirtyTiles, pField]() {
+				repair(grid, moves, changed, *pField);
+			};
+		}
+		else return;
+
+		mDirtyTiles.clear();
+		if (mpPool)
+		{
+			mComputing = mpPool->push(job);
+		}
+		else
+		{
+			std::promise<void> done;
+			job();
+			done.set_value();
+			mComputing = done.get_future();
+		}
+	}
+
+	sf::Vector2f FlowField::getDirection(sf::Vector2f position) const
+	{
+		int index = getIndex(position);
+		return index < 0 ? sf::Vector2f(0.f, 0.f) : mpField->directions[index];
+	}
+
+	float FlowField::getCost(sf::Vector2f position) const
+	{
+		int index = getIndex(position);
+		if (index < 0 || mpField->costs[index] == UNREACHABLE) return -1.f;
+		return mpField->costs[index];
+	}
+
+	bool FlowField::isUpToDate() const
+	{
+		return mpField && mpField->goal == mGrid.getTile(mGoal);
+	}
+
+	int FlowField::getIndex(sf::Vector2f position) const
+	{
+		mFollowed = true;
+		if (!mpField) return -1;
+		sf::Vector2i tile = mGrid.getTile(position);
+		if (tile.x < 0 || tile.y < 0 || tile.x >= mGrid.getWidth() || tile.y >= mGrid.getHeight()) return -1;
+		return tile.y * mGrid.getWidth() + tile.x;
+	}
+
+	bool FlowField::needsRecompute() const
+	{
+		if (!mpField) return true;
+		sf::Vector2i goal = mGrid.getTile(mGoal);
+		return std::abs(goal.x - mpField->goal.x) > mGoalTolerance || std::abs(goal.y - mpField->goal.y) > mGoalTolerance;
+	}
+
+	// Dijkstra outward from the goal, then every tile points at the
+	// neighbour its distance came through.
+	void FlowField::compute(const WalkableGrid& grid, JumpPointSearch::Moves moves, sf::Vector2i goal, Field& field)
+	{
+		const int width = grid.getWidth(), height = grid.getHeight();
+
+		field.goal = goal;
+		field.costs.assign(width * height, UNREACHABLE);
+		field.directions.assign(width * height, sf::Vector2f(0.f, 0.f));
+
+		IndexedPriorityQueue<float> pq(field.costs);
+		field.costs[goal.y * width + goal.x] = 0.f;
+		pq.insert(goal.y * width + goal.x);
+		propagate(grid, moves, field.costs, pq, nullptr);
+
+		for (int y = 0; y < height; ++y)
+		{
+			for (int x = 0; x < width; ++x)
+			{
+				pointTile(grid, moves, goal, x, y, field.costs, field.directions);
+			}
+		}
+	}
+
+	// Shutting tiles can only raise costs, and only of the tiles whose way
+	// to the goal led through or diagonally past them: those are found by
+	// following the directions backwards and searched again from the tiles
+	// around them. Opening tiles can only lower costs, which spreads out
+	// from the tiles around them for as far as it keeps lowering them.
+	void FlowField::repair(const WalkableGrid& grid, JumpPointSearch::Moves moves, const std::vector<sf::Vector2i>& changed, Field& field)
+	{
+		const int width = grid.getWidth(), height = grid.getHeight();
+		const sf::Vector2f tileSize = grid.getTileSize();
+		const sf::Vector2i goal = field.goal;
+		auto isOnGrid = [width, height](int x, int y) {
+			return x >= 0 && y >= 0 && x < width && y < height;
+		};
+		auto stepOf = [&field](int node) {
+			return sf::Vector2i(sign(field.directions[node].x), sign(field.directions[node].y));
+		};
+
+		// The tiles changed and every tile next to one.
+		std::vector<int> around;
+		for (const auto& tile : changed)
+		{
+			for (int y = tile.y - 1; y <= tile.y + 1; ++y)
+			{
+				for (int x = tile.x - 1; x <= tile.x + 1; ++x)
+				{
+					if (isOnGrid(x, y)) around.push_back(y * width + x);
+				}
+			}
+		}
+		std::sort(around.begin(), around.end());
+		around.erase(std::unique(around.begin(), around.end()), around.end());
+
+		std::vector<std::uint8_t> isLost(width * height, 0);
+		std::vector<int> lost;
+		for (int node : around)
+		{
+			if (field.costs[node] == UNREACHABLE) continue;
+			int x = node % width, y = node / width;
+			sf::Vector2i step = stepOf(node);
+			bool isGoal = x == goal.x && y == goal.y;
+			if (!grid.isWalkable(x, y) || (!isGoal && !canStep(grid, moves, x, y, step.x, step.y)))
+			{
+				isLost[node] = 1;
+				lost.push_back(node);
+			}
+		}
+		for (std::size_t i = 0; i < lost.size(); ++i)
+		{
+			int x = lost[i] % width, y = lost[i] / width;
+			for (int dy = -1; dy <= 1; ++dy)
+			{
+				for (int dx = -1; dx <= 1; ++dx)
+				{
+					int nx = x + dx, ny = y + dy;
+					if ((!dx && !dy) || !isOnGrid(nx, ny)) continue;
+					int neighbour = ny * width + nx;
+					if (isLost[neighbour] || field.costs[neighbour] == UNREACHABLE) continue;
+					if (stepOf(neighbour) != sf::Vector2i(-dx, -dy)) continue;
+					isLost[neighbour] = 1;
+					lost.push_back(neighbour);
+				}
+			}
+		}
+		for (int node : lost)
+		{
+			field.costs[node] = UNREACHABLE;
+		}
+
+		// Lost tiles, and tiles that may have a new way in, start from the
+		// cheapest neighbour they can step to.
+		IndexedPriorityQueue<float> pq(field.costs);
+		std::vector<int> lowered;
+		auto seed = [&](int node) {
+			int x = node % width, y = node / width;
+			if (!grid.isWalkable(x, y) || (x == goal.x && y == goal.y)) return;
+			float best = field.costs[node];
+			for (int dy = -1; dy <= 1; ++dy)
+			{
+				for (int dx = -1; dx <= 1; ++dx)
+				{
+					if ((!dx && !dy) || !canStep(grid, moves, x, y, dx, dy)) continue;
+					float neighbourCost = field.costs[(y + dy) * width + x + dx];
+					if (neighbourCost != UNREACHABLE) best = std::min(best, neighbourCost + stepCost(tileSize, dx, dy));
+				}
+			}
+			if (best >= field.costs[node]) return;
+			field.costs[node] = best;
+			lowered.push_back(node);
+			if (pq.contains(node)) pq.changePriority(node);
+			else pq.insert(node);
+		};
+		for (int node : lost) seed(node);
+		for (int node : around) seed(node);
+		propagate(grid, moves, field.costs, pq, &lowered);
+
+		// A tile's direction depends on its neighbours' costs.
+		std::vector<std::uint8_t> isPointed(width * height, 0);
+		auto repoint = [&](int node) {
+			int x = node % width, y = node / width;
+			for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, height - 1); ++ny)
+			{
+				for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, width - 1); ++nx)
+				{
+					int neighbour = ny * width + nx;
+					if (isPointed[neighbour]) continue;
+					isPointed[neighbour] = 1;
+					pointTile(grid, moves, goal, nx, ny, field.costs, field.directions);
+				}
+			}
+		};
+		for (int node : around) repoint(node);
+		for (int node : lost) repoint(node);
+		for (int node : lowered) repoint(node);
+	}
+}
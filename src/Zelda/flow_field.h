@@ -0,0 +1,95 @@
+#ifndef TE_FLOW_FIELD_H
+#define TE_FLOW_FIELD_H
+
+#include "walkable_grid.h"
+#include "jump_point_search.h"
+
+#include <SFML/System/Vector2.hpp>
+
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace te
+{
+	class JobPool;
+
+	// The way to one goal from every tile of a WalkableGrid at once, for
+	// crowds chasing the same thing. A Dijkstra search outward from the
+	// goal gives each walkable tile its distance to it, and each tile then
+	// points at the neighbour on its shortest way there, so an agent only
+	// has to look up the tile it is on however many others follow the
+	// same field.
+	//
+	// The field is only worked out again when the goal reaches a new tile,
+	// or strays further than the goal tolerance if one is set, and only
+	// while agents are following it: if nothing has called getDirection or
+	// getCost since the last update, update leaves the field as it is.
+	// Tiles marked dirty only have the part of the field around them
+	// worked out again. The work happens on the job pool, when there is
+	// one, against a copy of the grid while agents keep reading the last
+	// field.
+	class FlowField
+	{
+	public:
+		explicit FlowField(const WalkableGrid& grid, JumpPointSearch::Moves moves = JumpPointSearch::Moves::DIAGONAL, JobPool* pPool = nullptr);
+		~FlowField();
+
+		void setGoal(sf::Vector2f position);
+		sf::Vector2f getGoal() const;
+		// How many tiles the goal may move from the tile the field leads
+		// to before it is worked out again. Agents closer than that should
+		// head for getGoal themselves.
+		void setGoalTolerance(int tiles);
+		// For when tiles of the grid have been shut or opened. Only the
+		// tiles whose way to the goal goes through or past them, or can now,
+		// are worked out again.
+		void markDirty(const std::vector<sf::Vector2i>& tiles);
+
+		// Swaps in a finished field and starts the next one when needed.
+		void update();
+
+		// The unit direction to move in from position, or zero on the
+		// goal's tile, off the grid, or where the goal cannot be reached.
+		sf::Vector2f getDirection(sf::Vector2f position) const;
+		// Distance to the goal from position's tile, or -1 when the goal
+		// cannot be reached from it.
+		float getCost(sf::Vector2f position) const;
+		// Whether the field is for the goal's tile as it is now.
+		bool isUpToDate() const;
+
+	private:
+		FlowField(const FlowField&) = delete;
+		FlowField& operator=(const FlowField&) = delete;
+
+		struct Field
+		{
+			sf::Vector2i goal;
+			std::vector<float> costs;
+			std::vector<sf::Vector2f> directions;
+		};
+
+		static void compute(const WalkableGrid& grid, JumpPointSearch::Moves moves, sf::Vector2i goal, Field& field);
+		// Brings field up to date with grid after tiles changed.
+		static void repair(const WalkableGrid& grid, JumpPointSearch::Moves moves, const std::vector<sf::Vector2i>& changed, Field& field);
+		int getIndex(sf::Vector2f position) const;
+		bool needsRecompute() const;
+
+		const WalkableGrid& mGrid;
+		JumpPointSearch::Moves mMoves;
+		sf::Vector2f mGoal;
+		int mGoalTolerance;
+		// Tiles changed since the field being read or filled was started.
+		std::vector<sf::Vector2i> mDirtyTiles;
+		// Whether an agent has read the field since the last update.
+		mutable bool mFollowed;
+
+		// Agents read mpField while the next one is filled into mpSpare.
+		std::unique_ptr<Field> mpField;
+		std::unique_ptr<Field> mpSpare;
+		JobPool* mpPool;
+		std::future<void> mComputing;
+	};
+}
+
+#endif
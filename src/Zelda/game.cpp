@@ -3,11 +3,14 @@
 #include "vector_ops.h"
 #include "entity_manager.h"
 #include "message_dispatcher.h"
+#include "path_manager.h"
 #include "scene_node.h"
 #include "application.h"
+#include "../TantechEngine/job_pool.h"
 
 #include <algorithm>
 #include <iterator>
+#include <stdexcept>
 
 namespace te
 {
@@ -19,38 +22,31 @@ namespace te
 		, mAtlasManager()
 		, mpEntityManager(EntityManager::make())
 		, mpMessageDispatcher(MessageDispatcher::make(*mpEntityManager))
+		, mpPathManager(std::make_unique<PathManager>(*mpMessageDispatcher))
+		, mpJobPool(std::make_unique<JobPool>())
 		, mpWorld(new b2World(b2Vec2(0, 0)))
 		, mEntities()
+		, mpCellSpace(nullptr)
 	{}
 
 	Game::~Game() {}
 
-	//bool Game::isPathObstructed(sf::Vector2f a, sf::Vector2f b, float boundingRadius) const
-	//{
-	//	throwIfNoMap();
-	//	auto& walls = mpTileMap->getWalls();
-
-	//	sf::Vector2f toB = normalize(b - a);
-	//	sf::Vector2f currPos = a;
-
-	//	while (distanceSq(currPos, b) > boundingRadius * boundingRadius)
-	//	{
-	//		currPos += toB * 0.5f * boundingRadius;
-	//		for (auto& wall : walls)
-	//			if (wall.intersects(currPos, boundingRadius))
-	//				return true;
-	//	}
-
-	//	return false;
-	//}
-
 	void Game::update(const sf::Time& dt)
 	{
 		mpMessageDispatcher->dispatchDelayedMessages(dt);
+		mpPathManager->update();
 		mpWorld->Step(dt.asSeconds(), 8, 3);
 		std::for_each(mEntities.begin(), mEntities.end(), [dt](const std::unique_ptr<BaseGameEntity>& pEntity) {
 			pEntity->update(dt);
 		});
+		if (mpCellSpace)
+		{
+			for (auto& pEntity : mEntities)
+			{
+				if (pEntity->isMarkedForRemoval()) mpCellSpace->removeEntity(pEntity.get());
+				else mpCellSpace->updateEntity(pEntity.get());
+			}
+		}
 		mEntities.erase(std::remove_if(mEntities.begin(), mEntities.end(), [](const std::unique_ptr<BaseGameEntity>& pEntity) {
 			return pEntity->isMarkedForRemoval();
 		}), mEntities.end());
@@ -71,6 +67,16 @@ namespace te
 		return *mpMessageDispatcher;
 	}
 
+	PathManager& Game::getPathManager() const
+	{
+		return *mpPathManager;
+	}
+
+	JobPool& Game::getJobPool() const
+	{
+		return *mpJobPool;
+	}
+
 	b2World& Game::getPhysicsWorld() { return *mpWorld; }
 	const b2World& Game::getPhysicsWorld() const { return *mpWorld; }
 
@@ -124,9 +130,25 @@ namespace te
 	void Game::addEntity(std::unique_ptr<BaseGameEntity>&& pEntity)
 	{
 		getEntityManager().registerEntity(*pEntity);
+		if (mpCellSpace) mpCellSpace->addEntity(pEntity.get());
 		mEntities.push_back(std::move(pEntity));
 	}
 
+	const std::vector<BaseGameEntity*>& Game::getNeighbors(sf::Vector2f position, float radius)
+	{
+		if (!mpCellSpace) throw std::runtime_error("Cell space not set in Game.");
+		return mpCellSpace->calculateNeighbors(position, radius);
+	}
+
+	void Game::setCellSpace(float width, float height, int cellsX, int cellsY)
+	{
+		mpCellSpace = std::make_unique<CellSpacePartition<BaseGameEntity*>>(width, height, cellsX, cellsY, static_cast<int>(mEntities.size()));
+		for (auto& pEntity : mEntities)
+		{
+			mpCellSpace->addEntity(pEntity.get());
+		}
+	}
+
 	void Game::setUnitToPixelScale(sf::Vector2f scale)
 	{
 		setScale(1 / scale.x, 1 / scale.y);
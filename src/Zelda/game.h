@@ -7,6 +7,7 @@
 #include "texture_atlas.h"
 #include "animation.h"
 #include "tile_map_layer.h"
+#include "cell_space_partition.h"
 
 #include <SFML/Graphics.hpp>
 #include <lua.hpp>
@@ -21,7 +22,9 @@ namespace te
 {
 	class Application;
 	class EntityManager;
+	class JobPool;
 	class MessageDispatcher;
+	class PathManager;
 	class BaseGameEntity;
 
 	class Game : public Runnable, protected sf::Transformable
@@ -47,11 +50,16 @@ namespace te
 
 		EntityManager& getEntityManager() const;
 		MessageDispatcher& getMessageDispatcher() const;
+		PathManager& getPathManager() const;
+		JobPool& getJobPool() const;
 
 		b2World& getPhysicsWorld();
 		const b2World& getPhysicsWorld() const;
 
 		void addEntity(std::unique_ptr<BaseGameEntity>&&);
+		// The entities closer to position than radius. Valid until the
+		// next call.
+		const std::vector<BaseGameEntity*>& getNeighbors(sf::Vector2f position, float radius);
 
 		void setUnitToPixelScale(sf::Vector2f scale);
 		sf::Vector2f getUnitToPixelScale() const;
@@ -62,6 +70,11 @@ namespace te
 		virtual void update(const sf::Time& dt);
 		virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
 
+		// Buckets the entities by position over a width by height space,
+		// usually the map, for getNeighbors. They move between buckets
+		// after every update.
+		void setCellSpace(float width, float height, int cellsX, int cellsY);
+
 		ResourceManager<TMX>& getTMXManager() { return mTMXManager; }
 		const ResourceManager<TMX>& getTMXManager() const { return mTMXManager; }
 
@@ -93,9 +106,13 @@ namespace te
 
 		std::unique_ptr<EntityManager> mpEntityManager;
 		std::unique_ptr<MessageDispatcher> mpMessageDispatcher;
+		// Outlives the entities, whose planners cancel their requests.
+		std::unique_ptr<PathManager> mpPathManager;
+		std::unique_ptr<JobPool> mpJobPool;
 
 		std::unique_ptr<b2World> mpWorld;
 		std::vector<std::unique_ptr<BaseGameEntity>> mEntities;
+		std::unique_ptr<CellSpacePartition<BaseGameEntity*>> mpCellSpace;
 	};
 }
 
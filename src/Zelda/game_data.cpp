@@ -1,9 +1,12 @@
 #include "game_data.h"
 #include "utilities.h"
+#include "../TantechEngine/asset_pack.h"
 
 #include <lua.hpp>
 #include <LuaBridge.h>
 
+#include <limits>
+
 namespace te
 {
 	static int panic(lua_State* L)
@@ -13,11 +16,15 @@ namespace te
 		return 0;
 	}
 
+	static const std::size_t CONTACT_EVENT_CAPACITY = 1024;
+
 	GameData::GameData()
 		: config{}
 		, pixelToWorldScale{1, 1}
 		, mainView{}
+		, pJobPool{std::make_unique<JobPool>()}
 		, physicsWorld{b2Vec2{0, 0}}
+		, physicsRegions{physicsWorld, pJobPool.get()}
 		, textureHolder{}
 		, atlasHolder{}
 		, spriteHolder{}
@@ -25,15 +32,18 @@ namespace te
 		, mapLayerHolder{}
 		, entityIDManager{}
 		, positions{}
+		, previousPositions{}
 		, velocities{}
 		, sprites{}
 		, mapLayers{}
 		, pendingDraws{}
+		, contactEvents{CONTACT_EVENT_CAPACITY}
 		, pL{luaL_newstate(), &lua_close}
 		, pWindow{}
 	{
 		lua_State* L = pL.get();
 		luaL_openlibs(L);
+		openAssetLoaders(L);
 		doLuaFile(*L, "assets/scripts/config.lua");
 
 		lua_atpanic(L, &panic);
@@ -42,10 +52,22 @@ namespace te
 		config.screenHeight = luabridge::getGlobal(L, "SCREEN_HEIGHT");
 		config.windowTitle = luabridge::getGlobal(L, "WINDOW_TITLE").cast<std::string>();
 		config.initialScript = luabridge::getGlobal(L, "INITIAL_SCRIPT").cast<std::string>();
+		luabridge::LuaRef textureBudget = luabridge::getGlobal(L, "TEXTURE_BUDGET_MB");
+		config.textureBudget = textureBudget.isNil() ? 0 : textureBudget.cast<std::size_t>() * 1024 * 1024;
+		textureHolder.setBudget(config.textureBudget);
+		luabridge::LuaRef physicsRate = luabridge::getGlobal(L, "PHYSICS_RATE");
+		luabridge::LuaRef velocityIterations = luabridge::getGlobal(L, "PHYSICS_VELOCITY_ITERATIONS");
+		luabridge::LuaRef positionIterations = luabridge::getGlobal(L, "PHYSICS_POSITION_ITERATIONS");
+		luabridge::LuaRef regionSleepDistance = luabridge::getGlobal(L, "PHYSICS_REGION_SLEEP_DISTANCE");
+		config.physics.rate = physicsRate.isNil() ? config.fps : physicsRate.cast<int>();
+		config.physics.velocityIterations = velocityIterations.isNil() ? 8 : velocityIterations.cast<int>();
+		config.physics.positionIterations = positionIterations.isNil() ? 3 : positionIterations.cast<int>();
+		config.physics.regionSleepDistance = regionSleepDistance.isNil() ? std::numeric_limits<float>::infinity() : regionSleepDistance.cast<float>();
 
 		pWindow = std::make_unique<sf::RenderWindow>(sf::VideoMode{ config.screenWidth, config.screenHeight }, config.windowTitle);
 
 		pL = { luaL_newstate(), &lua_close };
 		luaL_openlibs(pL.get());
+		openAssetLoaders(pL.get());
 	}
 }
@@ -7,16 +7,30 @@
 #include "texture_atlas.h"
 #include "tmx.h"
 #include "entity_id_manager.h"
+#include "physics_regions.h"
+#include "contact_events.h"
+#include "../TantechEngine/job_pool.h"
 
 #include <SFML/Graphics.hpp>
 #include <Box2D/Box2D.h>
 
+#include <map>
 #include <memory>
+#include <vector>
 
 struct lua_State;
 
 namespace te
 {
+	struct PhysicsConfig
+	{
+		int rate;
+		int velocityIterations;
+		int positionIterations;
+		// Physics regions this far from the player stop stepping.
+		float regionSleepDistance;
+	};
+
 	struct Config
 	{
 		int fps;
@@ -24,6 +38,8 @@ namespace te
 		unsigned screenHeight;
 		std::string windowTitle;
 		std::string initialScript;
+		std::size_t textureBudget;
+		PhysicsConfig physics;
 	};
 
 	struct PendingDraw
@@ -42,7 +58,10 @@ namespace te
 		Config config;
 		sf::Vector2f pixelToWorldScale;
 		sf::View mainView;
+		// Worker threads shared by everything that splits work up.
+		std::unique_ptr<JobPool> pJobPool;
 		b2World physicsWorld;
+		PhysicsRegions physicsRegions;
 
 		template <typename Resource>
 		using ResourceHolder = te::ResourceManager<Resource>;
@@ -53,6 +72,16 @@ namespace te
 		ResourceHolder<TMX> tmxHolder;
 		ResourceHolder<TileMapLayer> mapLayerHolder;
 
+		// What each layer in mapLayerHolder holds on to: the tileset textures
+		// it draws with, acquired from textureHolder, and the entities drawing
+		// a copy of it. Both are let go of when the layer is dropped.
+		struct MapLayerUse
+		{
+			std::vector<ResourceID<sf::Texture>> textures;
+			std::vector<EntityID> entities;
+		};
+		std::map<int, MapLayerUse> mapLayerUses;
+
 		EntityIDManager entityIDManager;
 
 		struct {
@@ -62,11 +91,15 @@ namespace te
 			bool down;
 		} directionInput;
 		ComponentStore<sf::Vector2f> positions;
+		// Rigid body positions before the last physics step.
+		ComponentStore<sf::Vector2f> previousPositions;
 		ComponentStore<std::unique_ptr<b2Body, std::function<void(b2Body*)>>> rigidBodies;
 		ComponentStore<sf::Vector2f> velocities;
 		RenderableStore<sf::Sprite> sprites;
 		RenderableStore<te::TileMapLayer> mapLayers;
 		std::vector<PendingDraw> pendingDraws;
+		// Contacts begun and ended since the last fixed update.
+		ContactEventBuffer contactEvents;
 
 		std::unique_ptr<lua_State, void(*)(lua_State*)> pL;
 		std::unique_ptr<sf::RenderWindow> pWindow;
@@ -0,0 +1,41 @@
+#include "goal_follow_flow_field.h"
+#include "zelda_entity.h"
+#include "flow_field.h"
+#include "vector_ops.h"
+
+namespace te
+{
+	Goal_FollowFlowField::Goal_FollowFlowField(ZeldaEntity& owner, const FlowField& flowField)
+		: mOwner(owner)
+		, mFlowField(flowField)
+	{}
+
+	void Goal_FollowFlowField::activate()
+	{
+		setStatus(Status::ACTIVE);
+		mOwner.getSteering().setFlowFieldEnabled(true, &mFlowField);
+	}
+
+	Goal<ZeldaEntity>::Status Goal_FollowFlowField::process(const sf::Time& dt)
+	{
+		if (isInactive())
+			activate();
+
+		sf::Vector2f currPosition = mOwner.getPosition();
+		if (distanceSq(currPosition, mFlowField.getGoal()) < 64.f)
+		{
+			setStatus(Status::COMPLETED);
+		}
+		else if (mFlowField.isUpToDate() && mFlowField.getCost(currPosition) < 0.f)
+		{
+			setStatus(Status::FAILED);
+		}
+
+		return getStatus();
+	}
+
+	void Goal_FollowFlowField::terminate()
+	{
+		mOwner.getSteering().setFlowFieldEnabled(false);
+	}
+}
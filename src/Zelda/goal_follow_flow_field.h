@@ -0,0 +1,31 @@
+#ifndef TE_GOAL_FOLLOW_FLOW_FIELD_H
+#define TE_GOAL_FOLLOW_FLOW_FIELD_H
+
+#include "goal.h"
+
+#include <SFML/Graphics.hpp>
+
+namespace te
+{
+	class ZeldaEntity;
+	class FlowField;
+
+	// Steers along a flow field until the owner reaches its goal. Fails
+	// when the field says the goal cannot be reached from where the owner
+	// is.
+	class Goal_FollowFlowField : public Goal<ZeldaEntity>
+	{
+	public:
+		Goal_FollowFlowField(ZeldaEntity& owner, const FlowField& flowField);
+
+		void activate();
+		Status process(const sf::Time& dt);
+		void terminate();
+
+	private:
+		ZeldaEntity& mOwner;
+		const FlowField& mFlowField;
+	};
+}
+
+#endif
@@ -1,5 +1,6 @@
 #include "goal_follow_path.h"
 #include "goal_seek_to_position.h"
+#include "zelda_entity.h"
 
 namespace te
 {
@@ -27,6 +28,15 @@ namespace te
 
 		setStatus(processSubgoals(dt));
 
+		// The planner hands out a path a leg at a time.
+		if (isCompleted() && mPath.empty() && mOwner.getPathPlanner().hasPendingSegments())
+		{
+			if (!mOwner.getPathPlanner().refineNextSegment(mPath))
+			{
+				setStatus(Status::FAILED);
+			}
+		}
+
 		if (isCompleted() && !mPath.empty())
 		{
 			activate();
@@ -1,12 +1,18 @@
 #include "goal_move_to_position.h"
 #include "zelda_entity.h"
 #include "goal_follow_path.h"
+#include "goal_follow_flow_field.h"
+#include "tile_map.h"
+#include "path_manager.h"
+#include "message_dispatcher.h"
+#include "game.h"
 
 namespace te
 {
 	Goal_MoveToPosition::Goal_MoveToPosition(ZeldaEntity& owner, sf::Vector2f position)
 		: mOwner(owner)
 		, mPosition(position)
+		, mAwaitingPath(false)
 	{}
 
 	void Goal_MoveToPosition::activate()
@@ -15,11 +21,20 @@ namespace te
 
 		removeAllSubgoals();
 
-		std::list<sf::Vector2f> path;
-		if (mOwner.getPathPlanner().createPathToPosition(mPosition, path))
+		// Where the map's flow field leads needs no search of its own; the
+		// field is shared by everything heading there.
+		TileMap& map = mOwner.getWorld().getMap();
+		const WalkableGrid& grid = map.getWalkableGrid();
+		if (grid.getTile(mPosition) == grid.getTile(map.getFlowField().getGoal()))
 		{
-			addSubgoal<Goal_FollowPath>(mOwner, std::move(path));
+			addSubgoal<Goal_FollowFlowField>(mOwner, map.getFlowField());
+			return;
 		}
+
+		// The path turns up as a message once the world's PathManager has
+		// found it.
+		mAwaitingPath = true;
+		mOwner.getPathPlanner().requestPathToPosition(mPosition);
 	}
 
 	Goal<ZeldaEntity>::Status Goal_MoveToPosition::process(const sf::Time& dt)
@@ -29,6 +44,11 @@ namespace te
 			activate();
 		}
 
+		if (mAwaitingPath || hasFailed())
+		{
+			return getStatus();
+		}
+
 		setStatus(processSubgoals(dt));
 
 		if (hasFailed())
@@ -39,5 +59,36 @@ namespace te
 		return getStatus();
 	}
 
-	void Goal_MoveToPosition::terminate() {}
+	void Goal_MoveToPosition::terminate()
+	{
+		if (mAwaitingPath)
+		{
+			mOwner.getWorld().getPathManager().cancel(mOwner.getPathPlanner());
+			mAwaitingPath = false;
+		}
+	}
+
+	bool Goal_MoveToPosition::handleMessage(const Telegram& telegram)
+	{
+		if (GoalComposite<ZeldaEntity>::handleMessage(telegram))
+		{
+			return true;
+		}
+
+		switch (telegram.msg)
+		{
+		case PathManager::PathReady:
+			mAwaitingPath = false;
+			addSubgoal<Goal_FollowPath>(mOwner, mOwner.getPathPlanner().getPath());
+			return true;
+
+		case PathManager::NoPathAvailable:
+			mAwaitingPath = false;
+			setStatus(Status::FAILED);
+			return true;
+
+		default:
+			return false;
+		}
+	}
 }
@@ -17,10 +17,13 @@ namespace te
 		void activate();
 		Status process(const sf::Time& dt);
 		void terminate();
+		// Picks up the path asked for in activate.
+		bool handleMessage(const Telegram& telegram);
 
 	private:
 		ZeldaEntity& mOwner;
 		sf::Vector2f mPosition;
+		bool mAwaitingPath;
 	};
 }
 
@@ -21,22 +21,42 @@ namespace te
 		}
 	};
 
+	// Keeps its per-node buffers between searches and only resets the
+	// nodes the last search reached, so one instance can answer many
+	// queries on the same graph without allocating.
 	template <class Graph, class Heuristic>
 	class GraphSearchAStar
 	{
 	public:
 		typedef typename Graph::Edge Edge;
 
-		GraphSearchAStar(const Graph& graph, int source, int target)
+		explicit GraphSearchAStar(const Graph& graph)
 			: mGraph(graph)
 			, mGCosts(graph.numNodes(), 0.f)
 			, mFCosts(graph.numNodes(), 0.f)
 			, mShortestPathTree(graph.numNodes(), nullptr)
 			, mSearchFrontier(graph.numNodes(), nullptr)
-			, mSource(source)
-			, mTarget(target)
+			, mTouched()
+			, mPQ(mFCosts)
+			, mSource(-1)
+			, mTarget(-1)
+		{
+		}
+
+		GraphSearchAStar(const Graph& graph, int source, int target)
+			: GraphSearchAStar(graph)
 		{
+			search(source, target);
+		}
+
+		// Returns whether target was reached.
+		bool search(int source, int target)
+		{
+			reset();
+			mSource = source;
+			mTarget = target;
 			search();
+			return mTarget >= 0 && mTarget < mGraph.numNodes() && mShortestPathTree[mTarget] != nullptr;
 		}
 
 		std::vector<const Edge*> getAllPaths() const
@@ -64,14 +84,39 @@ namespace te
 		}
 
 	private:
+		GraphSearchAStar(const GraphSearchAStar&) = delete;
+		GraphSearchAStar& operator=(const GraphSearchAStar&) = delete;
+
+		void reset()
+		{
+			// The graph may have grown since the buffers were made.
+			if (mGCosts.size() != static_cast<std::size_t>(mGraph.numNodes()))
+			{
+				mGCosts.resize(mGraph.numNodes(), 0.f);
+				mFCosts.resize(mGraph.numNodes(), 0.f);
+				mShortestPathTree.resize(mGraph.numNodes(), nullptr);
+				mSearchFrontier.resize(mGraph.numNodes(), nullptr);
+			}
+
+			for (int node : mTouched)
+			{
+				mGCosts[node] = 0.f;
+				mFCosts[node] = 0.f;
+				mShortestPathTree[node] = nullptr;
+				mSearchFrontier[node] = nullptr;
+			}
+			mTouched.clear();
+			mPQ.clear();
+		}
+
 		void search()
 		{
-			IndexedPriorityQueue<double> pq(mFCosts);
-			pq.insert(mSource);
+			mPQ.insert(mSource);
+			mTouched.push_back(mSource);
 
-			while (!pq.empty())
+			while (!mPQ.empty())
 			{
-				int nextClosestNode = pq.pop();
+				int nextClosestNode = static_cast<int>(mPQ.pop());
 				mShortestPathTree[nextClosestNode] = mSearchFrontier[nextClosestNode];
 
 				if (nextClosestNode == mTarget) return;
@@ -79,26 +124,26 @@ namespace te
 				typename Graph::ConstEdgeIterator constEdgeIter(mGraph, nextClosestNode);
 				for (const Edge* pEdge = constEdgeIter.begin(); !constEdgeIter.end(); pEdge = constEdgeIter.next())
 				{
-					double hCost = Heuristic::calculate(mGraph, mTarget, pEdge->getTo());
+					int to = pEdge->getTo();
 					double gCost = mGCosts[nextClosestNode] + pEdge->getCost();
 
-					if (mSearchFrontier[pEdge->getTo()] == nullptr)
+					if (mSearchFrontier[to] == nullptr && to != mSource)
 					{
-						mFCosts[pEdge->getTo()] = gCost + hCost;
-						mGCosts[pEdge->getTo()] = gCost;
-						pq.insert(pEdge->getTo());
-						mSearchFrontier[pEdge->getTo()] = pEdge;
+						mFCosts[to] = gCost + Heuristic::calculate(mGraph, mTarget, to);
+						mGCosts[to] = gCost;
+						mPQ.insert(to);
+						mTouched.push_back(to);
+						mSearchFrontier[to] = pEdge;
 					}
 
-					else if ((gCost < mGCosts[pEdge->getTo()]) && (mShortestPathTree[pEdge->getTo()] == nullptr))
+					else if ((gCost < mGCosts[to]) && mPQ.contains(to))
 					{
-						mGCosts[pEdge->getTo()] = gCost;
-
-						std::vector<size_t> elems = pq.popAll();
-						mFCosts[pEdge->getTo()] = gCost + hCost;
-						pq.assignElements(std::move(elems));
+						// Same node, same heuristic, so f drops by as much as g.
+						mFCosts[to] -= mGCosts[to] - gCost;
+						mGCosts[to] = gCost;
+						mPQ.changePriority(to);
 
-						mSearchFrontier[pEdge->getTo()] = pEdge;
+						mSearchFrontier[to] = pEdge;
 					}
 				}
 			}
@@ -109,6 +154,9 @@ namespace te
 		std::vector<double> mFCosts;
 		std::vector<const Edge*> mShortestPathTree;
 		std::vector<const Edge*> mSearchFrontier;
+		// Nodes the last search put on the frontier.
+		std::vector<int> mTouched;
+		IndexedPriorityQueue<double> mPQ;
 		int mSource;
 		int mTarget;
 	};
@@ -0,0 +1,176 @@
+#ifndef TE_GRAPH_SEARCH_COMPACT_A_STAR_H
+#define TE_GRAPH_SEARCH_COMPACT_A_STAR_H
+
+#include "compact_nav_graph.h"
+#include "indexed_priority_queue.h"
+#include "search_status.h"
+
+#include <cmath>
+#include <limits>
+#include <list>
+#include <vector>
+
+namespace te
+{
+	// GraphSearchAStar over a CompactNavGraph, walking each node's edges as
+	// plain arrays. Keeps its buffers between searches like the other, and
+	// can also be run a number of expansions at a time with begin and
+	// cycle.
+	class GraphSearchCompactAStar
+	{
+	public:
+		explicit GraphSearchCompactAStar(const CompactNavGraph& graph)
+			: mGraph(graph)
+			, mGCosts(graph.numNodes(), 0.f)
+			, mFCosts(graph.numNodes(), 0.f)
+			, mParents(graph.numNodes(), NO_PARENT)
+			, mClosed(graph.numNodes(), false)
+			, mTouched()
+			, mPQ(mFCosts)
+			, mSource(-1)
+			, mTarget(-1)
+			, mTargetX(0.f)
+			, mTargetY(0.f)
+			, mFound(false)
+		{
+		}
+
+		// Returns whether target was reached.
+		bool search(int source, int target)
+		{
+			begin(source, target);
+			return cycle(std::numeric_limits<int>::max()) == SearchStatus::FOUND;
+		}
+
+		// Starts a search for cycle to carry out in steps.
+		void begin(int source, int target)
+		{
+			reset();
+			mSource = source;
+			mTarget = target;
+			mFound = false;
+			if (!mGraph.isActive(source) || !mGraph.isActive(target)) return;
+
+			mTargetX = mGraph.getX(target);
+			mTargetY = mGraph.getY(target);
+			mParents[source] = source;
+			mFCosts[source] = heuristic(source);
+			mTouched.push_back(source);
+			mPQ.insert(source);
+		}
+
+		// Expands at most maxExpansions more nodes of the search begun.
+		SearchStatus cycle(int maxExpansions)
+		{
+			if (mFound) return SearchStatus::FOUND;
+
+			for (int expansions = 0; !mPQ.empty(); ++expansions)
+			{
+				if (expansions == maxExpansions) return SearchStatus::INCOMPLETE;
+
+				int node = static_cast<int>(mPQ.pop());
+				mClosed[node] = true;
+				if (node == mTarget)
+				{
+					mFound = true;
+					return SearchStatus::FOUND;
+				}
+
+				const float gCost = mGCosts[node];
+				const int* targets = mGraph.targetsBegin(node);
+				const int* targetsEnd = mGraph.targetsEnd(node);
+				const float* costs = mGraph.costsBegin(node);
+				for (; targets != targetsEnd; ++targets, ++costs)
+				{
+					int to = *targets;
+					if (mClosed[to] || !(mGraph.getFlags(to) & CompactNavGraph::ACTIVE)) continue;
+
+					float newGCost = gCost + *costs;
+					if (mParents[to] == NO_PARENT)
+					{
+						mGCosts[to] = newGCost;
+						mFCosts[to] = newGCost + heuristic(to);
+						mParents[to] = node;
+						mTouched.push_back(to);
+						mPQ.insert(to);
+					}
+					else if (newGCost < mGCosts[to])
+					{
+						mFCosts[to] -= mGCosts[to] - newGCost;
+						mGCosts[to] = newGCost;
+						mParents[to] = node;
+						mPQ.changePriority(to);
+					}
+				}
+			}
+			return SearchStatus::NOT_FOUND;
+		}
+
+		// From target back to source, like GraphSearchAStar.
+		std::list<int> getPathToTarget() const
+		{
+			std::list<int> path;
+			if (!mFound) return path;
+
+			int node = mTarget;
+			path.push_back(node);
+			while (node != mSource)
+			{
+				node = mParents[node];
+				path.push_back(node);
+			}
+			return path;
+		}
+
+		float getCostToTarget() const
+		{
+			return mFound ? mGCosts[mTarget] : -1.f;
+		}
+
+		// Nodes the last search put on the frontier.
+		std::size_t getNodesTouched() const
+		{
+			return mTouched.size();
+		}
+
+	private:
+		GraphSearchCompactAStar(const GraphSearchCompactAStar&) = delete;
+		GraphSearchCompactAStar& operator=(const GraphSearchCompactAStar&) = delete;
+
+		enum { NO_PARENT = -1 };
+
+		float heuristic(int node) const
+		{
+			float dx = mGraph.getX(node) - mTargetX, dy = mGraph.getY(node) - mTargetY;
+			return std::sqrt(dx * dx + dy * dy);
+		}
+
+		void reset()
+		{
+			for (int node : mTouched)
+			{
+				mGCosts[node] = 0.f;
+				mFCosts[node] = 0.f;
+				mParents[node] = NO_PARENT;
+				mClosed[node] = false;
+			}
+			mTouched.clear();
+			mPQ.clear();
+		}
+
+		const CompactNavGraph& mGraph;
+		std::vector<float> mGCosts;
+		std::vector<float> mFCosts;
+		std::vector<int> mParents;
+		std::vector<bool> mClosed;
+		std::vector<int> mTouched;
+		IndexedPriorityQueue<float> mPQ;
+		int mSource;
+		int mTarget;
+		float mTargetX;
+		float mTargetY;
+		bool mFound;
+	};
+}
+
+#endif
@@ -3,22 +3,41 @@
 
 #include "indexed_priority_queue.h"
 
+#include <list>
 #include <memory>
+#include <vector>
 
 namespace te
 {
+	// Reusable between searches like GraphSearchAStar.
 	template <class Graph>
 	class GraphSearchDijkstra
 	{
 	public:
-		GraphSearchDijkstra(const Graph& graph, int source, int target = -1)
+		explicit GraphSearchDijkstra(const Graph& graph)
 			: mGraph(graph)
 			, mShortestPathTree(mGraph.numNodes())
 			, mCostToThisNode(mGraph.numNodes())
 			, mSearchFrontier(mGraph.numNodes())
-			, mSource(source)
-			, mTarget(target)
+			, mTouched()
+			, mPQ(mCostToThisNode)
+			, mSource(-1)
+			, mTarget(-1)
+		{
+		}
+
+		GraphSearchDijkstra(const Graph& graph, int source, int target = -1)
+			: GraphSearchDijkstra(graph)
 		{
+			search(source, target);
+		}
+
+		// Without a target every node reachable from source is searched.
+		void search(int source, int target = -1)
+		{
+			reset();
+			mSource = source;
+			mTarget = target;
 			search();
 		}
 
@@ -56,37 +75,59 @@ namespace te
 		typedef typename Graph::Node Node;
 		typedef typename Graph::Edge Edge;
 
+		GraphSearchDijkstra(const GraphSearchDijkstra&) = delete;
+		GraphSearchDijkstra& operator=(const GraphSearchDijkstra&) = delete;
+
+		void reset()
+		{
+			if (mCostToThisNode.size() != static_cast<std::size_t>(mGraph.numNodes()))
+			{
+				mShortestPathTree.resize(mGraph.numNodes());
+				mCostToThisNode.resize(mGraph.numNodes());
+				mSearchFrontier.resize(mGraph.numNodes());
+			}
+
+			for (int node : mTouched)
+			{
+				mShortestPathTree[node] = nullptr;
+				mCostToThisNode[node] = 0;
+				mSearchFrontier[node] = nullptr;
+			}
+			mTouched.clear();
+			mPQ.clear();
+		}
+
 		void search()
 		{
-			IndexedPriorityQueue<double> pq(mCostToThisNode);
-			pq.insert(mSource);
+			mPQ.insert(mSource);
+			mTouched.push_back(mSource);
 
-			while (!pq.empty())
+			while (!mPQ.empty())
 			{
-				int nextClosestNode = pq.pop();
+				int nextClosestNode = static_cast<int>(mPQ.pop());
 				mShortestPathTree[nextClosestNode] = mSearchFrontier[nextClosestNode];
 
 				if (nextClosestNode == mTarget) return;
 
-				Graph::ConstEdgeIterator constEdgeIter(mGraph, nextClosestNode);
+				typename Graph::ConstEdgeIterator constEdgeIter(mGraph, nextClosestNode);
 				for (const Edge* pE = constEdgeIter.begin(); !constEdgeIter.end(); pE = constEdgeIter.next())
 				{
 					double newCost = mCostToThisNode[nextClosestNode] + pE->getCost();
 
 					// Edge not ever on frontier
-					if (mSearchFrontier[pE->getTo()] == 0)
+					if (mSearchFrontier[pE->getTo()] == 0 && pE->getTo() != mSource)
 					{
 						mCostToThisNode[pE->getTo()] = newCost;
-						pq.insert(pE->getTo());
+						mPQ.insert(pE->getTo());
+						mTouched.push_back(pE->getTo());
 						mSearchFrontier[pE->getTo()] = pE;
 					}
 
 					// If cost here is cheaper than on record
-					else if ((newCost < mCostToThisNode[pE->getTo()]) && (mShortestPathTree[pE->getTo()] == 0))
+					else if ((newCost < mCostToThisNode[pE->getTo()]) && mPQ.contains(pE->getTo()))
 					{
-						std::vector<size_t> elems = pq.popAll();
 						mCostToThisNode[pE->getTo()] = newCost;
-						pq.assignElements(std::move(elems));
+						mPQ.changePriority(pE->getTo());
 						mSearchFrontier[pE->getTo()] = pE;
 					}
 				}
@@ -97,6 +138,9 @@ namespace te
 		std::vector<const Edge*> mShortestPathTree;
 		std::vector<double> mCostToThisNode;
 		std::vector<const Edge*> mSearchFrontier;
+		// Nodes the last search put on the frontier.
+		std::vector<int> mTouched;
+		IndexedPriorityQueue<double> mPQ;
 		int mSource;
 		int mTarget;
 	};
@@ -0,0 +1,497 @@
+#include "hierarchical_nav_graph.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+
+namespace te
+{
+	HierarchicalNavGraph::HierarchicalNavGraph(const CompactNavGraph& graph, sf::Vector2f tileSize, sf::Vector2i mapSize, int clusterSize)
+		: mGraph(graph)
+		, mClusterSize(std::max(clusterSize, 1))
+		, mClusterCount((mapSize.x + mClusterSize - 1) / mClusterSize, (mapSize.y + mClusterSize - 1) / mClusterSize)
+		, mClusterOf(graph.numNodes(), NO_CLUSTER)
+		, mClusterNodes()
+		, mClusterEntrances()
+		, mEntrances()
+		, mFreeEntrances()
+		, mEntranceOf(graph.numNodes(), NO_ENTRANCE)
+		, mTransitions()
+		, mCosts(graph.numNodes(), 0.f)
+		, mReached(graph.numNodes(), false)
+		, mTouched()
+		, mPQ(mCosts)
+		, mGCosts()
+		, mFCosts()
+		, mTargetCosts()
+		, mParents()
+		, mClosed()
+		, mEntrancesTouched()
+		, mEntrancePQ(mFCosts)
+	{
+		mClusterCount.x = std::max(mClusterCount.x, 1);
+		mClusterCount.y = std::max(mClusterCount.y, 1);
+		mClusterNodes.resize(numClusters());
+		mClusterEntrances.resize(numClusters());
+
+		for (int node = 0; node < mGraph.numNodes(); ++node)
+		{
+			int x = static_cast<int>(std::floor(mGraph.getX(node) / tileSize.x)) / mClusterSize;
+			int y = static_cast<int>(std::floor(mGraph.getY(node) / tileSize.y)) / mClusterSize;
+			x = std::min(std::max(x, 0), mClusterCount.x - 1);
+			y = std::min(std::max(y, 0), mClusterCount.y - 1);
+			mClusterOf[node] = y * mClusterCount.x + x;
+			mClusterNodes[mClusterOf[node]].push_back(node);
+		}
+
+		std::vector<int> neighbours;
+		for (int cluster = 0; cluster < numClusters(); ++cluster)
+		{
+			getNeighbourClusters(cluster, neighbours);
+			for (int neighbour : neighbours)
+			{
+				if (neighbour > cluster) addTransitions({ cluster, neighbour });
+			}
+		}
+
+		for (int cluster = 0; cluster < numClusters(); ++cluster)
+		{
+			linkCluster(cluster);
+		}
+	}
+
+	bool HierarchicalNavGraph::findPath(int source, int target, std::list<int>& waypoints)
+	{
+		waypoints.clear();
+		mEntrancesTouched.clear();
+		if (!mGraph.isActive(source) || !mGraph.isActive(target)) return false;
+
+		std::vector<int> entrancePath;
+		if (mClusterOf[source] != mClusterOf[target])
+		{
+			if (!searchEntrances(source, target, entrancePath)) return false;
+		}
+
+		waypoints.push_back(source);
+		for (int node : entrancePath)
+		{
+			if (node != waypoints.back()) waypoints.push_back(node);
+		}
+		if (target != waypoints.back()) waypoints.push_back(target);
+		return true;
+	}
+
+	void HierarchicalNavGraph::update(const std::vector<int>& changedNodes)
+	{
+		std::set<int> changed;
+		for (int node : changedNodes)
+		{
+			if (node >= 0 && node < mGraph.numNodes()) changed.insert(mClusterOf[node]);
+		}
+
+		std::set<ClusterPair> pairs;
+		std::set<int> affected(changed);
+		std::vector<int> neighbours;
+		for (int cluster : changed)
+		{
+			getNeighbourClusters(cluster, neighbours);
+			for (int neighbour : neighbours)
+			{
+				pairs.insert({ std::min(cluster, neighbour), std::max(cluster, neighbour) });
+				affected.insert(neighbour);
+			}
+		}
+
+		// Everything comes off before anything goes back on, so entrances
+		// shared between pairs are not released and recreated in between.
+		for (const auto& pair : pairs)
+		{
+			removeTransitions(pair);
+		}
+		for (const auto& pair : pairs)
+		{
+			addTransitions(pair);
+		}
+		for (int cluster : affected)
+		{
+			linkCluster(cluster);
+		}
+	}
+
+	int HierarchicalNavGraph::getClusterSize() const
+	{
+		return mClusterSize;
+	}
+
+	int HierarchicalNavGraph::numClusters() const
+	{
+		return mClusterCount.x * mClusterCount.y;
+	}
+
+	int HierarchicalNavGraph::getCluster(int node) const
+	{
+		return mClusterOf.at(node);
+	}
+
+	int HierarchicalNavGraph::numEntrances() const
+	{
+		return static_cast<int>(mEntrances.size() - mFreeEntrances.size());
+	}
+
+	std::size_t HierarchicalNavGraph::getEntrancesTouched() const
+	{
+		return mEntrancesTouched.size();
+	}
+
+	void HierarchicalNavGraph::getNeighbourClusters(int cluster, std::vector<int>& out) const
+	{
+		out.clear();
+		int x = cluster % mClusterCount.x, y = cluster / mClusterCount.x;
+		for (int dy = -1; dy <= 1; ++dy)
+		{
+			for (int dx = -1; dx <= 1; ++dx)
+			{
+				int nx = x + dx, ny = y + dy;
+				if ((dx || dy) && nx >= 0 && ny >= 0 && nx < mClusterCount.x && ny < mClusterCount.y)
+					out.push_back(ny * mClusterCount.x + nx);
+			}
+		}
+	}
+
+	void HierarchicalNavGraph::findTransitions(int clusterA, int clusterB, std::vector<Transition>& out)
+	{
+		out.clear();
+
+		// Nodes of A with an edge into B, sorted so runs can look them up.
+		std::vector<int> border;
+		for (int node : mClusterNodes[clusterA])
+		{
+			if (!mGraph.isActive(node)) continue;
+			for (const int* to = mGraph.targetsBegin(node); to != mGraph.targetsEnd(node); ++to)
+			{
+				if (mClusterOf[*to] == clusterB && mGraph.isActive(*to))
+				{
+					border.push_back(node);
+					break;
+				}
+			}
+		}
+		std::sort(border.begin(), border.end());
+
+		std::vector<bool> visited(border.size(), false);
+		std::vector<int> run, open;
+		for (std::size_t i = 0; i < border.size(); ++i)
+		{
+			if (visited[i]) continue;
+
+			run.clear();
+			open.assign(1, static_cast<int>(i));
+			visited[i] = true;
+			while (!open.empty())
+			{
+				int node = border[open.back()];
+				open.pop_back();
+				run.push_back(node);
+				for (const int* to = mGraph.targetsBegin(node); to != mGraph.targetsEnd(node); ++to)
+				{
+					auto found = std::lower_bound(border.begin(), border.end(), *to);
+					if (found == border.end() || *found != *to) continue;
+					std::size_t index = found - border.begin();
+					if (!visited[index])
+					{
+						visited[index] = true;
+						open.push_back(static_cast<int>(index));
+					}
+				}
+			}
+
+			// Along the border, which runs along one axis or is a corner.
+			std::sort(run.begin(), run.end(), [this](int a, int b) {
+				if (mGraph.getX(a) != mGraph.getX(b)) return mGraph.getX(a) < mGraph.getX(b);
+				return mGraph.getY(a) < mGraph.getY(b);
+			});
+
+			std::vector<int> picks;
+			if (run.size() >= static_cast<std::size_t>(LONG_RUN))
+				picks = { run.front(), run.back() };
+			else
+				picks = { run[run.size() / 2] };
+
+			for (int node : picks)
+			{
+				Transition transition = { node, -1, std::numeric_limits<float>::max() };
+				const float* cost = mGraph.costsBegin(node);
+				for (const int* to = mGraph.targetsBegin(node); to != mGraph.targetsEnd(node); ++to, ++cost)
+				{
+					if (mClusterOf[*to] == clusterB && mGraph.isActive(*to) && *cost < transition.cost)
+					{
+						transition.to = *to;
+						transition.cost = *cost;
+					}
+				}
+				out.push_back(transition);
+			}
+		}
+	}
+
+	void HierarchicalNavGraph::addTransitions(const ClusterPair& pair)
+	{
+		std::vector<Transition>& transitions = mTransitions[pair];
+		findTransitions(pair.first, pair.second, transitions);
+		for (const auto& transition : transitions)
+		{
+			int from = useEntrance(transition.from);
+			int to = useEntrance(transition.to);
+			mEntrances[from].links.push_back({ to, transition.cost, true });
+			mEntrances[to].links.push_back({ from, transition.cost, true });
+		}
+		if (transitions.empty()) mTransitions.erase(pair);
+	}
+
+	void HierarchicalNavGraph::removeTransitions(const ClusterPair& pair)
+	{
+		auto found = mTransitions.find(pair);
+		if (found == mTransitions.end()) return;
+
+		auto unlink = [this](int entrance, int to) {
+			auto& links = mEntrances[entrance].links;
+			auto link = std::find_if(links.begin(), links.end(), [to](const Link& l) { return l.between && l.to == to; });
+			if (link != links.end()) links.erase(link);
+		};
+
+		for (const auto& transition : found->second)
+		{
+			int from = mEntranceOf[transition.from];
+			int to = mEntranceOf[transition.to];
+			unlink(from, to);
+			unlink(to, from);
+			releaseEntrance(from);
+			releaseEntrance(to);
+		}
+		mTransitions.erase(found);
+	}
+
+	int HierarchicalNavGraph::useEntrance(int node)
+	{
+		int entrance = mEntranceOf[node];
+		if (entrance != NO_ENTRANCE)
+		{
+			++mEntrances[entrance].uses;
+			return entrance;
+		}
+
+		if (mFreeEntrances.empty())
+		{
+			entrance = static_cast<int>(mEntrances.size());
+			mEntrances.push_back(Entrance());
+		}
+		else
+		{
+			entrance = mFreeEntrances.back();
+			mFreeEntrances.pop_back();
+		}
+
+		Entrance& e = mEntrances[entrance];
+		e.node = node;
+		e.cluster = mClusterOf[node];
+		e.uses = 1;
+		e.links.clear();
+		mEntranceOf[node] = entrance;
+		mClusterEntrances[e.cluster].push_back(entrance);
+		return entrance;
+	}
+
+	// Links inside the entrance's cluster are left for linkCluster to redo.
+	void HierarchicalNavGraph::releaseEntrance(int entrance)
+	{
+		Entrance& e = mEntrances[entrance];
+		if (--e.uses > 0) return;
+
+		auto& entrances = mClusterEntrances[e.cluster];
+		entrances.erase(std::remove(entrances.begin(), entrances.end(), entrance), entrances.end());
+		mEntranceOf[e.node] = NO_ENTRANCE;
+		e.links.clear();
+		mFreeEntrances.push_back(entrance);
+	}
+
+	void HierarchicalNavGraph::linkCluster(int cluster)
+	{
+		const std::vector<int>& entrances = mClusterEntrances[cluster];
+		for (int entrance : entrances)
+		{
+			auto& links = mEntrances[entrance].links;
+			links.erase(std::remove_if(links.begin(), links.end(), [](const Link& l) { return !l.between; }), links.end());
+		}
+
+		for (std::size_t i = 0; i < entrances.size(); ++i)
+		{
+			searchCluster(mEntrances[entrances[i]].node);
+			for (std::size_t j = i + 1; j < entrances.size(); ++j)
+			{
+				int node = mEntrances[entrances[j]].node;
+				if (!mReached[node]) continue;
+				mEntrances[entrances[i]].links.push_back({ entrances[j], mCosts[node], false });
+				mEntrances[entrances[j]].links.push_back({ entrances[i], mCosts[node], false });
+			}
+		}
+	}
+
+	void HierarchicalNavGraph::searchCluster(int source)
+	{
+		for (int node : mTouched)
+		{
+			mCosts[node] = 0.f;
+			mReached[node] = false;
+		}
+		mTouched.clear();
+		mPQ.clear();
+
+		if (!mGraph.isActive(source)) return;
+
+		const int cluster = mClusterOf[source];
+		mReached[source] = true;
+		mTouched.push_back(source);
+		mPQ.insert(source);
+
+		while (!mPQ.empty())
+		{
+			int node = static_cast<int>(mPQ.pop());
+			const float cost = mCosts[node];
+			const int* targets = mGraph.targetsBegin(node);
+			const int* targetsEnd = mGraph.targetsEnd(node);
+			const float* costs = mGraph.costsBegin(node);
+			for (; targets != targetsEnd; ++targets, ++costs)
+			{
+				int to = *targets;
+				if (mClusterOf[to] != cluster || !(mGraph.getFlags(to) & CompactNavGraph::ACTIVE)) continue;
+
+				float newCost = cost + *costs;
+				if (!mReached[to])
+				{
+					mCosts[to] = newCost;
+					mReached[to] = true;
+					mTouched.push_back(to);
+					mPQ.insert(to);
+				}
+				else if (newCost < mCosts[to] && mPQ.contains(to))
+				{
+					mCosts[to] = newCost;
+					mPQ.changePriority(to);
+				}
+			}
+		}
+	}
+
+	bool HierarchicalNavGraph::searchEntrances(int source, int target, std::vector<int>& entrancePath)
+	{
+		const int count = static_cast<int>(mEntrances.size());
+		const int sourceSlot = count, targetSlot = count + 1;
+		const float unreached = std::numeric_limits<float>::max();
+
+		if (mGCosts.size() != static_cast<std::size_t>(count + 2))
+		{
+			mGCosts.assign(count + 2, 0.f);
+			mFCosts.assign(count + 2, 0.f);
+			mParents.assign(count + 2, NO_ENTRANCE);
+			mClosed.assign(count + 2, false);
+			mTargetCosts.assign(count, unreached);
+		}
+		mEntrancePQ.clear();
+
+		// What it costs to get from the target's cluster entrances to it,
+		// and from the source to its cluster entrances.
+		const std::vector<int>& targetEntrances = mClusterEntrances[mClusterOf[target]];
+		searchCluster(target);
+		for (int entrance : targetEntrances)
+		{
+			int node = mEntrances[entrance].node;
+			if (mReached[node]) mTargetCosts[entrance] = mCosts[node];
+		}
+
+		std::vector<Link> sourceLinks;
+		searchCluster(source);
+		for (int entrance : mClusterEntrances[mClusterOf[source]])
+		{
+			int node = mEntrances[entrance].node;
+			if (mReached[node]) sourceLinks.push_back({ entrance, mCosts[node], false });
+		}
+
+		const float targetX = mGraph.getX(target), targetY = mGraph.getY(target);
+		auto heuristic = [&](int slot) {
+			int node = slot < count ? mEntrances[slot].node : slot == sourceSlot ? source : target;
+			float dx = mGraph.getX(node) - targetX, dy = mGraph.getY(node) - targetY;
+			return std::sqrt(dx * dx + dy * dy);
+		};
+
+		auto relax = [&](int from, int to, float cost) {
+			if (mClosed[to]) return;
+			float newGCost = mGCosts[from] + cost;
+			if (mParents[to] == NO_ENTRANCE)
+			{
+				mGCosts[to] = newGCost;
+				mFCosts[to] = newGCost + heuristic(to);
+				mParents[to] = from;
+				mEntrancesTouched.push_back(to);
+				mEntrancePQ.insert(to);
+			}
+			else if (newGCost < mGCosts[to])
+			{
+				mFCosts[to] -= mGCosts[to] - newGCost;
+				mGCosts[to] = newGCost;
+				mParents[to] = from;
+				mEntrancePQ.changePriority(to);
+			}
+		};
+
+		mParents[sourceSlot] = sourceSlot;
+		mFCosts[sourceSlot] = heuristic(sourceSlot);
+		mEntrancesTouched.push_back(sourceSlot);
+		mEntrancePQ.insert(sourceSlot);
+
+		bool found = false;
+		while (!mEntrancePQ.empty())
+		{
+			int slot = static_cast<int>(mEntrancePQ.pop());
+			mClosed[slot] = true;
+			if (slot == targetSlot)
+			{
+				found = true;
+				break;
+			}
+
+			if (slot == sourceSlot)
+			{
+				for (const auto& link : sourceLinks)
+					relax(slot, link.to, link.cost);
+				continue;
+			}
+
+			for (const auto& link : mEntrances[slot].links)
+				relax(slot, link.to, link.cost);
+			if (mTargetCosts[slot] != unreached)
+				relax(slot, targetSlot, mTargetCosts[slot]);
+		}
+
+		entrancePath.clear();
+		if (found)
+		{
+			for (int slot = mParents[targetSlot]; slot != sourceSlot; slot = mParents[slot])
+				entrancePath.push_back(mEntrances[slot].node);
+			std::reverse(entrancePath.begin(), entrancePath.end());
+		}
+
+		for (int entrance : targetEntrances)
+		{
+			mTargetCosts[entrance] = unreached;
+		}
+		for (int slot : mEntrancesTouched)
+		{
+			mGCosts[slot] = 0.f;
+			mFCosts[slot] = 0.f;
+			mParents[slot] = NO_ENTRANCE;
+			mClosed[slot] = false;
+		}
+		return found;
+	}
+}
@@ -0,0 +1,131 @@
+#ifndef TE_HIERARCHICAL_NAV_GRAPH_H
+#define TE_HIERARCHICAL_NAV_GRAPH_H
+
+#include "compact_nav_graph.h"
+#include "indexed_priority_queue.h"
+
+#include <SFML/System/Vector2.hpp>
+
+#include <list>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace te
+{
+	// An abstract graph over a tile nav graph for HPA*. The map is cut into
+	// square clusters of tiles. Wherever two clusters touch, each run of
+	// connected border nodes gets an entrance, and the entrances of a
+	// cluster are linked by what it costs to walk between them without
+	// leaving it. A path is first found over the entrances and only then
+	// walked out on the nav graph one leg at a time, so a long request
+	// touches the few hundred entrances on the way instead of every tile.
+	//
+	// Paths come out a little longer than the shortest, since they go
+	// through entrance midpoints.
+	class HierarchicalNavGraph
+	{
+	public:
+		// mapSize in tiles; nodes are placed into clusters by dividing their
+		// position by tileSize.
+		HierarchicalNavGraph(const CompactNavGraph& graph, sf::Vector2f tileSize, sf::Vector2i mapSize, int clusterSize = DEFAULT_CLUSTER_SIZE);
+
+		// Fills waypoints with nav graph nodes from source to target, each
+		// one reachable from the one before. Source and target in the same
+		// cluster give just the two of them. Returns false if no path was
+		// found over the entrances.
+		bool findPath(int source, int target, std::list<int>& waypoints);
+
+		// Call after nodes have been turned on or off in the nav graph to
+		// recompute the clusters they are in.
+		void update(const std::vector<int>& changedNodes);
+
+		int getClusterSize() const;
+		int numClusters() const;
+		int getCluster(int node) const;
+		// Entrances currently in use.
+		int numEntrances() const;
+		// Entrances the last findPath expanded.
+		std::size_t getEntrancesTouched() const;
+
+		enum { DEFAULT_CLUSTER_SIZE = 10 };
+
+	private:
+		HierarchicalNavGraph(const HierarchicalNavGraph&) = delete;
+		HierarchicalNavGraph& operator=(const HierarchicalNavGraph&) = delete;
+
+		struct Link
+		{
+			int to;
+			float cost;
+			bool between;
+		};
+
+		// A node on a cluster border. The same node may be an entrance to
+		// more than one neighbour, so it counts its uses.
+		struct Entrance
+		{
+			int node;
+			int cluster;
+			int uses;
+			std::vector<Link> links;
+		};
+
+		struct Transition
+		{
+			int from;
+			int to;
+			float cost;
+		};
+
+		typedef std::pair<int, int> ClusterPair;
+
+		enum { NO_ENTRANCE = -1, NO_CLUSTER = -1 };
+		// Runs at least this long get an entrance at both ends.
+		enum { LONG_RUN = 6 };
+
+		void getNeighbourClusters(int cluster, std::vector<int>& out) const;
+		void findTransitions(int clusterA, int clusterB, std::vector<Transition>& out);
+		void addTransitions(const ClusterPair& pair);
+		void removeTransitions(const ClusterPair& pair);
+		int useEntrance(int node);
+		void releaseEntrance(int entrance);
+		void linkCluster(int cluster);
+
+		// Dijkstra from source to every node of its cluster, not leaving it.
+		// Costs are left in mCosts for the nodes in mTouched.
+		void searchCluster(int source);
+		bool searchEntrances(int source, int target, std::vector<int>& entrancePath);
+
+		const CompactNavGraph& mGraph;
+		int mClusterSize;
+		sf::Vector2i mClusterCount;
+
+		std::vector<int> mClusterOf;
+		std::vector<std::vector<int>> mClusterNodes;
+		std::vector<std::vector<int>> mClusterEntrances;
+
+		std::vector<Entrance> mEntrances;
+		std::vector<int> mFreeEntrances;
+		std::vector<int> mEntranceOf;
+		std::map<ClusterPair, std::vector<Transition>> mTransitions;
+
+		// Buffers for searchCluster, kept between calls.
+		std::vector<float> mCosts;
+		std::vector<bool> mReached;
+		std::vector<int> mTouched;
+		IndexedPriorityQueue<float> mPQ;
+
+		// Buffers for searchEntrances. The last two slots stand for the
+		// source and the target.
+		std::vector<float> mGCosts;
+		std::vector<float> mFCosts;
+		std::vector<float> mTargetCosts;
+		std::vector<int> mParents;
+		std::vector<bool> mClosed;
+		std::vector<int> mEntrancesTouched;
+		IndexedPriorityQueue<float> mEntrancePQ;
+	};
+}
+
+#endif
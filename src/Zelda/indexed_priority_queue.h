@@ -1,57 +1,135 @@
 #ifndef TE_INDEXED_PRIORITY_QUEUE_H
 #define TE_INDEXED_PRIORITY_QUEUE_H
 
-#include <queue>
+#include <cassert>
+#include <cstddef>
+#include <vector>
 
 namespace te
 {
-	template <class T>
+	// Binary min-heap of indices into a vector of keys, lowest key first.
+	// It knows where each index sits in the heap, so when an index's key
+	// drops, changePriority moves just that index up instead of the whole
+	// queue being rebuilt.
+	template <class KeyType>
 	class IndexedPriorityQueue
 	{
 	public:
-		IndexedPriorityQueue(const std::vector<T>& keys)
-			: mCompare([&keys](size_t lhs, size_t rhs) { return keys.at(lhs) > keys.at(rhs); })
-			, mPriorityQueue(mCompare)
+		explicit IndexedPriorityQueue(const std::vector<KeyType>& keys)
+			: mKeys(keys)
+			, mHeap()
+			, mPositions(keys.size(), NOT_QUEUED)
 		{
 		}
 
-		void insert(size_t index)
+		void insert(std::size_t index)
 		{
-			mPriorityQueue.push(index);
+			if (index >= mPositions.size())
+				mPositions.resize(mKeys.size(), NOT_QUEUED);
+			assert(!contains(index));
+
+			mHeap.push_back(index);
+			mPositions[index] = mHeap.size() - 1;
+			siftUp(mHeap.size() - 1);
+		}
+
+		bool contains(std::size_t index) const
+		{
+			return index < mPositions.size() && mPositions[index] != NOT_QUEUED;
+		}
+
+		// Call after lowering the key of a queued index.
+		void changePriority(std::size_t index)
+		{
+			assert(contains(index));
+			siftUp(mPositions[index]);
 		}
 
 		bool empty() const
 		{
-			return mPriorityQueue.empty();
+			return mHeap.empty();
 		}
 
-		size_t pop()
+		std::size_t size() const
 		{
-			size_t index = mPriorityQueue.top();
-			mPriorityQueue.pop();
-			return index;
+			return mHeap.size();
 		}
 
-		std::vector<size_t> popAll()
+		std::size_t pop()
 		{
-			std::vector<size_t> elems;
-			elems.reserve(mPriorityQueue.size());
-			while (!mPriorityQueue.empty())
+			assert(!empty());
+			std::size_t index = mHeap.front();
+			mPositions[index] = NOT_QUEUED;
+
+			std::size_t last = mHeap.back();
+			mHeap.pop_back();
+			if (!mHeap.empty())
 			{
-				elems.push_back(pop());
+				place(0, last);
+				siftDown(0);
 			}
-			return elems;
+			return index;
 		}
 
-		void assignElements(std::vector<size_t>&& elems)
+		// Empties the queue in time proportional to what is in it.
+		void clear()
 		{
-			mPriorityQueue = std::priority_queue<size_t, std::vector<size_t>, std::function<bool(size_t, size_t)>>(mCompare, std::move(elems));
+			for (std::size_t index : mHeap)
+				mPositions[index] = NOT_QUEUED;
+			mHeap.clear();
 		}
 
 	private:
-		std::function<bool(size_t, size_t)> mCompare;
-		std::priority_queue<size_t, std::vector<size_t>, std::function<bool(size_t, size_t)>> mPriorityQueue;
+		static const std::size_t NOT_QUEUED = static_cast<std::size_t>(-1);
+
+		bool less(std::size_t lhs, std::size_t rhs) const
+		{
+			return mKeys[lhs] < mKeys[rhs];
+		}
+
+		void place(std::size_t position, std::size_t index)
+		{
+			mHeap[position] = index;
+			mPositions[index] = position;
+		}
+
+		void siftUp(std::size_t position)
+		{
+			std::size_t index = mHeap[position];
+			while (position > 0)
+			{
+				std::size_t parent = (position - 1) / 2;
+				if (!less(index, mHeap[parent])) break;
+				place(position, mHeap[parent]);
+				position = parent;
+			}
+			place(position, index);
+		}
+
+		void siftDown(std::size_t position)
+		{
+			std::size_t index = mHeap[position];
+			std::size_t count = mHeap.size();
+			while (true)
+			{
+				std::size_t child = 2 * position + 1;
+				if (child >= count) break;
+				if (child + 1 < count && less(mHeap[child + 1], mHeap[child])) ++child;
+				if (!less(mHeap[child], index)) break;
+				place(position, mHeap[child]);
+				position = child;
+			}
+			place(position, index);
+		}
+
+		const std::vector<KeyType>& mKeys;
+		std::vector<std::size_t> mHeap;
+		// Where each index is in mHeap, or NOT_QUEUED.
+		std::vector<std::size_t> mPositions;
 	};
+
+	template <class KeyType>
+	const std::size_t IndexedPriorityQueue<KeyType>::NOT_QUEUED;
 }
 
 #endif
@@ -0,0 +1,333 @@
+#include "jump_point_search.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace te
+{
+	static int sign(int value)
+	{
+		return (value > 0) - (value < 0);
+	}
+
+	JumpPointSearch::JumpPointSearch(const WalkableGrid& grid, Moves moves)
+		: mGrid(grid)
+		, mMoves(moves)
+		, mDiagonalCost(std::sqrt(grid.getTileSize().x * grid.getTileSize().x + grid.getTileSize().y * grid.getTileSize().y))
+		, mGCosts(grid.getWidth() * grid.getHeight(), 0.f)
+		, mFCosts(grid.getWidth() * grid.getHeight(), 0.f)
+		, mParents(grid.getWidth() * grid.getHeight(), NO_PARENT)
+		, mClosed(grid.getWidth() * grid.getHeight(), false)
+		, mTouched()
+		, mNeighbours()
+		, mPQ(mFCosts)
+		, mSource(-1)
+		, mTarget(-1)
+		, mFound(false)
+	{}
+
+	bool JumpPointSearch::search(sf::Vector2i source, sf::Vector2i target)
+	{
+		begin(source, target);
+		return cycle(std::numeric_limits<int>::max()) == SearchStatus::FOUND;
+	}
+
+	void JumpPointSearch::begin(sf::Vector2i source, sf::Vector2i target)
+	{
+		reset();
+		mFound = false;
+		mSource = mTarget = -1;
+		if (!isWalkable(source.x, source.y) || !isWalkable(target.x, target.y)) return;
+
+		mSource = index(source.x, source.y);
+		mTarget = index(target.x, target.y);
+
+		mParents[mSource] = mSource;
+		mFCosts[mSource] = distance(mSource, mTarget);
+		mTouched.push_back(mSource);
+		mPQ.insert(mSource);
+	}
+
+	SearchStatus JumpPointSearch::cycle(int maxExpansions)
+	{
+		if (mFound) return SearchStatus::FOUND;
+
+		const int width = mGrid.getWidth();
+		for (int expansions = 0; !mPQ.empty(); ++expansions)
+		{
+			if (expansions == maxExpansions) return SearchStatus::INCOMPLETE;
+
+			int node = static_cast<int>(mPQ.pop());
+			mClosed[node] = true;
+			if (node == mTarget)
+			{
+				mFound = true;
+				return SearchStatus::FOUND;
+			}
+
+			findNeighbours(node, mNeighbours);
+			for (int neighbour : mNeighbours)
+			{
+				int x = node % width, y = node / width;
+				int nx = neighbour % width, ny = neighbour / width;
+				int jumpPoint = jump(nx, ny, nx - x, ny - y);
+				if (jumpPoint == NO_JUMP || mClosed[jumpPoint]) continue;
+
+				float newGCost = mGCosts[node] + distance(node, jumpPoint);
+				if (mParents[jumpPoint] == NO_PARENT)
+				{
+					mGCosts[jumpPoint] = newGCost;
+					mFCosts[jumpPoint] = newGCost + distance(jumpPoint, mTarget);
+					mParents[jumpPoint] = node;
+					mTouched.push_back(jumpPoint);
+					mPQ.insert(jumpPoint);
+				}
+				else if (newGCost < mGCosts[jumpPoint])
+				{
+					mFCosts[jumpPoint] -= mGCosts[jumpPoint] - newGCost;
+					mGCosts[jumpPoint] = newGCost;
+					mParents[jumpPoint] = node;
+					mPQ.changePriority(jumpPoint);
+				}
+			}
+		}
+		return SearchStatus::NOT_FOUND;
+	}
+
+	std::list<sf::Vector2i> JumpPointSearch::getPathToTarget() const
+	{
+		std::list<sf::Vector2i> path;
+		if (!mFound) return path;
+
+		const int width = mGrid.getWidth();
+		int node = mTarget;
+		path.push_back({ node % width, node / width });
+		while (node != mSource)
+		{
+			node = mParents[node];
+			path.push_back({ node % width, node / width });
+		}
+		return path;
+	}
+
+	float JumpPointSearch::getCostToTarget() const
+	{
+		return mFound ? mGCosts[mTarget] : -1.f;
+	}
+
+	std::size_t JumpPointSearch::getNodesTouched() const
+	{
+		return mTouched.size();
+	}
+
+	JumpPointSearch::Moves JumpPointSearch::getMoves() const
+	{
+		return mMoves;
+	}
+
+	void JumpPointSearch::reset()
+	{
+		for (int node : mTouched)
+		{
+			mGCosts[node] = 0.f;
+			mFCosts[node] = 0.f;
+			mParents[node] = NO_PARENT;
+			mClosed[node] = false;
+		}
+		mTouched.clear();
+		mPQ.clear();
+	}
+
+	// Octile distance, or Manhattan without diagonals. Jump points are in
+	// a straight or diagonal line from their parents, so this is also the
+	// cost of the step between them.
+	float JumpPointSearch::distance(int from, int to) const
+	{
+		const int width = mGrid.getWidth();
+		int dx = std::abs(from % width - to % width);
+		int dy = std::abs(from / width - to / width);
+		const sf::Vector2f tileSize = mGrid.getTileSize();
+		if (mMoves == Moves::STRAIGHT) return dx * tileSize.x + dy * tileSize.y;
+
+		int diagonal = std::min(dx, dy);
+		return diagonal * mDiagonalCost + (dx - diagonal) * tileSize.x + (dy - diagonal) * tileSize.y;
+	}
+
+	// The directions worth trying from node given the direction it was
+	// reached in. Everything else is reached at least as cheaply through
+	// the parent.
+	void JumpPointSearch::findNeighbours(int node, std::vector<int>& out) const
+	{
+		out.clear();
+		const int width = mGrid.getWidth();
+		const int x = node % width, y = node / width;
+		auto add = [&](int nx, int ny) { out.push_back(index(nx, ny)); };
+		auto addIfWalkable = [&](int nx, int ny) { if (isWalkable(nx, ny)) add(nx, ny); };
+
+		if (node == mSource)
+		{
+			for (int dy = -1; dy <= 1; ++dy)
+			{
+				for (int dx = -1; dx <= 1; ++dx)
+				{
+					if (!dx && !dy) continue;
+					bool diagonal = dx && dy;
+					if (diagonal && mMoves == Moves::STRAIGHT) continue;
+					if (diagonal && mMoves == Moves::DIAGONAL_NO_CORNER_CUTTING && !(isWalkable(x + dx, y) && isWalkable(x, y + dy))) continue;
+					addIfWalkable(x + dx, y + dy);
+				}
+			}
+			return;
+		}
+
+		const int parent = mParents[node];
+		const int dx = sign(x - parent % width), dy = sign(y - parent / width);
+
+		switch (mMoves)
+		{
+		case Moves::STRAIGHT:
+			if (dx)
+			{
+				addIfWalkable(x, y - 1);
+				addIfWalkable(x, y + 1);
+				addIfWalkable(x + dx, y);
+			}
+			else
+			{
+				addIfWalkable(x - 1, y);
+				addIfWalkable(x + 1, y);
+				addIfWalkable(x, y + dy);
+			}
+			break;
+
+		case Moves::DIAGONAL:
+			if (dx && dy)
+			{
+				addIfWalkable(x, y + dy);
+				addIfWalkable(x + dx, y);
+				addIfWalkable(x + dx, y + dy);
+				// Forced: the way round a blocked tile beside the path.
+				if (!isWalkable(x - dx, y)) addIfWalkable(x - dx, y + dy);
+				if (!isWalkable(x, y - dy)) addIfWalkable(x + dx, y - dy);
+			}
+			else if (dx)
+			{
+				addIfWalkable(x + dx, y);
+				if (!isWalkable(x, y + 1)) addIfWalkable(x + dx, y + 1);
+				if (!isWalkable(x, y - 1)) addIfWalkable(x + dx, y - 1);
+			}
+			else
+			{
+				addIfWalkable(x, y + dy);
+				if (!isWalkable(x + 1, y)) addIfWalkable(x + 1, y + dy);
+				if (!isWalkable(x - 1, y)) addIfWalkable(x - 1, y + dy);
+			}
+			break;
+
+		case Moves::DIAGONAL_NO_CORNER_CUTTING:
+			if (dx && dy)
+			{
+				bool vertical = isWalkable(x, y + dy), horizontal = isWalkable(x + dx, y);
+				if (vertical) add(x, y + dy);
+				if (horizontal) add(x + dx, y);
+				if (vertical && horizontal) addIfWalkable(x + dx, y + dy);
+			}
+			else if (dx)
+			{
+				bool next = isWalkable(x + dx, y), below = isWalkable(x, y + 1), above = isWalkable(x, y - 1);
+				if (next)
+				{
+					add(x + dx, y);
+					if (below) addIfWalkable(x + dx, y + 1);
+					if (above) addIfWalkable(x + dx, y - 1);
+				}
+				if (below) add(x, y + 1);
+				if (above) add(x, y - 1);
+			}
+			else
+			{
+				bool next = isWalkable(x, y + dy), right = isWalkable(x + 1, y), left = isWalkable(x - 1, y);
+				if (next)
+				{
+					add(x, y + dy);
+					if (right) addIfWalkable(x + 1, y + dy);
+					if (left) addIfWalkable(x - 1, y + dy);
+				}
+				if (right) add(x + 1, y);
+				if (left) add(x - 1, y);
+			}
+			break;
+		}
+	}
+
+	int JumpPointSearch::jump(int x, int y, int dx, int dy) const
+	{
+		for (;; x += dx, y += dy)
+		{
+			if (!isWalkable(x, y)) return NO_JUMP;
+			const int node = index(x, y);
+			if (node == mTarget) return node;
+
+			switch (mMoves)
+			{
+			case Moves::STRAIGHT:
+				if (dx)
+				{
+					if ((isWalkable(x, y - 1) && !isWalkable(x - dx, y - 1)) || (isWalkable(x, y + 1) && !isWalkable(x - dx, y + 1)))
+						return node;
+				}
+				else
+				{
+					if ((isWalkable(x - 1, y) && !isWalkable(x - 1, y - dy)) || (isWalkable(x + 1, y) && !isWalkable(x + 1, y - dy)))
+						return node;
+					// Turning is the only way to a target off this column.
+					if (jump(x + 1, y, 1, 0) != NO_JUMP || jump(x - 1, y, -1, 0) != NO_JUMP)
+						return node;
+				}
+				break;
+
+			case Moves::DIAGONAL:
+				if (dx && dy)
+				{
+					if ((isWalkable(x - dx, y + dy) && !isWalkable(x - dx, y)) || (isWalkable(x + dx, y - dy) && !isWalkable(x, y - dy)))
+						return node;
+					if (jump(x + dx, y, dx, 0) != NO_JUMP || jump(x, y + dy, 0, dy) != NO_JUMP)
+						return node;
+				}
+				else if (dx)
+				{
+					if ((isWalkable(x + dx, y + 1) && !isWalkable(x, y + 1)) || (isWalkable(x + dx, y - 1) && !isWalkable(x, y - 1)))
+						return node;
+				}
+				else
+				{
+					if ((isWalkable(x + 1, y + dy) && !isWalkable(x + 1, y)) || (isWalkable(x - 1, y + dy) && !isWalkable(x - 1, y)))
+						return node;
+				}
+				break;
+
+			case Moves::DIAGONAL_NO_CORNER_CUTTING:
+				if (dx && dy)
+				{
+					if (jump(x + dx, y, dx, 0) != NO_JUMP || jump(x, y + dy, 0, dy) != NO_JUMP)
+						return node;
+					if (!isWalkable(x + dx, y) || !isWalkable(x, y + dy))
+						return NO_JUMP;
+				}
+				else if (dx)
+				{
+					if ((isWalkable(x, y - 1) && !isWalkable(x - dx, y - 1)) || (isWalkable(x, y + 1) && !isWalkable(x - dx, y + 1)))
+						return node;
+				}
+				else
+				{
+					if ((isWalkable(x - 1, y) && !isWalkable(x - 1, y - dy)) || (isWalkable(x + 1, y) && !isWalkable(x + 1, y - dy)))
+						return node;
+				}
+				break;
+			}
+		}
+	}
+}
@@ -0,0 +1,83 @@
+#ifndef TE_JUMP_POINT_SEARCH_H
+#define TE_JUMP_POINT_SEARCH_H
+
+#include "walkable_grid.h"
+#include "indexed_priority_queue.h"
+#include "search_status.h"
+
+#include <list>
+#include <vector>
+
+namespace te
+{
+	// A* over a WalkableGrid that skips along straight and diagonal lines
+	// until something forces a turn, so only the tiles where a path may
+	// change direction go through the open list. Paths are as short as
+	// plain A* over the same moves. Keeps its buffers between searches
+	// like GraphSearchAStar.
+	class JumpPointSearch
+	{
+	public:
+		enum class Moves
+		{
+			// Up, down, left and right only.
+			STRAIGHT,
+			// Diagonals too, even squeezing between two blocked tiles, as
+			// TMX::makeNavGraph links them.
+			DIAGONAL,
+			// Diagonals only past two walkable tiles.
+			DIAGONAL_NO_CORNER_CUTTING
+		};
+
+		explicit JumpPointSearch(const WalkableGrid& grid, Moves moves = Moves::DIAGONAL);
+
+		// Returns whether target was reached.
+		bool search(sf::Vector2i source, sf::Vector2i target);
+		// Starts a search for cycle to carry out in steps.
+		void begin(sf::Vector2i source, sf::Vector2i target);
+		// Expands at most maxExpansions more jump points of the search begun.
+		SearchStatus cycle(int maxExpansions);
+
+		// The jump points from target back to source, like
+		// GraphSearchAStar. Each is in a straight or diagonal line from the
+		// one before.
+		std::list<sf::Vector2i> getPathToTarget() const;
+		float getCostToTarget() const;
+		// Tiles the last search put on the open list.
+		std::size_t getNodesTouched() const;
+
+		Moves getMoves() const;
+
+	private:
+		JumpPointSearch(const JumpPointSearch&) = delete;
+		JumpPointSearch& operator=(const JumpPointSearch&) = delete;
+
+		enum { NO_PARENT = -1, NO_JUMP = -1 };
+
+		void reset();
+		bool isWalkable(int x, int y) const { return mGrid.isWalkable(x, y); }
+		int index(int x, int y) const { return y * mGrid.getWidth() + x; }
+		float distance(int from, int to) const;
+
+		void findNeighbours(int node, std::vector<int>& out) const;
+		// The next jump point from x, y heading dx, dy, or NO_JUMP.
+		int jump(int x, int y, int dx, int dy) const;
+
+		const WalkableGrid& mGrid;
+		Moves mMoves;
+		float mDiagonalCost;
+
+		std::vector<float> mGCosts;
+		std::vector<float> mFCosts;
+		std::vector<int> mParents;
+		std::vector<bool> mClosed;
+		std::vector<int> mTouched;
+		std::vector<int> mNeighbours;
+		IndexedPriorityQueue<float> mPQ;
+		int mSource;
+		int mTarget;
+		bool mFound;
+	};
+}
+
+#endif
@@ -0,0 +1,111 @@
+#include "line_of_sight.h"
+#include "walkable_grid.h"
+#include "../TantechEngine/job_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace te
+{
+	// Fewest queries handed to a job.
+	static const std::size_t QUERY_GRAIN = 256;
+
+	// Amanatides and Woo's traversal of the tiles a segment crosses, in
+	// tile units.
+	static bool traverse(const WalkableGrid& grid, sf::Vector2f from, sf::Vector2f to)
+	{
+		int x = static_cast<int>(std::floor(from.x)), y = static_cast<int>(std::floor(from.y));
+		const int endX = static_cast<int>(std::floor(to.x)), endY = static_cast<int>(std::floor(to.y));
+		if (!grid.isWalkable(x, y)) return false;
+
+		const float dx = to.x - from.x, dy = to.y - from.y;
+		const int stepX = dx > 0.f ? 1 : -1, stepY = dy > 0.f ? 1 : -1;
+		const float infinity = std::numeric_limits<float>::infinity();
+		// How far along the segment each step takes, and where the next
+		// tile boundary on each axis is.
+		const float deltaX = dx != 0.f ? std::abs(1.f / dx) : infinity;
+		const float deltaY = dy != 0.f ? std::abs(1.f / dy) : infinity;
+		float maxX = dx != 0.f ? ((stepX > 0 ? x + 1 - from.x : from.x - x) * deltaX) : infinity;
+		float maxY = dy != 0.f ? ((stepY > 0 ? y + 1 - from.y : from.y - y) * deltaY) : infinity;
+
+		while (x != endX || y != endY)
+		{
+			if (maxX < maxY)
+			{
+				if (maxX > 1.f) break;
+				x += stepX;
+				maxX += deltaX;
+			}
+			else if (maxY < maxX)
+			{
+				if (maxY > 1.f) break;
+				y += stepY;
+				maxY += deltaY;
+			}
+			else
+			{
+				if (maxX > 1.f) break;
+				if (!grid.isWalkable(x + stepX, y) || !grid.isWalkable(x, y + stepY)) return false;
+				x += stepX;
+				y += stepY;
+				maxX += deltaX;
+				maxY += deltaY;
+			}
+			if (!grid.isWalkable(x, y)) return false;
+		}
+		return true;
+	}
+
+	// Every tile under a box of half size extent, in tile units, moved
+	// along the segment. The swept box is convex, so each row of tiles it
+	// covers is one run, found from the part of the segment whose box
+	// reaches the row.
+	static bool sweep(const WalkableGrid& grid, sf::Vector2f from, sf::Vector2f to, sf::Vector2f extent)
+	{
+		const float dx = to.x - from.x, dy = to.y - from.y;
+		const int firstRow = static_cast<int>(std::floor(std::min(from.y, to.y) - extent.y));
+		const int endRow = static_cast<int>(std::ceil(std::max(from.y, to.y) + extent.y));
+
+		for (int row = firstRow; row < endRow; ++row)
+		{
+			float t0 = 0.f, t1 = 1.f;
+			if (dy != 0.f)
+			{
+				float enter = (row - extent.y - from.y) / dy, leave = (row + 1 + extent.y - from.y) / dy;
+				if (enter > leave) std::swap(enter, leave);
+				t0 = std::max(t0, enter);
+				t1 = std::min(t1, leave);
+				if (t0 > t1) continue;
+			}
+
+			float x0 = from.x + t0 * dx, x1 = from.x + t1 * dx;
+			const int firstColumn = static_cast<int>(std::floor(std::min(x0, x1) - extent.x));
+			const int endColumn = static_cast<int>(std::ceil(std::max(x0, x1) + extent.x));
+			for (int column = firstColumn; column < endColumn; ++column)
+			{
+				if (!grid.isWalkable(column, row)) return false;
+			}
+		}
+		return true;
+	}
+
+	bool hasLineOfSight(const WalkableGrid& grid, sf::Vector2f from, sf::Vector2f to, float radius)
+	{
+		const sf::Vector2f origin = grid.getOrigin(), tileSize = grid.getTileSize();
+		sf::Vector2f a((from.x - origin.x) / tileSize.x, (from.y - origin.y) / tileSize.y);
+		sf::Vector2f b((to.x - origin.x) / tileSize.x, (to.y - origin.y) / tileSize.y);
+
+		if (radius <= 0.f) return traverse(grid, a, b);
+		return sweep(grid, a, b, { radius / tileSize.x, radius / tileSize.y });
+	}
+
+	void testLinesOfSight(const WalkableGrid& grid, const std::vector<SightQuery>& queries, std::vector<uint8_t>& results, JobPool* pPool)
+	{
+		results.assign(queries.size(), 0);
+		parallelFor(pPool, 0, queries.size(), QUERY_GRAIN, [&grid, &queries, &results](std::size_t first, std::size_t end) {
+			for (std::size_t i = first; i < end; ++i)
+				results[i] = hasLineOfSight(grid, queries[i].from, queries[i].to, queries[i].radius) ? 1 : 0;
+		});
+	}
+}
@@ -0,0 +1,37 @@
+#ifndef TE_LINE_OF_SIGHT_H
+#define TE_LINE_OF_SIGHT_H
+
+#include <SFML/System/Vector2.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace te
+{
+	class JobPool;
+	class WalkableGrid;
+
+	struct SightQuery
+	{
+		sf::Vector2f from;
+		sf::Vector2f to;
+		float radius = 0.f;
+	};
+
+	// Whether something can go in a straight line from one point to the
+	// other over walkable tiles only. With no radius the tiles the segment
+	// crosses are walked one by one; touching a corner counts as crossing
+	// both tiles beside it. With a radius the tiles under a square of that
+	// half size swept along the segment are checked a row at a time, which
+	// errs on the side of calling it blocked. Tiles off the grid are
+	// blocked, and so are tiles shut with TileMap::setAreaWalkable or
+	// under disabled nav nodes.
+	bool hasLineOfSight(const WalkableGrid& grid, sf::Vector2f from, sf::Vector2f to, float radius = 0.f);
+
+	// Fills results with one entry per query, in the same order, 1 where
+	// there is line of sight. Large batches are spread over pPool when
+	// given; the grid must not change meanwhile.
+	void testLinesOfSight(const WalkableGrid& grid, const std::vector<SightQuery>& queries, std::vector<uint8_t>& results, JobPool* pPool = nullptr);
+}
+
+#endif
@@ -3,12 +3,14 @@
 #include "game_data.h"
 #include "manager_runner.h"
 #include "scripting.h"
+#include "../TantechEngine/asset_pack.h"
 
 #include <SFML/System.hpp>
 #include <lua.hpp>
 #include <LuaBridge.h>
 
 #include <Windows.h>
+#include <fstream>
 #include <iostream>
 
 int main(int argc, char* argv[])
@@ -17,6 +19,14 @@ int main(int argc, char* argv[])
 	{
 		using namespace te;
 
+		// Read from the pack built by tools/pack_assets.pl when there is one,
+		// anything missing from it still loads from loose files. Debug builds
+		// read loose files first, so edits show up without repacking.
+		if (std::ifstream{"assets.pak"})
+		{
+			mountAssetPack(std::make_shared<AssetPack>("assets.pak"));
+		}
+
 		GameData gameData;
 		ManagerRunner runner{ gameData };
 		ScriptInit scriptInit{ gameData };
@@ -46,11 +56,17 @@ int main(int argc, char* argv[])
 
 				runner.fixedUpdate(timePerFrame);
 			}
+			runner.physicsUpdate(dt);
 
 			runner.renderUpdate();
 			gameData.pWindow->display();
+			gameData.textureHolder.nextFrame();
 		}
 
+		ResidencyStats textureStats = gameData.textureHolder.getStats();
+		std::clog << "Textures: " << textureStats.residentCount << " resident in " << textureStats.residentBytes / 1024 << " KB"
+			<< " (budget " << textureStats.budgetBytes / 1024 << " KB), "
+			<< textureStats.evictions << " evictions, " << textureStats.reloads << " reloads" << std::endl;
 		return 0;
 	}
 	catch (const luabridge::LuaException& ex)
@@ -8,8 +8,11 @@
 
 namespace te
 {
+	static const EntityID PLAYER_ID = 0;
+
 	struct ManagerRunner::Impl
 	{
+		decltype(GameData::contactEvents)& contactEvents;
 		InputManager inputManager;
 		PlayerManager playerManager;
 		PhysicsWorldManager physicsManager;
@@ -19,12 +22,13 @@ namespace te
 		DrawManager drawManager;
 
 		Impl(GameData& data)
-			: inputManager(data.directionInput)
-			, playerManager(0, data.directionInput, data.velocities)
-			, physicsManager(data.physicsWorld, data.rigidBodies, data.positions)
+			: contactEvents(data.contactEvents)
+			, inputManager(data.directionInput)
+			, playerManager(PLAYER_ID, data.directionInput, data.velocities)
+			, physicsManager(data.physicsRegions, data.rigidBodies, data.positions, data.previousPositions, data.contactEvents, data.config.physics, PLAYER_ID)
 			, velocityManager(data.velocities, data.rigidBodies, data.positions)
-			, spriteRenderManager(data.sprites, data.positions, data.pendingDraws)
-			, layerRenderManager(data.mapLayers, data.positions, data.pendingDraws)
+			, spriteRenderManager(data.sprites, data.positions, data.previousPositions, data.pendingDraws)
+			, layerRenderManager(data.mapLayers, data.positions, data.previousPositions, data.pendingDraws)
 			, drawManager(data.pixelToWorldScale, data.mainView, data.pendingDraws, *data.pWindow)
 		{}
 	};
@@ -42,13 +46,20 @@ namespace te
 		m_pImpl->inputManager.update();
 		m_pImpl->playerManager.update();
 		m_pImpl->velocityManager.update(dt);
-		m_pImpl->physicsManager.update(dt);
+		// Every fixed update sees the contacts since the one before it.
+		m_pImpl->contactEvents.clear();
+	}
+
+	void ManagerRunner::physicsUpdate(const sf::Time& elapsed)
+	{
+		m_pImpl->physicsManager.update(elapsed);
 	}
 
 	void ManagerRunner::renderUpdate()
 	{
-		m_pImpl->spriteRenderManager.update();
-		m_pImpl->layerRenderManager.update();
+		float interpolation = m_pImpl->physicsManager.getInterpolation();
+		m_pImpl->spriteRenderManager.update(interpolation);
+		m_pImpl->layerRenderManager.update(interpolation);
 		m_pImpl->drawManager.update();
 	}
 }
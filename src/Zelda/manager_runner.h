@@ -22,6 +22,9 @@ namespace te
 		~ManagerRunner();
 
 		void fixedUpdate(const sf::Time& dt);
+		// Physics keeps its own fixed rate, so this takes the real time
+		// since it was last called.
+		void physicsUpdate(const sf::Time& elapsed);
 		void renderUpdate();
 	private:
 		struct Impl;
@@ -0,0 +1,132 @@
+#include "nav_graph_baking.h"
+#include "compact_nav_graph.h"
+#include "walkable_grid.h"
+#include "../TantechEngine/job_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace te
+{
+	static const int NO_NODE = -1;
+	// Fewest tiles handed to a job.
+	static const int MIN_TILES_PER_JOB = 4096;
+
+	CompactNavGraph* makeTileNavGraph(const WalkableGrid& grid, JobPool* pPool)
+	{
+		const int width = grid.getWidth(), height = grid.getHeight();
+		const std::size_t rowGrain = std::max(MIN_TILES_PER_JOB / std::max(width, 1), 1);
+
+		// Number the tiles the way the old flood fill did: outward from
+		// the first walkable tile, trying right, left, down and up.
+		std::vector<int> nodeOfTile(width * height, NO_NODE);
+		std::vector<int> tileOfNode;
+		for (int tile = 0; tile < width * height; ++tile)
+		{
+			if (!grid.isWalkable(tile % width, tile / width)) continue;
+			nodeOfTile[tile] = 0;
+			tileOfNode.push_back(tile);
+			break;
+		}
+		const int steps[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+		for (std::size_t next = 0; next < tileOfNode.size(); ++next)
+		{
+			int x = tileOfNode[next] % width, y = tileOfNode[next] / width;
+			for (const auto& step : steps)
+			{
+				int nx = x + step[0], ny = y + step[1];
+				if (!grid.isWalkable(nx, ny) || nodeOfTile[ny * width + nx] != NO_NODE) continue;
+				nodeOfTile[ny * width + nx] = static_cast<int>(tileOfNode.size());
+				tileOfNode.push_back(ny * width + nx);
+			}
+		}
+
+		const int count = static_cast<int>(tileOfNode.size());
+		std::vector<float> xs(count), ys(count);
+		std::vector<int> offsets(count + 1, 0);
+
+		// The nodes of the eight tiles around a tile, lowest first.
+		auto findNeighbours = [&](int x, int y, int* out) {
+			int found = 0;
+			for (int dy = -1; dy <= 1; ++dy)
+			{
+				for (int dx = -1; dx <= 1; ++dx)
+				{
+					int nx = x + dx, ny = y + dy;
+					if ((!dx && !dy) || nx < 0 || ny < 0 || nx >= width || ny >= height) continue;
+					int neighbour = nodeOfTile[ny * width + nx];
+					if (neighbour != NO_NODE) out[found++] = neighbour;
+				}
+			}
+			std::sort(out, out + found);
+			return found;
+		};
+
+		// Degrees first, so every node knows where its edges start.
+		parallelFor(pPool, 0, height, rowGrain, [&](std::size_t firstRow, std::size_t endRow) {
+			int neighbours[8];
+			for (int y = (int)firstRow; y < (int)endRow; ++y)
+			{
+				for (int x = 0; x < width; ++x)
+				{
+					int node = nodeOfTile[y * width + x];
+					if (node == NO_NODE) continue;
+
+					sf::Vector2f position = grid.getTileCenter({ x, y });
+					xs[node] = position.x;
+					ys[node] = position.y;
+					offsets[node + 1] = findNeighbours(x, y, neighbours);
+				}
+			}
+		});
+		for (int node = 0; node < count; ++node)
+		{
+			offsets[node + 1] += offsets[node];
+		}
+
+		std::vector<int> targets(offsets[count]);
+		std::vector<float> costs(offsets[count]);
+		parallelFor(pPool, 0, height, rowGrain, [&](std::size_t firstRow, std::size_t endRow) {
+			int neighbours[8];
+			for (int y = (int)firstRow; y < (int)endRow; ++y)
+			{
+				for (int x = 0; x < width; ++x)
+				{
+					int node = nodeOfTile[y * width + x];
+					if (node == NO_NODE) continue;
+
+					int found = findNeighbours(x, y, neighbours);
+					for (int i = 0; i < found; ++i)
+					{
+						float dx = xs[node] - xs[neighbours[i]], dy = ys[node] - ys[neighbours[i]];
+						targets[offsets[node] + i] = neighbours[i];
+						costs[offsets[node] + i] = std::sqrt(dx * dx + dy * dy);
+					}
+				}
+			}
+		});
+
+		return new CompactNavGraph(std::move(xs), std::move(ys), std::move(offsets), std::move(targets), std::move(costs));
+	}
+
+	SparseGraph<NavGraphNode, NavGraphEdge>* makeSparseNavGraph(const CompactNavGraph& graph)
+	{
+		SparseGraph<NavGraphNode, NavGraphEdge>* pGraph = new SparseGraph<NavGraphNode, NavGraphEdge>();
+		for (int node = 0; node < graph.numNodes(); ++node)
+		{
+			NavGraphNode navNode;
+			navNode.setPosition(graph.getPosition(node));
+			pGraph->addNode(navNode);
+		}
+		for (int node = 0; node < graph.numNodes(); ++node)
+		{
+			const float* pCost = graph.costsBegin(node);
+			for (const int* pTarget = graph.targetsBegin(node); pTarget != graph.targetsEnd(node); ++pTarget, ++pCost)
+			{
+				pGraph->addHalfEdge(NavGraphEdge(node, *pTarget, *pCost));
+			}
+		}
+		return pGraph;
+	}
+}
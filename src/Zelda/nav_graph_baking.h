@@ -0,0 +1,25 @@
+#ifndef TE_NAV_GRAPH_BAKING_H
+#define TE_NAV_GRAPH_BAKING_H
+
+#include "sparse_graph.h"
+
+namespace te
+{
+	class CompactNavGraph;
+	class JobPool;
+	class WalkableGrid;
+
+	// The tile nav graph of a map, straight from its walkable tiles: a node
+	// at the centre of each walkable tile reachable from the first one in
+	// row order by steps up, down, left and right, numbered in the order a
+	// breadth first search from there reaches them, and linked to the
+	// nodes on the eight tiles around it. Each node's edges are in order of
+	// the node they lead to. The edges of blocks of rows are worked out on
+	// pPool when given.
+	CompactNavGraph* makeTileNavGraph(const WalkableGrid& grid, JobPool* pPool = nullptr);
+
+	// A SparseGraph with the same nodes and edges in the same order.
+	SparseGraph<NavGraphNode, NavGraphEdge>* makeSparseNavGraph(const CompactNavGraph& graph);
+}
+
+#endif
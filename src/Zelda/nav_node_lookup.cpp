@@ -0,0 +1,168 @@
+#include "nav_node_lookup.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace te
+{
+	static const int UNREACHED = std::numeric_limits<int>::max();
+
+	NavNodeLookup::NavNodeLookup(const WalkableGrid& grid, const CompactNavGraph& graph, JumpPointSearch::Moves moves)
+		: mGrid(grid)
+		, mGraph(graph)
+		, mMoves(moves)
+		, mNodes(grid.getWidth() * grid.getHeight(), NO_NODE)
+		, mSteps(grid.getWidth() * grid.getHeight(), UNREACHED)
+		, mTileOfNode(graph.numNodes(), NO_NODE)
+	{
+		std::vector<Step> queue;
+		for (int node = 0; node < mGraph.numNodes(); ++node)
+		{
+			sf::Vector2i tile = mGrid.getTile(mGraph.getPosition(node));
+			if (!mGrid.isWalkable(tile.x, tile.y)) continue;
+
+			int index = tile.y * mGrid.getWidth() + tile.x;
+			mTileOfNode[node] = index;
+			if (mGraph.isActive(node) && mNodes[index] == NO_NODE)
+			{
+				mNodes[index] = node;
+				mSteps[index] = 0;
+				queue.push_back({ 0, index });
+			}
+		}
+		flood(queue);
+	}
+
+	int NavNodeLookup::getNode(sf::Vector2f position) const
+	{
+		sf::Vector2i tile = mGrid.getTile(position);
+		if (mGrid.isWalkable(tile.x, tile.y))
+		{
+			return mNodes[tile.y * mGrid.getWidth() + tile.x];
+		}
+
+		int closestNode = NO_NODE;
+		float closestSoFar = std::numeric_limits<float>::max();
+		for (int y = tile.y - 1; y <= tile.y + 1; ++y)
+		{
+			for (int x = tile.x - 1; x <= tile.x + 1; ++x)
+			{
+				if (!mGrid.isWalkable(x, y)) continue;
+				int node = mNodes[y * mGrid.getWidth() + x];
+				if (node == NO_NODE) continue;
+
+				sf::Vector2f offset = mGrid.getTileCenter({ x, y }) - position;
+				float dist = offset.x * offset.x + offset.y * offset.y;
+				if (dist < closestSoFar)
+				{
+					closestSoFar = dist;
+					closestNode = node;
+				}
+			}
+		}
+		return closestNode;
+	}
+
+	void NavNodeLookup::update(const std::vector<int>& changedNodes)
+	{
+		const int width = mGrid.getWidth();
+		std::vector<int> cleared;
+		std::vector<Step> queue;
+
+		for (int node : changedNodes)
+		{
+			int tile = mTileOfNode[node];
+			if (tile == NO_NODE) continue;
+
+			if (mGraph.isActive(node))
+			{
+				// It takes over whatever tiles it is nearer to.
+				if (mSteps[tile] > 0)
+				{
+					mNodes[tile] = node;
+					mSteps[tile] = 0;
+					queue.push_back({ 0, tile });
+				}
+				continue;
+			}
+
+			// The tiles a node was nearest to are connected, so they are
+			// found without looking at the rest of the map.
+			if (mNodes[tile] != node) continue;
+			std::size_t first = cleared.size();
+			mNodes[tile] = NO_NODE;
+			mSteps[tile] = UNREACHED;
+			cleared.push_back(tile);
+			for (std::size_t i = first; i < cleared.size(); ++i)
+			{
+				int x = cleared[i] % width, y = cleared[i] / width;
+				for (int dy = -1; dy <= 1; ++dy)
+				{
+					for (int dx = -1; dx <= 1; ++dx)
+					{
+						if ((!dx && !dy) || !canStep(x, y, dx, dy)) continue;
+						int neighbour = (y + dy) * width + x + dx;
+						if (mNodes[neighbour] != node) continue;
+						mNodes[neighbour] = NO_NODE;
+						mSteps[neighbour] = UNREACHED;
+						cleared.push_back(neighbour);
+					}
+				}
+			}
+		}
+
+		// The tiles left around the cleared ones spread back into them.
+		for (int tile : cleared)
+		{
+			int x = tile % width, y = tile / width;
+			for (int dy = -1; dy <= 1; ++dy)
+			{
+				for (int dx = -1; dx <= 1; ++dx)
+				{
+					if ((!dx && !dy) || !canStep(x, y, dx, dy)) continue;
+					int neighbour = (y + dy) * width + x + dx;
+					if (mNodes[neighbour] != NO_NODE) queue.push_back({ mSteps[neighbour], neighbour });
+				}
+			}
+		}
+		flood(queue);
+	}
+
+	bool NavNodeLookup::canStep(int x, int y, int dx, int dy) const
+	{
+		if (!mGrid.isWalkable(x + dx, y + dy)) return false;
+		if (!dx || !dy) return true;
+		if (mMoves == JumpPointSearch::Moves::STRAIGHT) return false;
+		if (mMoves == JumpPointSearch::Moves::DIAGONAL_NO_CORNER_CUTTING) return mGrid.isWalkable(x + dx, y) && mGrid.isWalkable(x, y + dy);
+		return true;
+	}
+
+	void NavNodeLookup::flood(std::vector<Step>& queue)
+	{
+		const int width = mGrid.getWidth();
+		std::priority_queue<Step, std::vector<Step>, std::greater<Step>> open(std::greater<Step>(), std::move(queue));
+		while (!open.empty())
+		{
+			Step step = open.top();
+			open.pop();
+			if (step.first > mSteps[step.second]) continue;
+
+			int x = step.second % width, y = step.second / width;
+			for (int dy = -1; dy <= 1; ++dy)
+			{
+				for (int dx = -1; dx <= 1; ++dx)
+				{
+					if ((!dx && !dy) || !canStep(x, y, dx, dy)) continue;
+					int neighbour = (y + dy) * width + x + dx;
+					if (step.first + 1 >= mSteps[neighbour]) continue;
+
+					mSteps[neighbour] = step.first + 1;
+					mNodes[neighbour] = mNodes[step.second];
+					open.push({ step.first + 1, neighbour });
+				}
+			}
+		}
+	}
+}
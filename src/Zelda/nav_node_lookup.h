@@ -0,0 +1,58 @@
+#ifndef TE_NAV_NODE_LOOKUP_H
+#define TE_NAV_NODE_LOOKUP_H
+
+#include "compact_nav_graph.h"
+#include "walkable_grid.h"
+#include "jump_point_search.h"
+
+#include <SFML/System/Vector2.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace te
+{
+	// The nav graph node nearest to each tile of a map, by walking over the
+	// walkable tiles, worked out once with a breadth first search outward
+	// from every active node at the same time. Looking up the node for a
+	// position is then a table read instead of a neighbourhood query with
+	// a line of sight test per candidate.
+	class NavNodeLookup
+	{
+	public:
+		enum { NO_NODE = -1 };
+
+		NavNodeLookup(const WalkableGrid& grid, const CompactNavGraph& graph, JumpPointSearch::Moves moves = JumpPointSearch::Moves::DIAGONAL);
+
+		// The nearest node reachable from position, or NO_NODE. A position
+		// on a blocked tile goes by the nearest walkable tile around it.
+		int getNode(sf::Vector2f position) const;
+
+		// Call after nodes have been turned on or off in the nav graph. Only
+		// the tiles that were nearest to them are searched again.
+		void update(const std::vector<int>& changedNodes);
+
+	private:
+		NavNodeLookup(const NavNodeLookup&) = delete;
+		NavNodeLookup& operator=(const NavNodeLookup&) = delete;
+
+		typedef std::pair<int, int> Step;
+
+		bool canStep(int x, int y, int dx, int dy) const;
+		// Spreads the nodes from the tiles queued, nearest first, to every
+		// tile they are nearer to than its node so far.
+		void flood(std::vector<Step>& queue);
+
+		const WalkableGrid& mGrid;
+		const CompactNavGraph& mGraph;
+		JumpPointSearch::Moves mMoves;
+
+		// Per tile, its nearest node and how many steps away it is.
+		std::vector<int> mNodes;
+		std::vector<int> mSteps;
+		// Per node, the tile it is on, or NO_NODE when that is off the grid.
+		std::vector<int> mTileOfNode;
+	};
+}
+
+#endif
@@ -0,0 +1,128 @@
+#include "path_manager.h"
+#include "path_planner.h"
+#include "message_dispatcher.h"
+#include "moving_entity.h"
+
+#include <SFML/System/Clock.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace te
+{
+	PathManager::PathManager(MessageDispatcher& dispatcher, Mode mode, int expansionsPerSlice, sf::Time budget)
+		: mDispatcher(dispatcher)
+		, mMode(mode)
+		, mExpansionsPerSlice(std::max(expansionsPerSlice, 1))
+		, mBudget(budget)
+		, mRequests()
+		, mNext(0)
+	{}
+
+	PathManager::~PathManager()
+	{
+		for (auto& request : mRequests)
+		{
+			if (request.result.valid()) request.result.wait();
+		}
+	}
+
+	void PathManager::request(PathPlanner& planner, SearchStatus status)
+	{
+		cancel(planner);
+
+		Request request{ &planner, status, std::future<SearchStatus>() };
+		if (mMode == Mode::THREADED && status == SearchStatus::INCOMPLETE)
+		{
+			PathPlanner* pPlanner = &planner;
+			request.result = std::async(std::launch::async, [pPlanner]() {
+				return pPlanner->cycleSearch(std::numeric_limits<int>::max());
+			});
+		}
+		mRequests.push_back(std::move(request));
+	}
+
+	void PathManager::cancel(PathPlanner& planner)
+	{
+		auto found = std::find_if(mRequests.begin(), mRequests.end(), [&planner](const Request& request) {
+			return request.pPlanner == &planner;
+		});
+		if (found == mRequests.end()) return;
+
+		if (found->result.valid()) found->result.wait();
+		std::size_t index = found - mRequests.begin();
+		mRequests.erase(found);
+		if (mNext > index) --mNext;
+	}
+
+	void PathManager::update()
+	{
+		sf::Clock clock;
+
+		// Threaded searches are checked without waiting.
+		for (auto& request : mRequests)
+		{
+			if (request.status == SearchStatus::INCOMPLETE && request.result.valid() &&
+				request.result.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+			{
+				request.status = request.result.get();
+			}
+		}
+
+		// Time sliced ones get a slice each in turn while there is time
+		// left, picking up next update where this one stopped.
+		if (mNext >= mRequests.size()) mNext = 0;
+		std::size_t idle = 0;
+		while (idle < mRequests.size() && clock.getElapsedTime() < mBudget)
+		{
+			Request& request = mRequests[mNext];
+			mNext = (mNext + 1) % mRequests.size();
+			if (request.status != SearchStatus::INCOMPLETE || request.result.valid())
+			{
+				++idle;
+				continue;
+			}
+			idle = 0;
+			request.status = request.pPlanner->cycleSearch(mExpansionsPerSlice);
+		}
+
+		// Owners may ask for new paths when told, so the finished requests
+		// are taken off before anyone hears of them.
+		std::vector<std::pair<PathPlanner*, SearchStatus>> finished;
+		for (auto& request : mRequests)
+		{
+			if (request.status != SearchStatus::INCOMPLETE) finished.push_back({ request.pPlanner, request.status });
+		}
+		mRequests.erase(std::remove_if(mRequests.begin(), mRequests.end(), [](const Request& request) {
+			return request.status != SearchStatus::INCOMPLETE;
+		}), mRequests.end());
+		if (mNext >= mRequests.size()) mNext = 0;
+
+		for (const auto& done : finished)
+		{
+			notify(*done.first, done.second);
+		}
+	}
+
+	std::size_t PathManager::numRequests() const
+	{
+		return mRequests.size();
+	}
+
+	PathManager::Mode PathManager::getMode() const
+	{
+		return mMode;
+	}
+
+	void PathManager::setMode(Mode mode)
+	{
+		mMode = mode;
+	}
+
+	void PathManager::notify(PathPlanner& planner, SearchStatus status)
+	{
+		planner.finishSearch(status);
+		mDispatcher.dispatchMessage(0.0, -1, planner.mOwner.getID(), status == SearchStatus::FOUND ? PathReady : NoPathAvailable);
+	}
+}
@@ -0,0 +1,85 @@
+#ifndef TE_PATH_MANAGER_H
+#define TE_PATH_MANAGER_H
+
+#include "search_status.h"
+
+#include <SFML/System/Time.hpp>
+
+#include <future>
+#include <vector>
+
+namespace te
+{
+	class MessageDispatcher;
+	class PathPlanner;
+
+	// Runs the searches PathPlanner::requestPathToPosition asks for so that
+	// many agents planning on the same tick do not stall the frame. Each
+	// update hands the waiting searches a slice of expansions in turn until
+	// the frame's budget is spent. With Mode::THREADED every search instead
+	// runs to the end on a thread of its own, and update only collects the
+	// finished ones.
+	//
+	// Either way the owner of the planner is sent PathReady or
+	// NoPathAvailable from update, on the main thread.
+	//
+	// Threaded searches read the nav graph and walkable tiles while the
+	// game runs, so nodes and tiles must not be switched on or off while
+	// any are in flight.
+	class PathManager
+	{
+	public:
+		enum class Mode
+		{
+			TIME_SLICED,
+			THREADED
+		};
+
+		enum Message
+		{
+			PathReady       = 0x100,
+			NoPathAvailable = 0x101
+		};
+
+		enum { DEFAULT_EXPANSIONS_PER_SLICE = 64, DEFAULT_BUDGET_MICROSECONDS = 1000 };
+
+		explicit PathManager(MessageDispatcher& dispatcher, Mode mode = Mode::TIME_SLICED,
+			int expansionsPerSlice = DEFAULT_EXPANSIONS_PER_SLICE, sf::Time budget = sf::microseconds(DEFAULT_BUDGET_MICROSECONDS));
+		~PathManager();
+
+		// Replaces any request the planner already has.
+		void request(PathPlanner& planner, SearchStatus status);
+		// Waits for the planner's search if it is running on a thread.
+		void cancel(PathPlanner& planner);
+
+		void update();
+
+		std::size_t numRequests() const;
+		Mode getMode() const;
+		// Requests already made carry on as they were started.
+		void setMode(Mode mode);
+
+	private:
+		PathManager(const PathManager&) = delete;
+		PathManager& operator=(const PathManager&) = delete;
+
+		struct Request
+		{
+			PathPlanner* pPlanner;
+			SearchStatus status;
+			std::future<SearchStatus> result;
+		};
+
+		void notify(PathPlanner& planner, SearchStatus status);
+
+		MessageDispatcher& mDispatcher;
+		Mode mMode;
+		int mExpansionsPerSlice;
+		sf::Time mBudget;
+		std::vector<Request> mRequests;
+		// Where the next update's slices start, so every search gets a turn.
+		std::size_t mNext;
+	};
+}
+
+#endif
@@ -1,86 +1,264 @@
 #include"path_planner.h"
 #include "moving_entity.h"
 #include "game.h"
-#include "graph_search_a_star.h"
+#include "path_manager.h"
+#include "line_of_sight.h"
 #include "vector_ops.h"
 
+#include <iterator>
 #include <limits>
 
 namespace te
 {
 	PathPlanner::PathPlanner(MovingEntity& owner)
 		: mOwner(owner)
-		, mNavGraph(mOwner.getWorld().getMap().getNavGraph())
+		, mMap(mOwner.getWorld().getMap())
+		, mpSearch(nullptr)
+		, mpGridSearch(nullptr)
 		, mDestinationPosition(0.f, 0.f)
-	{}
+		, mWaypoints()
+		, mPath()
+		, mSearchPending(false)
+	{
+		if (mMap.getPlanner() == TileMap::Planner::GRID)
+			mpGridSearch = std::make_unique<JumpPointSearch>(mMap.getWalkableGrid(), mMap.getGridMoves());
+		else
+			mpSearch = std::make_unique<GraphSearchCompactAStar>(mMap.getCompactNavGraph());
+	}
+
+	PathPlanner::~PathPlanner()
+	{
+		mOwner.getWorld().getPathManager().cancel(*this);
+	}
 
 	bool PathPlanner::createPathToPosition(sf::Vector2f targetPos, std::list<sf::Vector2f>& path)
+	{
+		mOwner.getWorld().getPathManager().cancel(*this);
+
+		SearchStatus status = beginSearch(targetPos);
+		if (status == SearchStatus::INCOMPLETE)
+		{
+			status = cycleSearch(std::numeric_limits<int>::max());
+		}
+		finishSearch(status);
+
+		path.splice(path.end(), mPath);
+		return status == SearchStatus::FOUND;
+	}
+
+	void PathPlanner::requestPathToPosition(sf::Vector2f targetPos)
+	{
+		PathManager& manager = mOwner.getWorld().getPathManager();
+		manager.cancel(*this);
+		manager.request(*this, beginSearch(targetPos));
+	}
+
+	std::list<sf::Vector2f> PathPlanner::getPath()
+	{
+		return std::move(mPath);
+	}
+
+	SearchStatus PathPlanner::beginSearch(sf::Vector2f targetPos)
 	{
 		mDestinationPosition = targetPos;
+		mWaypoints.clear();
+		mPath.clear();
+		mSearchPending = false;
 
-		if (!mOwner.getWorld().isPathObstructed(mOwner.getPosition(), targetPos, mOwner.getBoundingRadius()))
+		if (hasLineOfSight(mMap.getWalkableGrid(), mOwner.getPosition(), targetPos, mOwner.getBoundingRadius()))
 		{
-			path.push_back(targetPos);
-			return true;
+			mPath.push_back(targetPos);
+			return SearchStatus::FOUND;
+		}
+
+		if (mpGridSearch)
+		{
+			sf::Vector2i sourceTile, targetTile;
+			if (!getClosestTileToPosition(mOwner.getPosition(), sourceTile) || !getClosestTileToPosition(targetPos, targetTile))
+			{
+				return SearchStatus::NOT_FOUND;
+			}
+
+			mpGridSearch->begin(sourceTile, targetTile);
+			mSearchPending = true;
+			return SearchStatus::INCOMPLETE;
 		}
 
 		int closestNode = getClosestNodeToPosition(mOwner.getPosition());
 
 		if (closestNode == NoClosestNodeFound)
 		{
-			return false;
+			return SearchStatus::NOT_FOUND;
 		}
 
 		int closestNodeToTarget = getClosestNodeToPosition(targetPos);
 
 		if (closestNodeToTarget == NoClosestNodeFound)
 		{
+			return SearchStatus::NOT_FOUND;
+		}
+
+		if (!mMap.getHierarchicalNavGraph().findPath(closestNode, closestNodeToTarget, mWaypoints))
+		{
+			// The entrances can miss a way through a cluster that is cut in
+			// two, so make sure with a full search before giving up.
+			mWaypoints = { closestNode, closestNodeToTarget };
+		}
+
+		mPath.push_back(mMap.getNavGraph().getNode(closestNode).getPosition());
+		if (!hasPendingSegments())
+		{
+			mWaypoints.clear();
+			mPath.push_back(targetPos);
+			smoothPath(mPath, mPath.begin(), mOwner.getPosition());
+			return SearchStatus::FOUND;
+		}
+
+		mpSearch->begin(mWaypoints.front(), *std::next(mWaypoints.begin()));
+		mSearchPending = true;
+		return SearchStatus::INCOMPLETE;
+	}
+
+	SearchStatus PathPlanner::cycleSearch(int maxExpansions)
+	{
+		return mpGridSearch ? mpGridSearch->cycle(maxExpansions) : mpSearch->cycle(maxExpansions);
+	}
+
+	void PathPlanner::finishSearch(SearchStatus status)
+	{
+		if (!mSearchPending)
+		{
+			return;
+		}
+		mSearchPending = false;
+
+		if (status != SearchStatus::FOUND)
+		{
+			mWaypoints.clear();
+			mPath.clear();
+			return;
+		}
+
+		if (mpGridSearch)
+		{
+			const WalkableGrid& grid = mMap.getWalkableGrid();
+			for (sf::Vector2i tile : mpGridSearch->getPathToTarget())
+				mPath.push_front(grid.getTileCenter(tile));
+			mPath.push_back(mDestinationPosition);
+		}
+		else
+		{
+			appendSegment(mPath);
+		}
+		smoothPath(mPath, mPath.begin(), mOwner.getPosition());
+	}
+
+	bool PathPlanner::hasPendingSegments() const
+	{
+		return mWaypoints.size() > 1;
+	}
+
+	bool PathPlanner::refineNextSegment(std::list<sf::Vector2f>& path)
+	{
+		if (mSearchPending || !hasPendingSegments())
+		{
+			return false;
+		}
+
+		if (!mpSearch->search(mWaypoints.front(), *std::next(mWaypoints.begin())))
+		{
+			mWaypoints.clear();
 			return false;
 		}
 
-		typedef GraphSearchAStar<TileMap::NavGraph, HeuristicEuclid> AStar;
-		AStar search(mNavGraph, closestNode, closestNodeToTarget);
+		appendSegment(path);
+		return true;
+	}
 
-		std::list<int> pathOfNodeIndices = search.getPathToTarget();
-		if (!pathOfNodeIndices.empty())
+	// Adds the leg just searched for, from the first waypoint to the next.
+	void PathPlanner::appendSegment(std::list<sf::Vector2f>& path)
+	{
+		mWaypoints.pop_front();
+
+		// The leg's first node ended the one before.
+		std::list<sf::Vector2f> segment;
+		convertIndicesToVectors(mpSearch->getPathToTarget(), segment);
+		segment.pop_front();
+
+		const std::size_t kept = path.size();
+		const sf::Vector2f from = path.empty() ? mOwner.getPosition() : path.back();
+		path.splice(path.end(), segment);
+
+		if (!hasPendingSegments())
 		{
-			convertIndicesToVectors(pathOfNodeIndices, path);
-			path.push_back(targetPos);
-			return true;
+			mWaypoints.clear();
+			path.push_back(mDestinationPosition);
 		}
+		smoothPath(path, std::next(path.begin(), kept), from);
+	}
 
-		return false;
+	// String pulling: each waypoint that can be skipped by going straight
+	// from the last one kept to the one after it is dropped, so the owner
+	// seeks fewer, longer stretches. Waypoints before first stay, and from
+	// is where the owner will be on reaching first.
+	void PathPlanner::smoothPath(std::list<sf::Vector2f>& path, std::list<sf::Vector2f>::iterator first, sf::Vector2f from) const
+	{
+		const WalkableGrid& grid = mMap.getWalkableGrid();
+		const float radius = mOwner.getBoundingRadius();
+		for (auto it = first; it != path.end() && std::next(it) != path.end();)
+		{
+			if (hasLineOfSight(grid, from, *std::next(it), radius))
+			{
+				it = path.erase(it);
+			}
+			else
+			{
+				from = *it;
+				++it;
+			}
+		}
 	}
 
+	// Read from a table of the nearest node to each tile, so it costs the
+	// same however many nodes are around.
 	int PathPlanner::getClosestNodeToPosition(sf::Vector2f pos) const
 	{
-		float closestSoFar = std::numeric_limits<float>::max();
-		int closestNode = NoClosestNodeFound;
-
-		const float range = mOwner.getWorld().getMap().getCellSpaceNeighborhoodRange();
+		return mMap.getNavNodeLookup().getNode(pos);
+	}
 
-		TileMap::NavCellSpace& cellSpace = mOwner.getWorld().getMap().getCellSpace();
-		cellSpace.calculateNeighbors(pos, range);
+	// The tile under pos, or the nearest walkable one around it when pos
+	// is up against a wall.
+	bool PathPlanner::getClosestTileToPosition(sf::Vector2f pos, sf::Vector2i& tile) const
+	{
+		const WalkableGrid& grid = mMap.getWalkableGrid();
+		sf::Vector2i center = grid.getTile(pos);
+		if (grid.isWalkable(center.x, center.y))
+		{
+			tile = center;
+			return true;
+		}
 
-		for (const TileMap::NavGraph::Node* pNode = cellSpace.begin(); !cellSpace.end(); pNode = cellSpace.next())
+		float closestSoFar = std::numeric_limits<float>::max();
+		for (int y = center.y - 1; y <= center.y + 1; ++y)
 		{
-			if (!mOwner.getWorld().isPathObstructed(pNode->getPosition(), pos, mOwner.getBoundingRadius()))
+			for (int x = center.x - 1; x <= center.x + 1; ++x)
 			{
-				float dist = distanceSq(pos, pNode->getPosition());
+				if (!grid.isWalkable(x, y)) continue;
+				float dist = distanceSq(pos, grid.getTileCenter({ x, y }));
 				if (dist < closestSoFar)
 				{
 					closestSoFar = dist;
-					closestNode = pNode->getIndex();
+					tile = { x, y };
 				}
 			}
 		}
 
-		return closestNode;
+		return closestSoFar < std::numeric_limits<float>::max();
 	}
 
 	void PathPlanner::convertIndicesToVectors(const std::list<int> pathOfNodeIndices, std::list<sf::Vector2f>& path)
 	{
 		for (int index : pathOfNodeIndices)
-			path.push_front(mNavGraph.getNode(index).getPosition());
+			path.push_front(mMap.getNavGraph().getNode(index).getPosition());
 	}
 }
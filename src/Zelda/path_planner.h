@@ -2,10 +2,15 @@
 #define TE_PATH_PLANNER_H
 
 #include "tile_map.h"
+#include "graph_search_compact_a_star.h"
+#include "hierarchical_nav_graph.h"
+#include "jump_point_search.h"
+#include "search_status.h"
 
 #include <SFML/Graphics.hpp>
 
 #include <list>
+#include <memory>
 
 namespace te
 {
@@ -15,20 +20,60 @@ namespace te
 	{
 	public:
 		PathPlanner(MovingEntity& owner);
+		~PathPlanner();
+
+		// On nav graph maps, plans over the map's clusters and fills path
+		// with only the first leg. The rest is walked out by
+		// refineNextSegment as it is needed. Grid maps get the whole path
+		// from Jump Point Search at once.
 		bool createPathToPosition(sf::Vector2f targetPosition, std::list<sf::Vector2f>& path);
+		// The same, but the search is left to the world's PathManager,
+		// which sends the owner PathManager::PathReady or NoPathAvailable
+		// when it is done. getPath then hands over the path.
+		void requestPathToPosition(sf::Vector2f targetPosition);
+		std::list<sf::Vector2f> getPath();
+
+		bool hasPendingSegments() const;
+		// Appends the next leg of the last path created, ending with the
+		// target position itself after the last one. Fails while a
+		// request is still being searched.
+		bool refineNextSegment(std::list<sf::Vector2f>& path);
 
 	private:
+		friend class PathManager;
+
 		PathPlanner(const PathPlanner&) = delete;
 		PathPlanner& operator=(const PathPlanner&) = delete;
 
-		enum { NoClosestNodeFound = -1 };
+		enum { NoClosestNodeFound = NavNodeLookup::NO_NODE };
+
+		// Does everything up to the search itself, which is left begun.
+		SearchStatus beginSearch(sf::Vector2f targetPosition);
+		// Touches only the search, so it can run on another thread.
+		SearchStatus cycleSearch(int maxExpansions);
+		// Turns a finished search into the path.
+		void finishSearch(SearchStatus status);
+		void appendSegment(std::list<sf::Vector2f>& path);
+		void smoothPath(std::list<sf::Vector2f>& path, std::list<sf::Vector2f>::iterator first, sf::Vector2f from) const;
 
 		int getClosestNodeToPosition(sf::Vector2f pos) const;
+		bool getClosestTileToPosition(sf::Vector2f pos, sf::Vector2i& tile) const;
 		void convertIndicesToVectors(const std::list<int> pathOfNodeIndices, std::list<sf::Vector2f>& path);
 
 		MovingEntity& mOwner;
-		const TileMap::NavGraph& mNavGraph;
+		TileMap& mMap;
+		// Reused so repeated planning does not reallocate the search
+		// buffers. Only the one for the map's planner is made.
+		std::unique_ptr<GraphSearchCompactAStar> mpSearch;
+		std::unique_ptr<JumpPointSearch> mpGridSearch;
 		sf::Vector2f mDestinationPosition;
+		// Nav graph nodes the current path still has to pass through, the
+		// one the path has reached first.
+		std::list<int> mWaypoints;
+		// The path so far of the last request, and whether its search is
+		// still to finish.
+		std::list<sf::Vector2f> mPath;
+		bool mSearchPending;
 	};
 }
 
@@ -0,0 +1,196 @@
+#include "physics_queries.h"
+#include "contact_events.h"
+#include "../TantechEngine/job_pool.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace te
+{
+	// Fewest queries handed to a job.
+	static const std::size_t QUERY_GRAIN = 64;
+
+	static bool accepts(const QueryFilter& filter, const b2Fixture& fixture)
+	{
+		const b2Body& body = *fixture.GetBody();
+		return !fixture.IsSensor()
+			&& (fixture.GetFilterData().categoryBits & filter.categoryBits)
+			&& (!filter.staticOnly || body.GetType() == b2_staticBody)
+			&& (filter.ignore == NO_ENTITY || toEntityID(body.GetUserData()) != filter.ignore);
+	}
+
+	static QueryHit miss()
+	{
+		return{ false, NO_ENTITY, 1.f, {}, {} };
+	}
+
+	class ClosestRayCallback : public b2RayCastCallback
+	{
+	public:
+		ClosestRayCallback(const QueryFilter& filter, QueryHit& hit)
+			: m_Filter(filter)
+			, m_Hit(hit)
+		{}
+
+		float32 ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float32 fraction) override
+		{
+			if (!accepts(m_Filter, *fixture)) return -1;
+			if (fraction < m_Hit.fraction || !m_Hit.hit)
+			{
+				m_Hit = { true, toEntityID(fixture->GetBody()->GetUserData()), fraction, { point.x, point.y }, { normal.x, normal.y } };
+			}
+			// Clip the ray to the hit, only closer fixtures matter now.
+			return fraction;
+		}
+	private:
+		const QueryFilter& m_Filter;
+		QueryHit& m_Hit;
+	};
+
+	void castRays(const std::vector<const b2World*>& worlds, const std::vector<RayQuery>& rays, std::vector<QueryHit>& hits, JobPool* pPool)
+	{
+		hits.assign(rays.size(), miss());
+		parallelFor(pPool, 0, rays.size(), QUERY_GRAIN, [&](std::size_t begin, std::size_t end) {
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				const RayQuery& ray = rays[i];
+				b2Vec2 from{ ray.from.x, ray.from.y }, to{ ray.to.x, ray.to.y };
+				if (b2DistanceSquared(from, to) == 0) continue;
+
+				ClosestRayCallback callback{ ray.filter, hits[i] };
+				for (const b2World* pWorld : worlds)
+				{
+					pWorld->RayCast(&callback, from, to);
+				}
+			}
+		});
+	}
+
+	// Separating axis test over the motion: the box and polygon overlap
+	// while their projections overlap on every axis, so the time of impact
+	// is the latest time they start overlapping on any axis. Like
+	// TiledMap::sweep, shapes the box already overlaps are not hit, nor are
+	// shapes it only touches and moves along or away from.
+	static bool sweepBox(const sf::FloatRect& box, const b2Vec2& translation, const b2Vec2* vertices, const b2Vec2* normals, int count, const b2Transform& transform, float& fraction, b2Vec2& normal)
+	{
+		b2Vec2 worldVertices[b2_maxPolygonVertices];
+		for (int i = 0; i < count; ++i)
+		{
+			worldVertices[i] = b2Mul(transform, vertices[i]);
+		}
+
+		b2Vec2 boxCenter{ box.left + box.width / 2, box.top + box.height / 2 };
+		b2Vec2 boxExtents{ box.width / 2, box.height / 2 };
+
+		float enter = -std::numeric_limits<float>::max();
+		float exit = std::numeric_limits<float>::max();
+		b2Vec2 enterNormal{ 0, 0 };
+		auto testAxis = [&](const b2Vec2& axis) {
+			float boxCentre = b2Dot(boxCenter, axis);
+			float boxRadius = boxExtents.x * std::abs(axis.x) + boxExtents.y * std::abs(axis.y);
+			float polygonMin = std::numeric_limits<float>::max(), polygonMax = -polygonMin;
+			for (int i = 0; i < count; ++i)
+			{
+				float projection = b2Dot(worldVertices[i], axis);
+				polygonMin = std::min(polygonMin, projection);
+				polygonMax = std::max(polygonMax, projection);
+			}
+
+			float speed = b2Dot(translation, axis);
+			float gapBefore = polygonMin - (boxCentre + boxRadius);
+			float gapAfter = (boxCentre - boxRadius) - polygonMax;
+			if (speed == 0)
+				return gapBefore < 0 && gapAfter < 0;
+
+			float t0 = gapBefore / speed;
+			float t1 = -gapAfter / speed;
+			if (t0 > t1) std::swap(t0, t1);
+			if (t0 > enter)
+			{
+				enter = t0;
+				enterNormal = speed > 0 ? -axis : axis;
+			}
+			exit = std::min(exit, t1);
+			return enter <= exit;
+		};
+
+		if (!testAxis({ 1, 0 }) || !testAxis({ 0, 1 })) return false;
+		for (int i = 0; i < count; ++i)
+		{
+			if (!testAxis(b2Mul(transform.q, normals[i]))) return false;
+		}
+		// Allow for boxes left touching a shape by rounding.
+		const float touching = -1e-4f;
+		if (enter >= exit || enter < touching || enter > 1) return false;
+
+		fraction = std::max(enter, 0.f);
+		normal = enterNormal;
+		return true;
+	}
+
+	class ClosestBoxCallback : public b2QueryCallback
+	{
+	public:
+		ClosestBoxCallback(const BoxCast& cast, QueryHit& hit)
+			: m_Cast(cast)
+			, m_Hit(hit)
+		{}
+
+		bool ReportFixture(b2Fixture* fixture) override
+		{
+			if (!accepts(m_Cast.filter, *fixture)) return true;
+
+			const b2Shape& shape = *fixture->GetShape();
+			const b2Transform& transform = fixture->GetBody()->GetTransform();
+			b2Vec2 translation{ m_Cast.translation.x, m_Cast.translation.y };
+			float fraction;
+			b2Vec2 normal;
+			bool hit = false;
+			if (shape.GetType() == b2Shape::e_polygon)
+			{
+				const auto& polygon = static_cast<const b2PolygonShape&>(shape);
+				hit = sweepBox(m_Cast.box, translation, polygon.m_vertices, polygon.m_normals, polygon.m_count, transform, fraction, normal);
+			}
+			else if (shape.GetType() == b2Shape::e_edge)
+			{
+				const auto& edge = static_cast<const b2EdgeShape&>(shape);
+				b2Vec2 vertices[2] = { edge.m_vertex1, edge.m_vertex2 };
+				b2Vec2 side = b2Cross(edge.m_vertex2 - edge.m_vertex1, 1.f);
+				side.Normalize();
+				b2Vec2 normals[2] = { side, -side };
+				hit = sweepBox(m_Cast.box, translation, vertices, normals, 2, transform, fraction, normal);
+			}
+
+			if (hit && (!m_Hit.hit || fraction < m_Hit.fraction))
+			{
+				sf::Vector2f centre{ m_Cast.box.left + m_Cast.box.width / 2, m_Cast.box.top + m_Cast.box.height / 2 };
+				m_Hit = { true, toEntityID(fixture->GetBody()->GetUserData()), fraction, centre + m_Cast.translation * fraction, { normal.x, normal.y } };
+			}
+			return true;
+		}
+	private:
+		const BoxCast& m_Cast;
+		QueryHit& m_Hit;
+	};
+
+	void castBoxes(const std::vector<const b2World*>& worlds, const std::vector<BoxCast>& casts, std::vector<QueryHit>& hits, JobPool* pPool)
+	{
+		hits.assign(casts.size(), miss());
+		parallelFor(pPool, 0, casts.size(), QUERY_GRAIN, [&](std::size_t begin, std::size_t end) {
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				const BoxCast& cast = casts[i];
+				// Everything the box passes over.
+				b2AABB swept;
+				swept.lowerBound = { cast.box.left + std::min(cast.translation.x, 0.f), cast.box.top + std::min(cast.translation.y, 0.f) };
+				swept.upperBound = { cast.box.left + cast.box.width + std::max(cast.translation.x, 0.f), cast.box.top + cast.box.height + std::max(cast.translation.y, 0.f) };
+
+				ClosestBoxCallback callback{ cast, hits[i] };
+				for (const b2World* pWorld : worlds)
+				{
+					pWorld->QueryAABB(&callback, swept);
+				}
+			}
+		});
+	}
+}
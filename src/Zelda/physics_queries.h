@@ -0,0 +1,62 @@
+#ifndef TE_PHYSICS_QUERIES_H
+#define TE_PHYSICS_QUERIES_H
+
+#include "typedefs.h"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <Box2D/Box2D.h>
+
+#include <vector>
+
+namespace te
+{
+	class JobPool;
+
+	// What a query can hit. Sensors are never hit.
+	struct QueryFilter
+	{
+		uint16 categoryBits = 0xFFFF;
+		// Usually the entity asking, so it does not hit itself.
+		EntityID ignore = -1;
+		// Only level geometry, not things that move.
+		bool staticOnly = false;
+	};
+
+	struct RayQuery
+	{
+		sf::Vector2f from;
+		sf::Vector2f to;
+		QueryFilter filter;
+	};
+
+	// An axis aligned box moved along translation.
+	struct BoxCast
+	{
+		sf::FloatRect box;
+		sf::Vector2f translation;
+		QueryFilter filter;
+	};
+
+	// The first thing a query hit. fraction is how far along the ray or
+	// translation the hit is, 1 for misses. For box casts point is the
+	// centre of the box where it stops. The normal points back out of
+	// what was hit. Entities come from body user data, see toEntityID.
+	struct QueryHit
+	{
+		bool hit;
+		EntityID entity;
+		float fraction;
+		sf::Vector2f point;
+		sf::Vector2f normal;
+	};
+
+	// Each fills hits with one entry per query, in the same order, taking
+	// the closest hit over all the worlds. Queries are spread over pPool
+	// when given; the worlds must not be stepped meanwhile.
+	void castRays(const std::vector<const b2World*>& worlds, const std::vector<RayQuery>& rays, std::vector<QueryHit>& hits, JobPool* pPool = nullptr);
+	// Box casts stop at polygon and edge fixtures; other shapes are not hit.
+	// Fixtures the box starts out overlapping are not hit either.
+	void castBoxes(const std::vector<const b2World*>& worlds, const std::vector<BoxCast>& casts, std::vector<QueryHit>& hits, JobPool* pPool = nullptr);
+}
+
+#endif
@@ -0,0 +1,217 @@
+#include "physics_regions.h"
+#include "collider_baking.h"
+#include "contact_events.h"
+#include "../TantechEngine/job_pool.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace te
+{
+	static float distanceToRect(const sf::FloatRect& rect, const sf::Vector2f& point)
+	{
+		float dx = std::max({ rect.left - point.x, point.x - (rect.left + rect.width), 0.f });
+		float dy = std::max({ rect.top - point.y, point.y - (rect.top + rect.height), 0.f });
+		return std::sqrt(dx * dx + dy * dy);
+	}
+
+	static bool containsInclusive(const sf::FloatRect& rect, const b2Vec2& point)
+	{
+		return point.x >= rect.left && point.x <= rect.left + rect.width
+			&& point.y >= rect.top && point.y <= rect.top + rect.height;
+	}
+
+	// Box2D fills in its table of contact functions when the first contact
+	// is made and, on Windows, the timer frequency when the first b2Timer is
+	// made. Making both happen here, on the main thread, keeps worlds
+	// stepping on the pool from racing to do it.
+	static bool initBox2DGlobals()
+	{
+		b2Timer timer;
+		b2World world{ b2Vec2{ 0, 0 } };
+		b2BodyDef bodyDef;
+		bodyDef.type = b2_dynamicBody;
+		b2CircleShape shape;
+		shape.m_radius = 1;
+		world.CreateBody(&bodyDef)->CreateFixture(&shape, 1);
+		world.CreateBody(&bodyDef)->CreateFixture(&shape, 1);
+		// The overlapping fixtures are paired before anything moves.
+		world.Step(0, 1, 1);
+		return world.GetContactCount() > 0;
+	}
+
+	PhysicsRegions::PhysicsRegions(b2World& mainWorld, JobPool* pPool)
+		: m_pMainWorld{ &mainWorld }
+		, m_pPool{ pPool }
+		, m_Regions{}
+		, m_StaticRects{}
+	{
+		static const bool box2DReady = initBox2DGlobals();
+		(void)box2DReady;
+	}
+
+	int PhysicsRegions::addRegion(const sf::FloatRect& bounds)
+	{
+		Region region{ bounds, std::make_unique<b2World>(m_pMainWorld->GetGravity()), {}, true };
+		for (const auto& scenery : m_StaticRects)
+		{
+			addScenery(region, scenery.rects, scenery.entity);
+		}
+		m_Regions.push_back(std::move(region));
+		return static_cast<int>(m_Regions.size());
+	}
+
+	void PhysicsRegions::addStaticRects(const std::vector<sf::FloatRect>& rects, EntityID entity)
+	{
+		m_StaticRects.push_back({ entity, rects });
+		for (auto& region : m_Regions)
+		{
+			addScenery(region, rects, entity);
+		}
+	}
+
+	void PhysicsRegions::addScenery(Region& region, const std::vector<sf::FloatRect>& rects, EntityID entity)
+	{
+		std::vector<sf::FloatRect> overlapping;
+		// Walls just touching the bounds are kept, they are what bodies in
+		// the region bump into at its edges.
+		const sf::FloatRect& bounds = region.bounds;
+		std::copy_if(rects.begin(), rects.end(), std::back_inserter(overlapping), [&bounds](const sf::FloatRect& rect) {
+			return rect.left <= bounds.left + bounds.width && bounds.left <= rect.left + rect.width
+				&& rect.top <= bounds.top + bounds.height && bounds.top <= rect.top + rect.height;
+		});
+		if (overlapping.empty()) return;
+
+		// Contacts and casts report the entity from the body's user data.
+		void* pUserData = toUserData(entity);
+		auto it = std::find_if(region.scenery.begin(), region.scenery.end(), [pUserData](const b2Body* pBody) {
+			return pBody->GetUserData() == pUserData;
+		});
+		if (it == region.scenery.end())
+		{
+			b2BodyDef bodyDef;
+			bodyDef.type = b2_staticBody;
+			bodyDef.userData = pUserData;
+			region.scenery.push_back(region.pWorld->CreateBody(&bodyDef));
+			it = region.scenery.end() - 1;
+		}
+		createRectFixtures(**it, overlapping);
+	}
+
+	std::size_t PhysicsRegions::size() const
+	{
+		return m_Regions.size() + 1;
+	}
+
+	b2World& PhysicsRegions::getWorld(int region)
+	{
+		return region == 0 ? *m_pMainWorld : *m_Regions.at(region - 1).pWorld;
+	}
+
+	void PhysicsRegions::getWorlds(std::vector<const b2World*>& out) const
+	{
+		out.clear();
+		out.push_back(m_pMainWorld);
+		for (auto& region : m_Regions)
+		{
+			out.push_back(region.pWorld.get());
+		}
+	}
+
+	int PhysicsRegions::getRegion(const b2World& world) const
+	{
+		for (std::size_t i = 0; i < m_Regions.size(); ++i)
+		{
+			if (m_Regions[i].pWorld.get() == &world) return static_cast<int>(i + 1);
+		}
+		return 0;
+	}
+
+	int PhysicsRegions::findRegion(int current, const b2Vec2& position) const
+	{
+		// Bodies stay put until they are clear of their region, so one
+		// standing on a shared edge does not go back and forth.
+		if (current != 0 && containsInclusive(m_Regions[current - 1].bounds, position))
+			return current;
+
+		for (std::size_t i = 0; i < m_Regions.size(); ++i)
+		{
+			if (containsInclusive(m_Regions[i].bounds, position)) return static_cast<int>(i + 1);
+		}
+		return 0;
+	}
+
+	b2Body* PhysicsRegions::migrate(const b2Body& body, int region)
+	{
+		b2BodyDef bodyDef;
+		bodyDef.type = body.GetType();
+		bodyDef.position = body.GetPosition();
+		bodyDef.angle = body.GetAngle();
+		bodyDef.linearVelocity = body.GetLinearVelocity();
+		bodyDef.angularVelocity = body.GetAngularVelocity();
+		bodyDef.linearDamping = body.GetLinearDamping();
+		bodyDef.angularDamping = body.GetAngularDamping();
+		bodyDef.allowSleep = body.IsSleepingAllowed();
+		bodyDef.awake = body.IsAwake();
+		bodyDef.fixedRotation = body.IsFixedRotation();
+		bodyDef.bullet = body.IsBullet();
+		bodyDef.active = body.IsActive();
+		bodyDef.userData = body.GetUserData();
+		bodyDef.gravityScale = body.GetGravityScale();
+
+		b2Body* pCopy = getWorld(region).CreateBody(&bodyDef);
+		for (const b2Fixture* pFixture = body.GetFixtureList(); pFixture; pFixture = pFixture->GetNext())
+		{
+			b2FixtureDef fixtureDef;
+			fixtureDef.shape = pFixture->GetShape();
+			fixtureDef.userData = pFixture->GetUserData();
+			fixtureDef.friction = pFixture->GetFriction();
+			fixtureDef.restitution = pFixture->GetRestitution();
+			fixtureDef.density = pFixture->GetDensity();
+			fixtureDef.isSensor = pFixture->IsSensor();
+			fixtureDef.filter = pFixture->GetFilterData();
+			pCopy->CreateFixture(&fixtureDef);
+		}
+		return pCopy;
+	}
+
+	void PhysicsRegions::updateAwake(const sf::Vector2f& focus, float distance)
+	{
+		for (auto& region : m_Regions)
+		{
+			region.awake = distanceToRect(region.bounds, focus) <= distance;
+		}
+	}
+
+	void PhysicsRegions::setAllAwake()
+	{
+		for (auto& region : m_Regions)
+		{
+			region.awake = true;
+		}
+	}
+
+	bool PhysicsRegions::isAwake(int region) const
+	{
+		return region == 0 || m_Regions.at(region - 1).awake;
+	}
+
+	void PhysicsRegions::step(float dt, int velocityIterations, int positionIterations)
+	{
+		// Each world has its own bodies and allocators. What Box2D keeps
+		// in globals is set up in the constructor or, for its profiling
+		// counters, compiled out (see B2_COLLECT_STATS in b2Settings.h), so
+		// worlds can step on different threads.
+		std::vector<b2World*> worlds{ m_pMainWorld };
+		for (auto& region : m_Regions)
+		{
+			if (region.awake) worlds.push_back(region.pWorld.get());
+		}
+		parallelFor(m_pPool, 0, worlds.size(), 1, [&](std::size_t begin, std::size_t end) {
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				worlds[i]->Step(dt, velocityIterations, positionIterations);
+			}
+		});
+	}
+}
@@ -0,0 +1,90 @@
+#ifndef TE_PHYSICS_REGIONS_H
+#define TE_PHYSICS_REGIONS_H
+
+#include "typedefs.h"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <Box2D/Box2D.h>
+
+#include <memory>
+#include <vector>
+
+namespace te
+{
+	class JobPool;
+
+	// Splits the map into areas, rooms usually, each simulated in its own
+	// b2World so they can be stepped at the same time on a job pool
+	// and left unstepped when nothing near them matters.
+	//
+	// Region 0 is the main world and holds everything outside the others.
+	// A body belongs to the region of its world and is moved to another
+	// once its position leaves its region's bounds. Moving recreates the
+	// body and its fixtures in the new world; joints are not carried over
+	// and contacts across a boundary are not seen, so regions should meet
+	// at doors and walls.
+	//
+	// Static scenery added through addStaticRects is copied into every
+	// region it overlaps, on a body with the same entity in its user data.
+	class PhysicsRegions
+	{
+	public:
+		// Without a pool the regions step one after another.
+		explicit PhysicsRegions(b2World& mainWorld, JobPool* pPool = nullptr);
+		PhysicsRegions(PhysicsRegions&&) = default;
+		PhysicsRegions& operator=(PhysicsRegions&&) = default;
+
+		// Returns the new region's index.
+		int addRegion(const sf::FloatRect& bounds);
+		// Rects in world space, belonging to entity.
+		void addStaticRects(const std::vector<sf::FloatRect>& rects, EntityID entity);
+
+		std::size_t size() const;
+		b2World& getWorld(int region);
+		// Every region's world, the main one first.
+		void getWorlds(std::vector<const b2World*>& out) const;
+		int getRegion(const b2World& world) const;
+		// The region a body in region current at position belongs in.
+		int findRegion(int current, const b2Vec2& position) const;
+		// Recreates body in region's world and returns the copy. The caller
+		// destroys the original.
+		b2Body* migrate(const b2Body& body, int region);
+
+		// Regions further than distance from focus stop being stepped until
+		// it comes back. The main world is always stepped.
+		void updateAwake(const sf::Vector2f& focus, float distance);
+		void setAllAwake();
+		bool isAwake(int region) const;
+
+		// Steps every awake region, spread over the job pool.
+		void step(float dt, int velocityIterations, int positionIterations);
+	private:
+		struct Region
+		{
+			sf::FloatRect bounds;
+			std::unique_ptr<b2World> pWorld;
+			// The region's copies of the static rects, a body per entity.
+			std::vector<b2Body*> scenery;
+			bool awake;
+		};
+
+		PhysicsRegions(const PhysicsRegions&) = delete;
+		PhysicsRegions& operator=(const PhysicsRegions&) = delete;
+
+		struct Scenery
+		{
+			EntityID entity;
+			std::vector<sf::FloatRect> rects;
+		};
+
+		void addScenery(Region& region, const std::vector<sf::FloatRect>& rects, EntityID entity);
+
+		b2World* m_pMainWorld;
+		JobPool* m_pPool;
+		// The main world is not among these, so region i is m_Regions[i - 1].
+		std::vector<Region> m_Regions;
+		std::vector<Scenery> m_StaticRects;
+	};
+}
+
+#endif
@@ -2,20 +2,119 @@
 
 namespace te
 {
-	PhysicsWorldManager::PhysicsWorldManager(b2World& world, const decltype(GameData::rigidBodies)& rigidBodies, decltype(GameData::positions)& positions)
-		: m_rPhysicsWorld{ world }
+	// After a long stall the world falls behind instead of spending even
+	// longer catching up.
+	static const int MAX_STEPS_PER_UPDATE = 5;
+
+	PhysicsWorldManager::PhysicsWorldManager(PhysicsRegions& regions,
+		decltype(GameData::rigidBodies)& rigidBodies,
+		decltype(GameData::positions)& positions,
+		decltype(GameData::previousPositions)& previousPositions,
+		decltype(GameData::contactEvents)& contactEvents,
+		const PhysicsConfig& config,
+		EntityID focus)
+		: m_rRegions{ regions }
 		, m_rRigidBodies{ rigidBodies }
 		, m_rPositions{ positions }
+		, m_rPreviousPositions{ previousPositions }
+		, m_rContactEvents{ contactEvents }
+		, m_ContactListeners{}
+		, m_TimePerStep{ sf::seconds(1.f / config.rate) }
+		, m_VelocityIterations{ config.velocityIterations }
+		, m_PositionIterations{ config.positionIterations }
+		, m_RegionSleepDistance{ config.regionSleepDistance }
+		, m_Focus{ focus }
+		, m_Accumulator{ sf::Time::Zero }
+		, m_Moved{}
 	{}
 
-	void PhysicsWorldManager::update(const sf::Time& dt)
+	PhysicsWorldManager::~PhysicsWorldManager()
 	{
-		m_rPhysicsWorld.Step(dt.asSeconds(), 8, 3);
+		for (std::size_t region = 0; region < m_ContactListeners.size(); ++region)
+		{
+			m_rRegions.getWorld(static_cast<int>(region)).SetContactListener(nullptr);
+		}
+	}
+
+	void PhysicsWorldManager::update(const sf::Time& elapsed)
+	{
+		m_Accumulator += elapsed;
+		int steps = 0;
+		while (m_Accumulator >= m_TimePerStep)
+		{
+			m_Accumulator -= m_TimePerStep;
+			if (++steps > MAX_STEPS_PER_UPDATE)
+			{
+				m_Accumulator = sf::Time::Zero;
+				break;
+			}
+			step();
+		}
+	}
+
+	float PhysicsWorldManager::getInterpolation() const
+	{
+		return m_Accumulator / m_TimePerStep;
+	}
+
+	void PhysicsWorldManager::step()
+	{
+		for (auto entityID : m_Moved)
+		{
+			m_rPreviousPositions[entityID] = m_rPositions[entityID];
+		}
+
+		if (m_rPositions.contains(m_Focus))
+			m_rRegions.updateAwake(m_rPositions[m_Focus], m_RegionSleepDistance);
+		else
+			m_rRegions.setAllAwake();
+		// Regions can be added at any time.
+		for (std::size_t region = m_ContactListeners.size(); region < m_rRegions.size(); ++region)
+		{
+			m_ContactListeners.push_back(std::make_unique<ContactListener>(m_rContactEvents.capacity()));
+			m_rRegions.getWorld(static_cast<int>(region)).SetContactListener(m_ContactListeners.back().get());
+		}
+
+		m_rRegions.step(m_TimePerStep.asSeconds(), m_VelocityIterations, m_PositionIterations);
+
+		// Sleeping and static bodies, and those in regions that were not
+		// stepped, have not moved since they were last written, so only
+		// the rest are copied, and new bodies once.
+		m_Moved.clear();
 		for (auto& rigidBody : m_rRigidBodies)
 		{
 			auto entityID = rigidBody.first;
-			auto position = rigidBody.second->GetPosition();
+			const b2Body& body = *rigidBody.second;
+			int region = m_rRegions.getRegion(*body.GetWorld());
+			auto position = body.GetPosition();
+			if (!m_rPreviousPositions.contains(entityID))
+			{
+				m_rPreviousPositions[entityID] = { position.x, position.y };
+			}
+			else if (!body.IsAwake() || body.GetType() == b2_staticBody || !m_rRegions.isAwake(region))
+			{
+				continue;
+			}
 			m_rPositions[entityID] = { position.x, position.y };
+			m_Moved.push_back(entityID);
+
+			if (body.GetType() == b2_staticBody)
+				continue;
+			int newRegion = m_rRegions.findRegion(region, position);
+			if (newRegion != region)
+			{
+				b2World* pWorld = &m_rRegions.getWorld(newRegion);
+				rigidBody.second = {
+					m_rRegions.migrate(body, newRegion),
+					[pWorld](b2Body* pBody) { pWorld->DestroyBody(pBody); }
+				};
+			}
+		}
+
+		for (auto& pListener : m_ContactListeners)
+		{
+			m_rContactEvents.append(pListener->getEvents());
+			pListener->getEvents().clear();
 		}
 	}
 }
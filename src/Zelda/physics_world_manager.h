@@ -3,24 +3,55 @@
 
 #include "game_data.h"
 
-class b2World;
+#include <SFML/System/Time.hpp>
 
-namespace sf
-{
-	class Time;
-}
+#include <memory>
+#include <vector>
 
 namespace te
 {
+	// Steps the world at its own fixed rate, however often update is called,
+	// and keeps the positions from before the last step so drawing can blend
+	// between the two. Bodies that leave their physics region move to the
+	// one they entered after each step.
 	class PhysicsWorldManager
 	{
 	public:
-		PhysicsWorldManager(b2World&, const decltype(GameData::rigidBodies)& rigidBodies, decltype(GameData::positions)& positions);
-		void update(const sf::Time& dt);
+		PhysicsWorldManager(PhysicsRegions&,
+			decltype(GameData::rigidBodies)& rigidBodies,
+			decltype(GameData::positions)& positions,
+			decltype(GameData::previousPositions)& previousPositions,
+			decltype(GameData::contactEvents)& contactEvents,
+			const PhysicsConfig& config,
+			EntityID focus);
+		// The worlds outlive the manager and must stop calling its listeners.
+		~PhysicsWorldManager();
+
+		// Runs as many steps as fit in the time elapsed.
+		void update(const sf::Time& elapsed);
+		// How far the time left over is into the next step, from 0 to 1.
+		float getInterpolation() const;
 	private:
-		b2World& m_rPhysicsWorld;
-		const decltype(GameData::rigidBodies)& m_rRigidBodies;
+		void step();
+
+		PhysicsRegions& m_rRegions;
+		decltype(GameData::rigidBodies)& m_rRigidBodies;
 		decltype(GameData::positions)& m_rPositions;
+		decltype(GameData::previousPositions)& m_rPreviousPositions;
+		decltype(GameData::contactEvents)& m_rContactEvents;
+		// One per region, each region's world may step on another thread.
+		std::vector<std::unique_ptr<ContactListener>> m_ContactListeners;
+
+		sf::Time m_TimePerStep;
+		int m_VelocityIterations;
+		int m_PositionIterations;
+		float m_RegionSleepDistance;
+		// Regions are kept awake near this entity.
+		EntityID m_Focus;
+		sf::Time m_Accumulator;
+		// Bodies whose position the last step wrote. The others have the
+		// same previous and current position already.
+		std::vector<EntityID> m_Moved;
 	};
 }
 
@@ -11,21 +11,31 @@ namespace te
 	public:
 		RenderManager(const DrawableStore& drawableStore,
 			decltype(GameData::positions)& positionStore,
+			decltype(GameData::previousPositions)& previousPositionStore,
 			decltype(GameData::pendingDraws)& pendingDraws)
 			: m_DrawableStore(drawableStore)
 			, m_PositionStore(positionStore)
+			, m_PreviousPositionStore(previousPositionStore)
 			, m_PendingDraws(pendingDraws)
 		{}
 		RenderManager(RenderManager&&) = default;
 		RenderManager& operator=(RenderManager&&) = default;
 
-		void update()
+		// Entities with a previous position are drawn the given fraction of
+		// the way from it to their current one.
+		void update(float interpolation)
 		{
-			std::transform(std::cbegin(m_DrawableStore), std::cend(m_DrawableStore), std::back_inserter(m_PendingDraws), [this](const auto& entityDrawable) {
+			std::transform(std::cbegin(m_DrawableStore), std::cend(m_DrawableStore), std::back_inserter(m_PendingDraws), [this, interpolation](const auto& entityDrawable) {
 				auto entityID = entityDrawable.first;
 				const auto& drawable = entityDrawable.second;
 				sf::RenderStates renderStates;
-				renderStates.transform.translate(m_PositionStore[entityID]);
+				sf::Vector2f position = m_PositionStore[entityID];
+				if (m_PreviousPositionStore.contains(entityID))
+				{
+					const sf::Vector2f& previous = m_PreviousPositionStore[entityID];
+					position = previous + (position - previous) * interpolation;
+				}
+				renderStates.transform.translate(position);
 				return PendingDraw{ renderStates, drawable.sortingLayer, &drawable.drawable };
 			});
 		}
@@ -33,16 +43,17 @@ namespace te
 	private:
 		const DrawableStore& m_DrawableStore;
 		decltype(GameData::positions)& m_PositionStore;
+		decltype(GameData::previousPositions)& m_PreviousPositionStore;
 		decltype(GameData::pendingDraws)& m_PendingDraws;
 	};
 
 	template <typename Drawables>
 	auto makeRenderManager(const Drawables& drawables,
 		decltype(GameData::positions)& positions,
-		decltype(GameData::sortingLayers)& sortings,
+		decltype(GameData::previousPositions)& previousPositions,
 		decltype(GameData::pendingDraws)& pendingDraws)
 	{
-		return RenderManager<Drawables>{ drawables, positions, sortings, pendingDraws };
+		return RenderManager<Drawables>{ drawables, positions, previousPositions, pendingDraws };
 	}
 }
 
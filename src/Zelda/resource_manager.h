@@ -4,6 +4,11 @@
 #include <map>
 #include <memory>
 #include <cassert>
+#include <cstddef>
+
+#include <SFML/Graphics/Texture.hpp>
+
+#include "asset_loading.h"
 
 namespace te
 {
@@ -13,6 +18,37 @@ namespace te
 		int value;
 	};
 
+	// What residency needs to know about a resource type. Types without a
+	// specialization are never evicted.
+	template <typename Resource>
+	struct ResidencyTraits
+	{
+		static std::size_t byteSize(const Resource&) { return 0; }
+		static void unload(Resource&) {}
+		static bool reload(Resource&, const std::string&) { return false; }
+	};
+
+	template <>
+	struct ResidencyTraits<sf::Texture>
+	{
+		static std::size_t byteSize(const sf::Texture& texture)
+		{
+			return std::size_t{texture.getSize().x} * texture.getSize().y * 4;
+		}
+		// Assigned in place so pointers handed out by get stay valid.
+		static void unload(sf::Texture& texture) { texture = sf::Texture{}; }
+		static bool reload(sf::Texture& texture, const std::string& filename) { return loadFromAsset(texture, filename); }
+	};
+
+	struct ResidencyStats
+	{
+		std::size_t budgetBytes;
+		std::size_t residentBytes;
+		unsigned residentCount;
+		unsigned evictions;
+		unsigned reloads;
+	};
+
 	template <typename Resource>
 	class ResourceManager
 	{
@@ -24,16 +60,49 @@ namespace te
 
 		ResourceID<Resource> store(std::unique_ptr<Resource>&&);
 
+		// Reloads the resource first if it was evicted.
 		Resource& get(ResourceID<Resource> id);
 		const Resource& get(ResourceID<Resource> id) const;
 
+		// Frees the resource. Its id must not be used again.
+		void erase(ResourceID<Resource> id);
+
+		// Anything that keeps a pointer from get past the current frame, such
+		// as a sprite or a map layer, holds a reference so it is not evicted.
+		void acquire(ResourceID<Resource> id);
+		void release(ResourceID<Resource> id);
+
+		// Loaded resources that are unreferenced and were not used this frame
+		// are evicted, least recently used first, while over budget. A budget
+		// of 0 keeps everything.
+		void setBudget(std::size_t budgetBytes);
+		void nextFrame();
+		ResidencyStats getStats() const;
+
 	private:
+		struct Residency
+		{
+			std::string filename;
+			std::size_t bytes;
+			unsigned lastUse;
+			int refCount;
+			bool resident;
+		};
+
 		ResourceID<Resource> insertResource(std::unique_ptr<Resource>&& pResource);
 		void insertFilename(const std::string& filename, int id);
+		void touch(int idValue) const;
+		void trim();
 
 		int m_NextID;
 		std::map<int, std::unique_ptr<Resource>> m_ResourceMap;
 		std::map<std::string, int> m_FilenameMap;
+		mutable std::map<int, Residency> m_Residency;
+		mutable std::size_t m_ResidentBytes;
+		mutable unsigned m_Reloads;
+		std::size_t m_Budget;
+		unsigned m_Frame;
+		unsigned m_Evictions;
 	};
 }
 
@@ -4,6 +4,13 @@ namespace te
 	ResourceManager<Resource>::ResourceManager()
 		: m_NextID{1}
 		, m_ResourceMap{}
+		, m_FilenameMap{}
+		, m_Residency{}
+		, m_ResidentBytes{0}
+		, m_Reloads{0}
+		, m_Budget{0}
+		, m_Frame{0}
+		, m_Evictions{0}
 	{
 	}
 
@@ -12,14 +19,22 @@ namespace te
 	ResourceID<Resource> ResourceManager<Resource>::load(const std::string& filename, Args&&... args)
 	{
 		auto found = m_FilenameMap.find(filename);
-		if (found != m_FilenameMap.end()) return {found->second};
+		if (found != m_FilenameMap.end())
+		{
+			touch(found->second);
+			return {found->second};
+		}
 
 		auto pResource = std::make_unique<Resource>(std::forward<Args>(args)...);
-		if (!pResource->loadFromFile(filename))
+		if (!loadFromAsset(*pResource, filename))
 			throw std::runtime_error{"ResourceManager::load: failed to load " + filename};
 
+		std::size_t bytes = ResidencyTraits<Resource>::byteSize(*pResource);
 		auto id = insertResource(std::move(pResource));
 		insertFilename(filename, id.value);
+		m_Residency.insert(std::make_pair(id.value, Residency{filename, bytes, m_Frame, 0, true}));
+		m_ResidentBytes += bytes;
+		trim();
 		return id;
 	}
 
@@ -34,6 +49,7 @@ namespace te
 	{
 		auto found = m_ResourceMap.find(id.value);
 		assert(found != m_ResourceMap.end());
+		touch(id.value);
 		return *found->second;
 	}
 
@@ -42,9 +58,27 @@ namespace te
 	{
 		auto found = m_ResourceMap.find(id.value);
 		assert(found != m_ResourceMap.end());
+		touch(id.value);
 		return *found->second;
 	}
 
+	template <typename Resource>
+	void ResourceManager<Resource>::erase(ResourceID<Resource> id)
+	{
+		auto found = m_ResourceMap.find(id.value);
+		assert(found != m_ResourceMap.end());
+		m_ResourceMap.erase(found);
+
+		auto residency = m_Residency.find(id.value);
+		if (residency != m_Residency.end())
+		{
+			assert(residency->second.refCount == 0);
+			if (residency->second.resident) m_ResidentBytes -= residency->second.bytes;
+			m_FilenameMap.erase(residency->second.filename);
+			m_Residency.erase(residency);
+		}
+	}
+
 	template <typename Resource>
 	ResourceID<Resource> ResourceManager<Resource>::insertResource(std::unique_ptr<Resource>&& pResource)
 	{
@@ -59,4 +93,85 @@ namespace te
 		auto inserted = m_FilenameMap.insert(std::make_pair(filename, idValue));
 		assert(inserted.second);
 	}
+
+	template <typename Resource>
+	void ResourceManager<Resource>::acquire(ResourceID<Resource> id)
+	{
+		auto found = m_Residency.find(id.value);
+		if (found != m_Residency.end()) ++found->second.refCount;
+	}
+
+	template <typename Resource>
+	void ResourceManager<Resource>::release(ResourceID<Resource> id)
+	{
+		auto found = m_Residency.find(id.value);
+		if (found == m_Residency.end()) return;
+		assert(found->second.refCount > 0);
+		--found->second.refCount;
+	}
+
+	template <typename Resource>
+	void ResourceManager<Resource>::setBudget(std::size_t budgetBytes)
+	{
+		m_Budget = budgetBytes;
+		trim();
+	}
+
+	template <typename Resource>
+	void ResourceManager<Resource>::nextFrame()
+	{
+		++m_Frame;
+		trim();
+	}
+
+	template <typename Resource>
+	ResidencyStats ResourceManager<Resource>::getStats() const
+	{
+		ResidencyStats stats{m_Budget, m_ResidentBytes, 0, m_Evictions, m_Reloads};
+		for (auto& pair : m_Residency)
+		{
+			if (pair.second.resident) ++stats.residentCount;
+		}
+		return stats;
+	}
+
+	template <typename Resource>
+	void ResourceManager<Resource>::touch(int idValue) const
+	{
+		auto found = m_Residency.find(idValue);
+		if (found == m_Residency.end()) return;
+
+		Residency& residency = found->second;
+		residency.lastUse = m_Frame;
+		if (residency.resident) return;
+
+		Resource& resource = *m_ResourceMap.find(idValue)->second;
+		if (!ResidencyTraits<Resource>::reload(resource, residency.filename))
+			throw std::runtime_error{"ResourceManager::get: failed to reload " + residency.filename};
+		residency.bytes = ResidencyTraits<Resource>::byteSize(resource);
+		residency.resident = true;
+		m_ResidentBytes += residency.bytes;
+		++m_Reloads;
+	}
+
+	template <typename Resource>
+	void ResourceManager<Resource>::trim()
+	{
+		while (m_Budget != 0 && m_ResidentBytes > m_Budget)
+		{
+			auto victim = m_Residency.end();
+			for (auto it = m_Residency.begin(); it != m_Residency.end(); ++it)
+			{
+				const Residency& residency = it->second;
+				if (!residency.resident || residency.refCount > 0 || residency.bytes == 0 || residency.lastUse >= m_Frame) continue;
+				if (victim == m_Residency.end() || residency.lastUse < victim->second.lastUse) victim = it;
+			}
+			if (victim == m_Residency.end()) break;
+
+			ResidencyTraits<Resource>::unload(*m_ResourceMap.find(victim->first)->second);
+			m_ResidentBytes -= victim->second.bytes;
+			victim->second.resident = false;
+			++m_Evictions;
+		}
+	}
 }
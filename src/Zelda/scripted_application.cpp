@@ -1,5 +1,6 @@
 #include "scripted_application.h"
 #include "utilities.h"
+#include "../TantechEngine/asset_pack.h"
 #include "scripted_game.h"
 #include "state_stack.h"
 
@@ -20,6 +21,7 @@ namespace te
 	{
 		lua_State* L = mpL.get();
 		luaL_openlibs(L);
+		openAssetLoaders(L);
 		doLuaFile(*L, filename);
 
 		lua_atpanic(L, &panic);
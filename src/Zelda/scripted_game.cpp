@@ -1,5 +1,6 @@
 #include "scripted_game.h"
 #include "utilities.h"
+#include "../TantechEngine/asset_pack.h"
 #include "tmx.h"
 #include "tile_map.h"
 #include "scripted_entity.h"
@@ -120,6 +121,7 @@ namespace te
 		lua_State* L = mpL.get();
 
 		luaL_openlibs(L);
+		openAssetLoaders(L);
 
 		luabridge::getGlobalNamespace(L)
 			.beginNamespace("Event")
@@ -4,13 +4,14 @@
 #include "tmx.h"
 #include "tile_map_layer.h"
 #include "texture_atlas.h"
+#include "collider_baking.h"
+#include "physics_queries.h"
 
 #include <lua.hpp>
 #include <LuaBridge.h>
 
 #include <regex>
 #include <cassert>
-#include <array>
 
 namespace te
 {
@@ -37,6 +38,7 @@ namespace te
 			void addTileLayer(ResourceID<TileMapLayer> id, int sortingLayer)
 			{
 				m_rData.mapLayers.insert(m_ID, { m_rData.mapLayerHolder.get(id), sortingLayer });
+				m_rData.mapLayerUses[id.value].entities.push_back(m_ID);
 			}
 
 			void addRigidBody(int type)
@@ -49,6 +51,20 @@ namespace te
 					m_rData.physicsWorld.CreateBody(&bodyDef),
 					[pPhysicsWorld](b2Body* pBody) { pPhysicsWorld->DestroyBody(pBody); }
 				};
+				m_rData.rigidBodies[m_ID]->SetUserData(toUserData(m_ID));
+			}
+
+			// Sets the category bits of every fixture on the body, which
+			// Game:getContacts filters by.
+			void setCollisionCategory(int categoryBits)
+			{
+				auto& body = *m_rData.rigidBodies.at(m_ID);
+				for (b2Fixture* pFixture = body.GetFixtureList(); pFixture; pFixture = pFixture->GetNext())
+				{
+					b2Filter filter = pFixture->GetFilterData();
+					filter.categoryBits = static_cast<uint16>(categoryBits);
+					pFixture->SetFilterData(filter);
+				}
 			}
 
 			void addFixtureRect(luabridge::LuaRef rect)
@@ -56,17 +72,49 @@ namespace te
 				assert(rect.isTable());
 				auto& body = *m_rData.rigidBodies.at(m_ID);
 
-				b2PolygonShape shape;
 				float x = rect["x"], y = rect["y"], w = rect["w"], h = rect["h"];
-				std::array<b2Vec2, 4> points = {
-					b2Vec2{ x, y },
-					b2Vec2{ x + w, y },
-					b2Vec2{ x + w, y + h },
-					b2Vec2{ x, y + h }
-				};
-				shape.Set(points.data(), 4);
+				std::vector<sf::FloatRect> rects{ sf::FloatRect{ x, y, w, h } };
+				createRectFixtures(body, rects);
+				shareScenery(body, rects);
+			}
 
-				body.CreateFixture(&shape, 0);
+			// Adds the rects of an object group as merged fixtures, far fewer
+			// than one per rect. Returns { before = n, after = m } fixture counts.
+			luabridge::LuaRef addMergedCollisionLayer(ResourceID<TMX> tmxID, const std::string& layerName)
+			{
+				auto& body = *m_rData.rigidBodies.at(m_ID);
+
+				std::vector<TMX::Object> objects;
+				getObjectsInGroup(get(m_rData, tmxID), layerName, std::back_inserter(objects));
+				std::vector<sf::FloatRect> rects;
+				rects.reserve(objects.size());
+				for (const auto& object : objects)
+				{
+					rects.push_back({ (float)object.x, (float)object.y, (float)object.width, (float)object.height });
+				}
+				mergeRects(rects);
+				createRectFixtures(body, rects);
+				shareScenery(body, rects);
+
+				luabridge::LuaRef counts = luabridge::newTable(m_rData.pL.get());
+				counts["before"] = (int)objects.size();
+				counts["after"] = (int)rects.size();
+				return counts;
+			}
+
+			// Static rects of the main world are copied into the physics
+			// regions, so bodies in them still hit the walls.
+			void shareScenery(const b2Body& body, std::vector<sf::FloatRect> rects)
+			{
+				if (body.GetType() != b2_staticBody || body.GetWorld() != &m_rData.physicsWorld) return;
+
+				b2Vec2 position = body.GetPosition();
+				for (auto& rect : rects)
+				{
+					rect.left += position.x;
+					rect.top += position.y;
+				}
+				m_rData.physicsRegions.addStaticRects(rects, m_ID);
 			}
 
 			GameData& m_rData;
@@ -74,9 +122,18 @@ namespace te
 		};
 
 		GameData& m_rData;
+		// Kept between casts for their storage.
+		std::vector<RayQuery> m_RayQueries;
+		std::vector<BoxCast> m_BoxCasts;
+		std::vector<QueryHit> m_QueryHits;
+		std::vector<const b2World*> m_QueryWorlds;
 
 		Impl::Impl(GameData& data)
 			: m_rData{ data }
+			, m_RayQueries{}
+			, m_BoxCasts{}
+			, m_QueryHits{}
+			, m_QueryWorlds{}
 		{
 			lua_State* L = m_rData.pL.get();
 
@@ -96,8 +153,13 @@ namespace te
 					.addFunction("makeEntity", &Impl::makeEntity)
 					.addFunction("loadTMX", &Impl::loadTMX)
 					.addFunction("makeTileLayers", &Impl::makeTileLayers)
+					.addFunction("dropTileLayers", &Impl::dropTileLayers)
 					.addFunction("getTileLayerIndex", &Impl::getTileLayerIndex)
 					.addFunction("getObjectsInLayer", &Impl::getObjectsInLayer)
+					.addFunction("addPhysicsRegions", &Impl::addPhysicsRegions)
+					.addFunction("getContacts", &Impl::getContacts)
+					.addFunction("castRays", &Impl::castRays)
+					.addFunction("castBoxes", &Impl::castBoxes)
 					.addFunction("loadAtlas", &Impl::loadAtlas)
 				.endClass()
 				.beginClass<ProxyEntity>("Entity")
@@ -105,6 +167,8 @@ namespace te
 					.addFunction("addTileLayer", &ProxyEntity::addTileLayer)
 					.addFunction("addRigidBody", &ProxyEntity::addRigidBody)
 					.addFunction("addFixtureRect", &ProxyEntity::addFixtureRect)
+					.addFunction("addMergedCollisionLayer", &ProxyEntity::addMergedCollisionLayer)
+					.addFunction("setCollisionCategory", &ProxyEntity::setCollisionCategory)
 				.endClass();
 
 			doLuaFile(*L, m_rData.config.initialScript);
@@ -162,15 +226,142 @@ namespace te
 			TMX& tmx = m_rData.tmxHolder.get(id);
 			std::vector<std::string> tilesetFilenames{};
 			getTilesetFilenames(tmx, std::back_inserter(tilesetFilenames));
+			std::vector<ResourceID<sf::Texture>> textureIDs{};
+			std::transform(tilesetFilenames.begin(), tilesetFilenames.end(), std::back_inserter(textureIDs), [this](const std::string& filename) {
+				return m_rData.textureHolder.load(filename);
+			});
 			std::vector<const sf::Texture*> textures{};
 			//ResourceManager<sf::Texture>& textureManager = getTextureManager();
-			std::transform(tilesetFilenames.begin(), tilesetFilenames.end(), std::back_inserter(textures), [this](const std::string& filename) {
-				return &m_rData.textureHolder.get(m_rData.textureHolder.load(filename));
+			std::transform(textureIDs.begin(), textureIDs.end(), std::back_inserter(textures), [this](ResourceID<sf::Texture> textureID) {
+				return &m_rData.textureHolder.get(textureID);
 			});
 			std::vector<TileMapLayer> layers{};
 			TileMapLayer::make(tmx, textures.begin(), textures.end(), std::back_inserter(layers));
-			for (auto& layer : layers) table[layer.getName()] = m_rData.mapLayerHolder.store(std::make_unique<TileMapLayer>(layer));
+			for (auto& layer : layers)
+			{
+				ResourceID<TileMapLayer> layerID = m_rData.mapLayerHolder.store(std::make_unique<TileMapLayer>(layer));
+				// The layer keeps the texture pointers until it is dropped.
+				for (auto textureID : textureIDs) m_rData.textureHolder.acquire(textureID);
+				m_rData.mapLayerUses[layerID.value].textures = textureIDs;
+				table[layer.getName()] = layerID;
+			}
+
+			return table;
+		}
+
+		// Takes a table of layers from makeTileLayers off every entity
+		// drawing them and frees them, so their textures can be evicted.
+		void dropTileLayers(luabridge::LuaRef layers)
+		{
+			assert(layers.isTable());
+			for (luabridge::Iterator it(layers); !it.isNil(); ++it)
+			{
+				ResourceID<TileMapLayer> layerID = it.value().cast<ResourceID<TileMapLayer>>();
+				const TileMapLayer& layer = m_rData.mapLayerHolder.get(layerID);
+				auto use = m_rData.mapLayerUses.find(layerID.value);
+				assert(use != m_rData.mapLayerUses.end());
+
+				for (EntityID entity : use->second.entities)
+				{
+					m_rData.mapLayers.eraseIf(entity, [&layer](const Renderable<TileMapLayer>& drawn) {
+						return drawn.drawable.getIndex() == layer.getIndex() && drawn.drawable.getName() == layer.getName();
+					});
+				}
+				for (auto textureID : use->second.textures) m_rData.textureHolder.release(textureID);
 
+				m_rData.mapLayerUses.erase(use);
+				m_rData.mapLayerHolder.erase(layerID);
+			}
+		}
+
+		// Makes a physics region of each object in the layer. Returns how
+		// many there are.
+		int addPhysicsRegions(ResourceID<TMX> tmxID, const std::string& layerName)
+		{
+			std::vector<TMX::Object> objects;
+			getObjectsInGroup(get(m_rData, tmxID), layerName, std::back_inserter(objects));
+			for (const auto& object : objects)
+			{
+				m_rData.physicsRegions.addRegion({ (float)object.x, (float)object.y, (float)object.width, (float)object.height });
+			}
+			return static_cast<int>(objects.size());
+		}
+
+		// Every contact since the last fixed update involving a fixture in
+		// one of the categories, as a list of
+		// { began = bool, a = id, b = id, normal = Vec, point = Vec }.
+		// Bodies without an entity have id -1.
+		luabridge::LuaRef getContacts(int categoryBits)
+		{
+			lua_State* L = m_rData.pL.get();
+			luabridge::LuaRef table = luabridge::newTable(L);
+
+			int index = 1;
+			m_rData.contactEvents.forEach(static_cast<uint16>(categoryBits), [L, &table, &index](const ContactEvent& evt) {
+				luabridge::LuaRef contact = luabridge::newTable(L);
+				contact["began"] = evt.type == ContactEvent::BEGIN;
+				contact["a"] = evt.a;
+				contact["b"] = evt.b;
+				contact["normal"] = evt.normal;
+				contact["point"] = evt.point;
+				table[index++] = contact;
+			});
+			return table;
+		}
+
+		// Batched ray and box casts. Queries come in as one flat array,
+		// { x1, y1, x2, y2, ... } for rays and { x, y, w, h, dx, dy, ... }
+		// for boxes, and only hit fixtures in categoryBits. The closest hit
+		// of each comes back in one flat array too, seven values a query:
+		// hit, entity, fraction, point x, point y, normal x, normal y.
+		luabridge::LuaRef castRays(luabridge::LuaRef rays, int categoryBits)
+		{
+			std::vector<RayQuery>& queries = m_RayQueries;
+			queries.resize(rays.length() / 4);
+			for (std::size_t i = 0; i < queries.size(); ++i)
+			{
+				int base = static_cast<int>(i) * 4;
+				queries[i].from = { rays[base + 1].cast<float>(), rays[base + 2].cast<float>() };
+				queries[i].to = { rays[base + 3].cast<float>(), rays[base + 4].cast<float>() };
+				queries[i].filter = QueryFilter{};
+				queries[i].filter.categoryBits = static_cast<uint16>(categoryBits);
+			}
+			m_rData.physicsRegions.getWorlds(m_QueryWorlds);
+			te::castRays(m_QueryWorlds, queries, m_QueryHits, m_rData.pJobPool.get());
+			return packHits(m_QueryHits);
+		}
+
+		luabridge::LuaRef castBoxes(luabridge::LuaRef boxes, int categoryBits)
+		{
+			std::vector<BoxCast>& queries = m_BoxCasts;
+			queries.resize(boxes.length() / 6);
+			for (std::size_t i = 0; i < queries.size(); ++i)
+			{
+				int base = static_cast<int>(i) * 6;
+				queries[i].box = { boxes[base + 1].cast<float>(), boxes[base + 2].cast<float>(), boxes[base + 3].cast<float>(), boxes[base + 4].cast<float>() };
+				queries[i].translation = { boxes[base + 5].cast<float>(), boxes[base + 6].cast<float>() };
+				queries[i].filter = QueryFilter{};
+				queries[i].filter.categoryBits = static_cast<uint16>(categoryBits);
+			}
+			m_rData.physicsRegions.getWorlds(m_QueryWorlds);
+			te::castBoxes(m_QueryWorlds, queries, m_QueryHits, m_rData.pJobPool.get());
+			return packHits(m_QueryHits);
+		}
+
+		luabridge::LuaRef packHits(const std::vector<QueryHit>& hits)
+		{
+			luabridge::LuaRef table = luabridge::newTable(m_rData.pL.get());
+			int index = 1;
+			for (const auto& hit : hits)
+			{
+				table[index++] = hit.hit;
+				table[index++] = hit.entity;
+				table[index++] = hit.fraction;
+				table[index++] = hit.point.x;
+				table[index++] = hit.point.y;
+				table[index++] = hit.normal.x;
+				table[index++] = hit.normal.y;
+			}
 			return table;
 		}
 
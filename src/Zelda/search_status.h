@@ -0,0 +1,15 @@
+#ifndef TE_SEARCH_STATUS_H
+#define TE_SEARCH_STATUS_H
+
+namespace te
+{
+	// What a search that can be run a few expansions at a time has come to.
+	enum class SearchStatus
+	{
+		FOUND,
+		NOT_FOUND,
+		INCOMPLETE
+	};
+}
+
+#endif
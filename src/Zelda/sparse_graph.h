@@ -8,6 +8,7 @@
 
 #include <vector>
 #include <list>
+#include <set>
 #include <algorithm>
 
 namespace te
@@ -104,6 +105,16 @@ namespace te
 			}
 		}
 
+		// Adds only the from-to half of the edge, at the end of from's list,
+		// for copying edge lists that already hold both halves.
+		void addHalfEdge(const Edge& edge)
+		{
+			throwIfInvalid(edge.getFrom());
+			throwIfInvalid(edge.getTo());
+
+			mEdges.at(edge.getFrom()).push_back(edge);
+		}
+
 		void removeEdge(int from, int to)
 		{
 			throwIfInvalid(from);
@@ -293,7 +304,7 @@ namespace te
 		sf::VertexArray mLineVertices;
 	};
 
-	template<> void SparseGraph<NavGraphNode, NavGraphEdge>::prepareVerticesForDrawing()
+	template<> inline void SparseGraph<NavGraphNode, NavGraphEdge>::prepareVerticesForDrawing()
 	{
 		mLineVertices.clear();
 		mLineVertices.setPrimitiveType(sf::Lines);
@@ -308,7 +319,7 @@ namespace te
 		});
 	}
 
-	template<> void SparseGraph<NavGraphNode, NavGraphEdge>::draw(sf::RenderTarget& target, sf::RenderStates states) const
+	template<> inline void SparseGraph<NavGraphNode, NavGraphEdge>::draw(sf::RenderTarget& target, sf::RenderStates states) const
 	{
 		target.draw(mLineVertices, states);
 	}
@@ -1,6 +1,7 @@
 #include "steering_behaviors.h"
 #include "vector_ops.h"
 #include "vehicle.h"
+#include "flow_field.h"
 
 namespace te
 {
@@ -15,6 +16,7 @@ namespace te
 		, mArriveEnabled(false)
 		, mArriveTarget()
 		, mDeceleration(Deceleration::Normal)
+		, mpFlowField(nullptr)
 	{}
 
 	sf::Vector2f SteeringBehaviors::calculate()
@@ -37,6 +39,11 @@ namespace te
 			force = arrive(mArriveTarget, mDeceleration);
 			if (!accumulateForce(mSteeringForce, force)) return mSteeringForce;
 		}
+		if (mpFlowField)
+		{
+			force = followFlowField(*mpFlowField);
+			if (!accumulateForce(mSteeringForce, force)) return mSteeringForce;
+		}
 
 		return mSteeringForce;
 	}
@@ -61,6 +68,11 @@ namespace te
 		mDeceleration = deceleration;
 	}
 
+	void SteeringBehaviors::setFlowFieldEnabled(bool enabled, const FlowField* pFlowField)
+	{
+		mpFlowField = enabled ? pFlowField : nullptr;
+	}
+
 	sf::Vector2f SteeringBehaviors::seek(sf::Vector2f target) const
 	{
 		sf::Vector2f desiredVelocity = normalize(target - mOwner.getPosition()) * mOwner.getMaxSpeed();
@@ -100,6 +112,21 @@ namespace te
 		return sf::Vector2f(0.f, 0.f);
 	}
 
+	sf::Vector2f SteeringBehaviors::followFlowField(const FlowField& flowField) const
+	{
+		sf::Vector2f direction = flowField.getDirection(mOwner.getPosition());
+		if (direction == sf::Vector2f(0.f, 0.f))
+		{
+			// Unreachable tiles have no direction either; only seek on the
+			// goal's own tile.
+			if (flowField.getCost(mOwner.getPosition()) != 0.f) return sf::Vector2f(0.f, 0.f);
+			return seek(flowField.getGoal());
+		}
+
+		sf::Vector2f desiredVelocity = direction * mOwner.getMaxSpeed();
+		return (desiredVelocity - mOwner.getVelocity());
+	}
+
 	bool SteeringBehaviors::isSeekEnabled() const
 	{
 		return mSeekEnabled;
@@ -111,6 +138,11 @@ namespace te
 		return mSeekEnabled;
 	}
 
+	bool SteeringBehaviors::isFlowFieldEnabled() const
+	{
+		return mpFlowField != nullptr;
+	}
+
 	bool SteeringBehaviors::accumulateForce(sf::Vector2f& accumulator, sf::Vector2f force) const
 	{
 		float magnitude = length(accumulator);
@@ -8,6 +8,7 @@ namespace te
 	class MovingEntity;
 	class BaseGameEntity;
 	class Wall2f;
+	class FlowField;
 
 	class SteeringBehaviors
 	{
@@ -24,14 +25,19 @@ namespace te
 		void setSeekEnabled(bool enabled, sf::Vector2f target = sf::Vector2f(0.f, 0.f));
 		void setFleeEnabled(bool enabled, sf::Vector2f target = sf::Vector2f(0.f, 0.f), float panicDistance = 0.f);
 		void setArriveEnabled(bool enabled, sf::Vector2f target = sf::Vector2f(0.f, 0.f), Deceleration deceleration = Deceleration::Normal);
+		// Heads along the field toward its goal, and straight for the goal
+		// once on the goal's tile.
+		void setFlowFieldEnabled(bool enabled, const FlowField* pFlowField = nullptr);
 
 		bool isSeekEnabled() const;
 		bool isSeekEnabled(sf::Vector2f& target) const;
+		bool isFlowFieldEnabled() const;
 
 	private:
 		sf::Vector2f seek(sf::Vector2f target) const;
 		sf::Vector2f flee(sf::Vector2f target, float panicDistance = 0.f) const;
 		sf::Vector2f arrive(sf::Vector2f target, Deceleration deceleration) const;
+		sf::Vector2f followFlowField(const FlowField& flowField) const;
 
 		sf::Vector2f pursuit(const TargetEntity& target) const;
 		sf::Vector2f evade(const TargetEntity& target) const;
@@ -59,6 +65,8 @@ namespace te
 		bool mArriveEnabled;
 		sf::Vector2f mArriveTarget;
 		Deceleration mDeceleration;
+
+		const FlowField* mpFlowField;
 	};
 }
 
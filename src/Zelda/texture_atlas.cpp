@@ -1,9 +1,9 @@
 #include "texture_atlas.h"
 #include "texture_manager.h"
 #include "utilities.h"
+#include "../TantechEngine/asset_pack.h"
 
 #include <rapidxml.hpp>
-#include <rapidxml_utils.hpp>
 
 #include <algorithm>
 #include <regex>
@@ -21,7 +21,7 @@ namespace te
 
 	bool TextureAtlas::loadFromFile(const std::string& filename)
 	{
-		rapidxml::file<> atlasFile(filename.c_str());
+		std::vector<char> atlasFile = readAssetText(filename);
 		rapidxml::xml_document<> atlasXML;
 		atlasXML.parse<0>(atlasFile.data());
 
@@ -3,31 +3,13 @@
 #include "vector_ops.h"
 #include "game.h"
 #include "rigid_body.h"
+#include "nav_graph_baking.h"
 
 #include <algorithm>
 #include <limits>
 
 namespace te
 {
-	static float calculateAverageGraphEdgeLength(const TileMap::NavGraph& navGraph)
-	{
-		float totalLength = 0;
-		int numEdgesCounted = 0;
-
-		TileMap::NavGraph::ConstNodeIterator nodeIter(navGraph);
-		for (const TileMap::NavGraph::Node* pNode = nodeIter.begin(); !nodeIter.end(); pNode = nodeIter.next())
-		{
-			TileMap::NavGraph::ConstEdgeIterator edgeIter(navGraph, pNode->getIndex());
-			for (const TileMap::NavGraph::Edge* pEdge = edgeIter.begin(); !edgeIter.end(); pEdge = edgeIter.next())
-			{
-				++numEdgesCounted;
-				totalLength += distance(navGraph.getNode(pEdge->getFrom()).getPosition(), navGraph.getNode(pEdge->getTo()).getPosition());
-			}
-		}
-
-		return totalLength / numEdgesCounted;
-	}
-
 	std::unique_ptr<TileMap> TileMap::make(Game& world, TextureManager& textureManager, const TMX& tmx)
 	{
 		return std::unique_ptr<TileMap>(new TileMap(world, textureManager, tmx));
@@ -39,10 +21,19 @@ namespace te
 		, mWorld(world)
 		, mTextures()
 		, mpCollider(nullptr)
+		, mpWorldCollider(nullptr)
+		, mWorldColliderTransform()
 		, mpNavGraph(nullptr)
+		, mpCompactNavGraph(nullptr)
+		, mpHierarchicalNavGraph(nullptr)
+		, mpNavNodeLookup(nullptr)
+		, mPlanner(Planner::NAV_GRAPH)
+		, mpWalkableGrid(nullptr)
+		, mpOpenWalkableGrid(nullptr)
+		, mNodeOfTile()
+		, mGridMoves(JumpPointSearch::Moves::DIAGONAL)
+		, mpFlowField(nullptr)
 		, mDrawFlags(0)
-		, mCellSpaceNeighborhoodRange(1)
-		, mpCellSpacePartition(nullptr)
 	{
 		addComponent<RigidBody>(b2_staticBody);
 		setDrawOrder(std::numeric_limits<int>::max());
@@ -66,16 +57,36 @@ namespace te
 
 		mpCollider = std::unique_ptr<CompositeCollider>(mTMX.makeCollider(transform));
 
-		mpNavGraph = std::unique_ptr<NavGraph>(mTMX.makeNavGraph(transform));
+		std::string planner = mTMX.getProperty("planner", "navgraph");
+		if (planner == "grid") mPlanner = Planner::GRID;
+		else if (planner != "navgraph") throw std::runtime_error{"Unsupported TMX planner."};
 
-		mCellSpaceNeighborhoodRange = calculateAverageGraphEdgeLength(*mpNavGraph) + 1;
+		std::string moves = mTMX.getProperty("grid_moves", "diagonal");
+		if (moves == "straight") mGridMoves = JumpPointSearch::Moves::STRAIGHT;
+		else if (moves == "no_corner_cutting") mGridMoves = JumpPointSearch::Moves::DIAGONAL_NO_CORNER_CUTTING;
+		else if (moves != "diagonal") throw std::runtime_error{"Unsupported TMX grid_moves."};
 
-		mpCellSpacePartition = std::make_unique<NavCellSpace>((float)mTMX.getTileWidth() / mTMX.getWidth(), (float)mTMX.getTileHeight() * mTMX.getHeight(), mTMX.getWidth() / 4, mTMX.getHeight() / 4, mpNavGraph->numNodes());
+		mpWalkableGrid = std::unique_ptr<WalkableGrid>(mTMX.makeWalkableGrid(transform));
+		mpOpenWalkableGrid = std::make_unique<WalkableGrid>(*mpWalkableGrid);
+		mpFlowField = std::make_unique<FlowField>(*mpWalkableGrid, mGridMoves, &mWorld.getJobPool());
 
-		TileMap::NavGraph::ConstNodeIterator nodeIter(*mpNavGraph);
-		for (const TileMap::NavGraph::Node* pNode = nodeIter.begin(); !nodeIter.end(); pNode = nodeIter.next())
+		if (mPlanner == Planner::NAV_GRAPH)
 		{
-			mpCellSpacePartition->addEntity(pNode);
+			// Made from the walkable tiles already found rather than through
+			// TMX::makeNavGraph, which would find them again.
+			mpCompactNavGraph = std::unique_ptr<CompactNavGraph>(makeTileNavGraph(*mpWalkableGrid, &mWorld.getJobPool()));
+			mpNavGraph = std::unique_ptr<NavGraph>(makeSparseNavGraph(*mpCompactNavGraph));
+			mpHierarchicalNavGraph = std::make_unique<HierarchicalNavGraph>(*mpCompactNavGraph,
+				sf::Vector2f((float)mTMX.getTileWidth(), (float)mTMX.getTileHeight()), sf::Vector2i(mTMX.getWidth(), mTMX.getHeight()));
+			mpNavNodeLookup = std::make_unique<NavNodeLookup>(*mpWalkableGrid, *mpCompactNavGraph, mGridMoves);
+
+			mNodeOfTile.assign(mpWalkableGrid->getWidth() * mpWalkableGrid->getHeight(), NavNodeLookup::NO_NODE);
+			for (int node = 0; node < mpCompactNavGraph->numNodes(); ++node)
+			{
+				if (!mpCompactNavGraph->isActive(node)) continue;
+				sf::Vector2i tile = mpWalkableGrid->getTile(mpCompactNavGraph->getPosition(node));
+				mNodeOfTile[tile.y * mpWalkableGrid->getWidth() + tile.x] = node;
+			}
 		}
 
 		std::vector<b2Fixture*> fixtures;
@@ -87,11 +98,101 @@ namespace te
 		return mpCollider->getWalls();
 	}
 
+	TileMap::Planner TileMap::getPlanner() const
+	{
+		return mPlanner;
+	}
+
+	const WalkableGrid& TileMap::getWalkableGrid() const
+	{
+		return *mpWalkableGrid;
+	}
+
+	JumpPointSearch::Moves TileMap::getGridMoves() const
+	{
+		return mGridMoves;
+	}
+
+	FlowField& TileMap::getFlowField()
+	{
+		return *mpFlowField;
+	}
+
+	void TileMap::onUpdate(const sf::Time& dt)
+	{
+		mpFlowField->update();
+	}
+
 	const TileMap::NavGraph& TileMap::getNavGraph() const
 	{
 		return *mpNavGraph;
 	}
 
+	const CompactNavGraph& TileMap::getCompactNavGraph() const
+	{
+		return *mpCompactNavGraph;
+	}
+
+	HierarchicalNavGraph& TileMap::getHierarchicalNavGraph()
+	{
+		return *mpHierarchicalNavGraph;
+	}
+
+	const NavNodeLookup& TileMap::getNavNodeLookup() const
+	{
+		return *mpNavNodeLookup;
+	}
+
+	void TileMap::setNavNodesEnabled(const std::vector<int>& nodes, bool enabled)
+	{
+		// Line of sight, grid searches and the nearest node lookup all go by
+		// the tiles, so they change along with the nodes.
+		std::vector<sf::Vector2i> tiles;
+		tiles.reserve(nodes.size());
+		for (int node : nodes)
+		{
+			sf::Vector2i tile = mpWalkableGrid->getTile(mpCompactNavGraph->getPosition(node));
+			mpWalkableGrid->setWalkable(tile.x, tile.y, enabled);
+			mpCompactNavGraph->setActive(node, enabled);
+			tiles.push_back(tile);
+		}
+		mpHierarchicalNavGraph->update(nodes);
+		mpNavNodeLookup->update(nodes);
+		mpFlowField->markDirty(tiles);
+	}
+
+	void TileMap::setAreaWalkable(const sf::FloatRect& area, bool walkable)
+	{
+		const WalkableGrid& grid = *mpOpenWalkableGrid;
+		sf::FloatRect localArea = getTransform().getInverse().transformRect(area);
+		sf::Vector2i first = grid.getTile({ localArea.left, localArea.top });
+		sf::Vector2i last = grid.getTile({ localArea.left + localArea.width, localArea.top + localArea.height });
+
+		std::vector<int> nodes;
+		std::vector<sf::Vector2i> tiles;
+		for (int y = std::max(first.y, 0); y <= std::min(last.y, grid.getHeight() - 1); ++y)
+		{
+			for (int x = std::max(first.x, 0); x <= std::min(last.x, grid.getWidth() - 1); ++x)
+			{
+				if (!grid.isWalkable(x, y) || !localArea.contains(grid.getTileCenter({ x, y }))) continue;
+
+				int node = mNodeOfTile.empty() ? NavNodeLookup::NO_NODE : mNodeOfTile[y * grid.getWidth() + x];
+				if (node != NavNodeLookup::NO_NODE)
+				{
+					nodes.push_back(node);
+				}
+				else
+				{
+					mpWalkableGrid->setWalkable(x, y, walkable);
+					tiles.push_back({ x, y });
+				}
+			}
+		}
+
+		if (!nodes.empty()) setNavNodesEnabled(nodes, walkable);
+		if (!tiles.empty()) mpFlowField->markDirty(tiles);
+	}
+
 	void TileMap::setDrawColliderEnabled(bool enabled)
 	{
 		mDrawFlags = enabled ? mDrawFlags | COLLIDER : mDrawFlags ^ COLLIDER;
@@ -100,38 +201,39 @@ namespace te
 	void TileMap::setDrawNavGraphEnabled(bool enabled)
 	{
 		mDrawFlags = enabled ? mDrawFlags | NAV_GRAPH : mDrawFlags ^ NAV_GRAPH;
-		if (enabled)
+		if (enabled && mpNavGraph)
 			mpNavGraph->prepareVerticesForDrawing();
 	}
 
-	float TileMap::getCellSpaceNeighborhoodRange() const
-	{
-		return mCellSpaceNeighborhoodRange;
-	}
-
-	TileMap::NavCellSpace& TileMap::getCellSpace()
+	const CompositeCollider& TileMap::getWorldCollider() const
 	{
-		return *mpCellSpacePartition;
+		const sf::Transform& transform = getTransform();
+		if (!mpWorldCollider || !std::equal(transform.getMatrix(), transform.getMatrix() + 16, mWorldColliderTransform.getMatrix()))
+		{
+			mpWorldCollider = std::make_unique<CompositeCollider>(mpCollider->transform(transform));
+			mWorldColliderTransform = transform;
+		}
+		return *mpWorldCollider;
 	}
 
 	bool TileMap::intersects(const BoxCollider& o) const
 	{
-		return mpCollider->transform(getTransform()).intersects(o);
+		return getWorldCollider().intersects(o);
 	}
 
 	bool TileMap::intersects(const BoxCollider& o, sf::FloatRect& collision) const
 	{
-		return mpCollider->transform(getTransform()).intersects(o, collision);
+		return getWorldCollider().intersects(o, collision);
 	}
 
 	bool TileMap::intersects(const CompositeCollider& o) const
 	{
-		return mpCollider->transform(getTransform()).intersects(o);
+		return getWorldCollider().intersects(o);
 	}
 
 	bool TileMap::intersects(const CompositeCollider& o, sf::FloatRect& collision) const
 	{
-		return mpCollider->transform(getTransform()).intersects(o, collision);
+		return getWorldCollider().intersects(o, collision);
 	}
 
 	//void TileMap::stitch(sf::Vector2i tileCoordsA, TileMap& o, sf::Vector2i tileCoordsB) const
@@ -152,7 +254,7 @@ namespace te
 			target.draw(*mpCollider, states);
 		}
 
-		if ((mDrawFlags & NAV_GRAPH) > 0)
+		if ((mDrawFlags & NAV_GRAPH) > 0 && mpNavGraph)
 		{
 			target.draw(*mpNavGraph, states);
 		}
@@ -2,9 +2,14 @@
 #define TE_TILE_MAP_H
 
 #include "sparse_graph.h"
+#include "compact_nav_graph.h"
+#include "hierarchical_nav_graph.h"
+#include "nav_node_lookup.h"
+#include "walkable_grid.h"
+#include "jump_point_search.h"
+#include "flow_field.h"
 #include "tmx.h"
 #include "composite_collider.h"
-#include "cell_space_partition.h"
 #include "base_game_entity.h"
 
 #include <SFML/Graphics.hpp>
@@ -23,7 +28,18 @@ namespace te
 		using Component = int;
 
 		typedef SparseGraph<NavGraphNode, NavGraphEdge> NavGraph;
-		typedef CellSpacePartition<const NavGraph::Node*> NavCellSpace;
+
+		// How paths are planned on this map, chosen with the map's planner
+		// property in Tiled: "navgraph", the default, or "grid". Grid maps
+		// skip the nav graph and are searched tile by tile with Jump Point
+		// Search, moving as the grid_moves property says: "straight",
+		// "diagonal", the default, or "no_corner_cutting". The flow field
+		// moves that way on either kind of map.
+		enum class Planner
+		{
+			NAV_GRAPH,
+			GRID
+		};
 
 		struct Area
 		{
@@ -61,14 +77,36 @@ namespace te
 		}
 
 		const std::vector<Wall2f>& getWalls() const;
+
+		Planner getPlanner() const;
+		const WalkableGrid& getWalkableGrid() const;
+		JumpPointSearch::Moves getGridMoves() const;
+		// Leads to one goal from anywhere on the map, for enemies that all
+		// chase the same thing. Set its goal and it keeps up on its own for
+		// as long as agents follow it. Goal_MoveToPosition follows it
+		// instead of planning a path when heading for the field's goal.
+		FlowField& getFlowField();
+
+		// Only nav graph maps have these.
 		const NavGraph& getNavGraph() const;
+		// The nav graph frozen for searching, with the same node indices.
+		const CompactNavGraph& getCompactNavGraph() const;
+		HierarchicalNavGraph& getHierarchicalNavGraph();
+		// The nearest nav graph node to any position on the map.
+		const NavNodeLookup& getNavNodeLookup() const;
+		// Turns nav graph nodes off or on and shuts or opens the tiles they
+		// are on, then updates the clusters they are in, the nearest node
+		// lookup and the flow field.
+		void setNavNodesEnabled(const std::vector<int>& nodes, bool enabled);
+		// Shuts or opens the walkable tiles whose centres are in area, given
+		// the way getAreasInGroup gives it, for doors and the like. Tiles
+		// that are walls on the map stay shut. On nav graph maps the nodes
+		// on those tiles go off or on with them.
+		void setAreaWalkable(const sf::FloatRect& area, bool walkable);
 
 		void setDrawColliderEnabled(bool enabled);
 		void setDrawNavGraphEnabled(bool enabled);
 
-		float getCellSpaceNeighborhoodRange() const;
-		NavCellSpace& getCellSpace();
-
 		bool intersects(const BoxCollider&) const;
 		bool intersects(const BoxCollider&, sf::FloatRect&) const;
 		bool intersects(const CompositeCollider&) const;
@@ -96,6 +134,10 @@ namespace te
 		TileMap& operator=(const TileMap&) = delete;
 
 		virtual void draw(sf::RenderTarget&, sf::RenderStates) const;
+		void onUpdate(const sf::Time& dt);
+
+		// The collider in world space, rebuilt only when the map has moved.
+		const CompositeCollider& getWorldCollider() const;
 
 		TMX mTMX;
 
@@ -104,11 +146,22 @@ namespace te
 		std::vector<const sf::Texture*> mTextures;
 		//std::vector<std::vector<sf::VertexArray>> mLayers;
 		std::unique_ptr<CompositeCollider> mpCollider;
+		mutable std::unique_ptr<CompositeCollider> mpWorldCollider;
+		mutable sf::Transform mWorldColliderTransform;
 		std::unique_ptr<NavGraph> mpNavGraph;
+		std::unique_ptr<CompactNavGraph> mpCompactNavGraph;
+		std::unique_ptr<HierarchicalNavGraph> mpHierarchicalNavGraph;
+		std::unique_ptr<NavNodeLookup> mpNavNodeLookup;
+		Planner mPlanner;
+		std::unique_ptr<WalkableGrid> mpWalkableGrid;
+		// The walkable tiles with every door open.
+		std::unique_ptr<WalkableGrid> mpOpenWalkableGrid;
+		// The nav graph node on each tile, or NavNodeLookup::NO_NODE.
+		std::vector<int> mNodeOfTile;
+		JumpPointSearch::Moves mGridMoves;
+		std::unique_ptr<FlowField> mpFlowField;
 
 		int mDrawFlags;
-		float mCellSpaceNeighborhoodRange;
-		std::unique_ptr<NavCellSpace> mpCellSpacePartition;
 	};
 }
 
@@ -3,14 +3,18 @@
 #include "texture_manager.h"
 #include "tile_map.h"
 #include "composite_collider.h"
+#include "collider_baking.h"
 #include "nav_graph_node.h"
 #include "nav_graph_edge.h"
+#include "walkable_grid.h"
+#include "compact_nav_graph.h"
+#include "nav_graph_baking.h"
 #include "vector_ops.h"
 #include "utilities.h"
+#include "../TantechEngine/asset_pack.h"
 
 #include <SFML/Graphics.hpp>
 #include <rapidxml.hpp>
-#include <rapidxml_utils.hpp>
 
 #include <algorithm>
 #include <array>
@@ -18,11 +22,6 @@
 #include <cmath>
 #include <sstream>
 
-constexpr bool std::less<sf::Vector2f>::operator()(const sf::Vector2f& a, const sf::Vector2f& b) const
-{
-	return a.x < b.x || (a.x == b.x && a.y < b.y);
-}
-
 constexpr bool std::less<te::NavGraphEdge>::operator()(const te::NavGraphEdge& a, const te::NavGraphEdge& b) const
 {
 	return a.getFrom() < b.getFrom() ||
@@ -36,12 +35,12 @@ namespace te
 	const TMX::TileData TMX::NULL_DATA = TMX::TileData{ NULL_TILE, TMX::ObjectGroup() };
 
 	TMX::TMX()
-		: mFilename{""}, mOrientation{Orientation::Orthogonal}, mWidth{0}, mHeight{0}, mTilewidth{0}, mTileheight{0}, mTilesets{}, mLayers{}, mObjectGroups{}, mLayerNames{}
+		: mFilename{""}, mOrientation{Orientation::Orthogonal}, mWidth{0}, mHeight{0}, mTilewidth{0}, mTileheight{0}, mTilesets{}, mLayers{}, mObjectGroups{}, mLayerNames{}, mProperties{}
 	{}
 
 	bool TMX::loadFromFile(const std::string& filename)
 	{
-		rapidxml::file<> tmxFile(filename.c_str());
+		std::vector<char> tmxFile = readAssetText(filename);
 		rapidxml::xml_document<> tmx;
 		tmx.parse<0>(tmxFile.data());
 
@@ -59,6 +58,13 @@ namespace te
 		mTilewidth = std::stoi(pMapNode->first_attribute("tilewidth")->value());
 		mTileheight = std::stoi(pMapNode->first_attribute("tileheight")->value());
 
+		rapidxml::xml_node<char>* pProperties = pMapNode->first_node("properties");
+		for (rapidxml::xml_node<char>* pProperty = pProperties != 0 ? pProperties->first_node("property") : 0; pProperty != 0; pProperty = pProperty->next_sibling("property"))
+		{
+			rapidxml::xml_attribute<char>* pValue = pProperty->first_attribute("value");
+			mProperties[pProperty->first_attribute("name")->value()] = pValue != 0 ? pValue->value() : pProperty->value();
+		}
+
 		for (rapidxml::xml_node<char>* pTileset = tmx.first_node("map")->first_node("tileset"); pTileset != 0; pTileset = pTileset->next_sibling("tileset"))
 		{
 			std::vector<TileData> tiles;
@@ -368,8 +374,10 @@ namespace te
 
 	CompositeCollider* TMX::makeCollider(const sf::Transform& sourceTransform) const
 	{
-		CompositeCollider* pCollider = new CompositeCollider();
-		std::for_each(mLayers.begin(), mLayers.end(), [pCollider, &sourceTransform, this](const Layer& layer) {
+		// Gather every tile's rects first so walls of adjacent tiles merge
+		// into a few large boxes.
+		std::vector<sf::FloatRect> rects;
+		std::for_each(mLayers.begin(), mLayers.end(), [&rects, &sourceTransform, this](const Layer& layer) {
 			for (int y = 0; y < mHeight; ++y)
 			{
 				for (int x = 0; x < mWidth; ++x)
@@ -379,15 +387,22 @@ namespace te
 					{
 						sf::Transform transform = sourceTransform;
 						transform.translate((float)x * mTilewidth, (float)y * mTileheight);
-						std::for_each(tileData.objectgroup.objects.begin(), tileData.objectgroup.objects.end(), [pCollider, &transform](const Object& obj) {
+						std::for_each(tileData.objectgroup.objects.begin(), tileData.objectgroup.objects.end(), [&rects, &transform](const Object& obj) {
 							if (obj.polygons.size() == 0) {
-								pCollider->addCollider({ transform.transformRect({ (float)obj.x, (float)obj.y, (float)obj.width, (float)obj.height }) });
+								rects.push_back(transform.transformRect({ (float)obj.x, (float)obj.y, (float)obj.width, (float)obj.height }));
 							}
 						});
 					}
 				}
 			}
 		});
+		mergeRects(rects);
+
+		CompositeCollider* pCollider = new CompositeCollider();
+		for (const auto& rect : rects)
+		{
+			pCollider->addCollider({ rect });
+		}
 		return pCollider;
 	}
 
@@ -398,105 +413,9 @@ namespace te
 
 	SparseGraph<NavGraphNode, NavGraphEdge>* TMX::makeNavGraph(const sf::Transform& transform) const
 	{
-		std::unique_ptr<CompositeCollider> pCollider(makeCollider(transform));
-		NavGraphNode seedNode;
-		seedNode.setIndex(-1);
-		int x = 0, y = 0;
-		while (seedNode.getIndex() == -1 && y < mHeight)
-		{
-			sf::Vector2f coords = transform.transformPoint({ x * mTilewidth + (mTilewidth / 2.f), y * mTileheight + (mTileheight / 2.f) });
-			if (!pCollider->contains(coords.x, coords.y))
-			{
-				seedNode.setIndex(0);
-				seedNode.setPosition(coords);
-			}
-			else
-			{
-				++x;
-				if (x == mWidth)
-				{
-					x = 0;
-					++y;
-				}
-			}
-		}
-
-		SparseGraph<NavGraphNode, NavGraphEdge>* pGraph = new SparseGraph<NavGraphNode, NavGraphEdge>();
-		if (seedNode.getIndex() != -1)
-		{
-			int seedIndex = pGraph->addNode(seedNode);
-
-			std::vector<NavGraphNode> allNodes;
-			std::map<sf::Vector2f, int> assigned;
-			assigned.insert(std::make_pair(pGraph->getNode(seedIndex).getPosition(), seedIndex));
-			auto flood = [&, this](int startIndex) {
-				sf::Vector2f pos = pGraph->getNode(startIndex).getPosition();
-				std::vector<int> newIndices;
-
-				const std::array<sf::Vector2f, 4> offsets = {
-					transform.transformPoint(sf::Vector2f((float)mTilewidth, 0)),
-					transform.transformPoint(sf::Vector2f(-(float)mTilewidth, 0)),
-					transform.transformPoint(sf::Vector2f(0, (float)mTileheight)),
-					transform.transformPoint(sf::Vector2f(0, -(float)mTileheight))
-				};
-				std::for_each(offsets.begin(), offsets.end(), [&](const sf::Vector2f& offset) {
-					sf::Vector2f newPos = offset + pos;
-					sf::Vector2f max = transform.transformPoint((float)mWidth * mTilewidth, (float)mHeight * mTileheight);
-					if (assigned.find(newPos) == assigned.end() && !pCollider->contains(newPos.x, newPos.y) && newPos.x > 0 && newPos.x < max.x && newPos.y > 0 && newPos.y < max.y)
-					{
-						NavGraphNode newNode;
-						newNode.setPosition(newPos);
-						int newIndex = pGraph->addNode(newNode);
-						//graph.addEdge(NavGraphEdge(startIndex, newIndex, length(graph.getNode(startIndex).getPosition() - newPos)));
-
-						assigned.insert(std::make_pair(newPos, newIndex));
-						newIndices.push_back(newIndex);
-					}
-				});
-
-				// Add diagonal edges
-				std::for_each(newIndices.begin(), newIndices.end(), [&](int newIndex) {
-					sf::Vector2f newPosition = pGraph->getNode(newIndex).getPosition();
-
-					const std::array<sf::Vector2f, 8> neighbors = {
-						transform.transformPoint(sf::Vector2f((float)mTilewidth, 0)),
-						transform.transformPoint(sf::Vector2f(-(float)mTilewidth, 0)),
-						transform.transformPoint(sf::Vector2f(0, (float)mTileheight)),
-						transform.transformPoint(sf::Vector2f(0, -(float)mTileheight)),
-						transform.transformPoint(sf::Vector2f((float)mTilewidth, (float)mTileheight)),
-						transform.transformPoint(sf::Vector2f(-(float)mTilewidth, (float)mTileheight)),
-						transform.transformPoint(sf::Vector2f(-(float)mTilewidth, -(float)mTileheight)),
-						transform.transformPoint(sf::Vector2f((float)mTilewidth, -(float)mTileheight))
-					};
-					std::for_each(neighbors.begin(), neighbors.end(), [&](sf::Vector2f offset) {
-						sf::Vector2f neighbor = newPosition + offset;
-						auto neighborIndexIter = assigned.find(neighbor);
-						if (neighborIndexIter != assigned.end())
-						{
-							pGraph->addEdge(NavGraphEdge(newIndex, neighborIndexIter->second, length(pGraph->getNode(newIndex).getPosition() - neighbor)));
-						}
-					});
-				});
-				return newIndices;
-			};
-
-			auto flatMapFlood = [&](std::vector<int> indices) {
-				std::vector<int> newIndices;
-				std::for_each(indices.begin(), indices.end(), [&](int index) {
-					std::vector<int> currIndices = flood(index);
-					newIndices.insert(newIndices.end(), currIndices.begin(), currIndices.end());
-				});
-				return newIndices;
-			};
-
-			std::vector<int> newIndices = flatMapFlood({ seedIndex });
-			while (newIndices.size() > 0)
-			{
-				newIndices = flatMapFlood(newIndices);
-			}
-		}
-		pGraph->pruneEdges();
-		return pGraph;
+		std::unique_ptr<WalkableGrid> pGrid(makeWalkableGrid(transform));
+		std::unique_ptr<CompactNavGraph> pCompact(makeTileNavGraph(*pGrid));
+		return makeSparseNavGraph(*pCompact);
 	}
 
 	TMX::Orientation TMX::getOrienation() const
@@ -524,6 +443,24 @@ namespace te
 		return mTileheight;
 	}
 
+	WalkableGrid* TMX::makeWalkableGrid(const sf::Transform& transform) const
+	{
+		std::unique_ptr<CompositeCollider> pCollider(makeCollider(transform));
+		sf::Vector2f origin = transform.transformPoint(0.f, 0.f);
+		sf::Vector2f tileSize = transform.transformPoint((float)mTilewidth, (float)mTileheight) - origin;
+
+		WalkableGrid* pGrid = new WalkableGrid(mWidth, mHeight, tileSize, origin);
+		for (int y = 0; y < mHeight; ++y)
+		{
+			for (int x = 0; x < mWidth; ++x)
+			{
+				sf::Vector2f coords = transform.transformPoint({ x * mTilewidth + (mTilewidth / 2.f), y * mTileheight + (mTileheight / 2.f) });
+				pGrid->setWalkable(x, y, !pCollider->contains(coords.x, coords.y));
+			}
+		}
+		return pGrid;
+	}
+
 	sf::Transform TMX::getTileToPixelTransform() const
 	{
 		switch (mOrientation)
@@ -553,4 +490,10 @@ namespace te
 	{
 		return mObjectGroups;
 	}
+
+	std::string TMX::getProperty(const std::string& name, const std::string& defaultValue) const
+	{
+		auto found = mProperties.find(name);
+		return found != mProperties.end() ? found->second : defaultValue;
+	}
 }
@@ -5,6 +5,7 @@
 
 #include <string>
 #include <vector>
+#include <map>
 #include <memory>
 #include <algorithm>
 
@@ -17,6 +18,7 @@ namespace te
 	class CompositeCollider;
 	class NavGraphNode;
 	class NavGraphEdge;
+	class WalkableGrid;
 
 	class TMX
 	{
@@ -91,6 +93,8 @@ namespace te
 		CompositeCollider* makeCollider(const sf::Transform& transform = sf::Transform::Identity) const;
 
 		SparseGraph<NavGraphNode, NavGraphEdge>* makeNavGraph(const sf::Transform& transform = sf::Transform::Identity) const;
+		// Every tile whose center is clear of the collider, reachable or not.
+		WalkableGrid* makeWalkableGrid(const sf::Transform& transform = sf::Transform::Identity) const;
 
 		Orientation getOrienation() const;
 		int getWidth() const;
@@ -98,6 +102,8 @@ namespace te
 		int getTileWidth() const;
 		int getTileHeight() const;
 		sf::Transform getTileToPixelTransform() const;
+		// A custom property set on the map in Tiled.
+		std::string getProperty(const std::string& name, const std::string& defaultValue = "") const;
 
 		std::vector<ObjectGroup> getObjectGroups() const;
 
@@ -137,6 +143,7 @@ namespace te
 		std::vector<Layer> mLayers;
 		std::vector<ObjectGroup> mObjectGroups;
 		std::vector<std::string> mLayerNames;
+		std::map<std::string, std::string> mProperties;
 	};
 }
 
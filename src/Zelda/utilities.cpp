@@ -1,6 +1,7 @@
 #include "utilities.h"
 #include "game.h"
 #include "vector_ops.h"
+#include "../TantechEngine/asset_pack.h"
 
 #include <lua.hpp>
 #include <Box2D/Box2D.h>
@@ -40,7 +41,7 @@ namespace te
 
 	void doLuaFile(lua_State& L, const std::string& filename)
 	{
-		if (luaL_dofile(&L, filename.c_str())) throw std::runtime_error(lua_tostring(&L, -1));
+		if (doLuaAsset(&L, filename)) throw std::runtime_error(lua_tostring(&L, -1));
 	}
 
 	class RayCastCallback : public b2RayCastCallback
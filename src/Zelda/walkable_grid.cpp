@@ -0,0 +1,64 @@
+#include "walkable_grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace te
+{
+	WalkableGrid::WalkableGrid(int width, int height, sf::Vector2f tileSize, sf::Vector2f origin)
+		: mWidth(width)
+		, mHeight(height)
+		, mTileSize(tileSize)
+		, mOrigin(origin)
+		, mTiles(std::max(width, 0) * std::max(height, 0), 0)
+	{}
+
+	int WalkableGrid::getWidth() const
+	{
+		return mWidth;
+	}
+
+	int WalkableGrid::getHeight() const
+	{
+		return mHeight;
+	}
+
+	sf::Vector2f WalkableGrid::getTileSize() const
+	{
+		return mTileSize;
+	}
+
+	sf::Vector2f WalkableGrid::getOrigin() const
+	{
+		return mOrigin;
+	}
+
+	void WalkableGrid::setWalkable(int x, int y, bool walkable)
+	{
+		if (x < 0 || y < 0 || x >= mWidth || y >= mHeight)
+			throw std::out_of_range("Tile is outside the grid.");
+		mTiles[y * mWidth + x] = walkable ? 1 : 0;
+	}
+
+	int WalkableGrid::numWalkable() const
+	{
+		return static_cast<int>(std::count(mTiles.begin(), mTiles.end(), 1));
+	}
+
+	sf::Vector2i WalkableGrid::getTile(sf::Vector2f position) const
+	{
+		return{
+			static_cast<int>(std::floor((position.x - mOrigin.x) / mTileSize.x)),
+			static_cast<int>(std::floor((position.y - mOrigin.y) / mTileSize.y))
+		};
+	}
+
+	sf::Vector2f WalkableGrid::getTileCenter(sf::Vector2i tile) const
+	{
+		return{
+			mOrigin.x + (tile.x + 0.5f) * mTileSize.x,
+			mOrigin.y + (tile.y + 0.5f) * mTileSize.y
+		};
+	}
+}
@@ -0,0 +1,44 @@
+#ifndef TE_WALKABLE_GRID_H
+#define TE_WALKABLE_GRID_H
+
+#include <SFML/System/Vector2.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace te
+{
+	// Which tiles of a map can be walked on, one byte per tile, for
+	// planners that search the tiles directly instead of a nav graph.
+	class WalkableGrid
+	{
+	public:
+		// origin is the top left corner of tile 0, 0.
+		WalkableGrid(int width, int height, sf::Vector2f tileSize, sf::Vector2f origin = { 0.f, 0.f });
+
+		int getWidth() const;
+		int getHeight() const;
+		sf::Vector2f getTileSize() const;
+		sf::Vector2f getOrigin() const;
+
+		// Tiles off the grid are not walkable.
+		bool isWalkable(int x, int y) const
+		{
+			return x >= 0 && y >= 0 && x < mWidth && y < mHeight && mTiles[y * mWidth + x] != 0;
+		}
+		void setWalkable(int x, int y, bool walkable);
+		int numWalkable() const;
+
+		sf::Vector2i getTile(sf::Vector2f position) const;
+		sf::Vector2f getTileCenter(sf::Vector2i tile) const;
+
+	private:
+		int mWidth;
+		int mHeight;
+		sf::Vector2f mTileSize;
+		sf::Vector2f mOrigin;
+		std::vector<uint8_t> mTiles;
+	};
+}
+
+#endif
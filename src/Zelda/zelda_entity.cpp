@@ -33,6 +33,11 @@ namespace te
 		return mSteering;
 	}
 
+	bool ZeldaEntity::handleMessage(const Telegram& telegram)
+	{
+		return mBrain.handleMessage(telegram) || MovingEntity::handleMessage(telegram);
+	}
+
 	void ZeldaEntity::onDraw(sf::RenderTarget& target, sf::RenderStates states) const
 	{
 		states.transform *= getWorldTransform();
@@ -56,6 +56,7 @@ namespace te
 
 		mpCamera = std::make_unique<Camera>(getEntityManager(), mPlayerID, sf::Vector2f(16 * 24.f, 9 * 24.f));
 
+		setCellSpace((float)tmx.getTileWidth() * tmx.getWidth(), (float)tmx.getTileHeight() * tmx.getHeight(), tmx.getWidth() / 4, tmx.getHeight() / 4);
 		setTileMap(TileMap::make(*this, getTextureManager(), std::move(tmx)));
 		getMap().setDrawColliderEnabled(true);
 		getMap().setDrawNavGraphEnabled(true);
@@ -107,6 +108,14 @@ namespace te
 		}
 	}
 
+	void ZeldaGame::update(const sf::Time& dt)
+	{
+		// Enemies all chase the player, so they share one flow field. It is
+		// only searched again while one of them is following it.
+		getMap().getFlowField().setGoal(getEntityManager().getEntityFromID(mPlayerID).getPosition());
+		Game::update(dt);
+	}
+
 	void ZeldaGame::draw(sf::RenderTarget& target, sf::RenderStates states) const
 	{
 		states.transform.scale(0.5f, 0.5f) *= getWorldToPixelTransform();
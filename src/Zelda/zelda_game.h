@@ -21,6 +21,7 @@ namespace te
 	private:
 		ZeldaGame(Application& app, const std::string& fileName, const sf::Transform& pixelToWorld);
 
+		void update(const sf::Time& dt);
 		void draw(sf::RenderTarget& target, sf::RenderStates states) const;
 		void loadMap(const std::string& fileName);
 
@@ -0,0 +1,113 @@
+// Times the image kernels texture loading uses on the largest tile sheets
+// in assets: the color key against the per pixel byte compare it replaced,
+// on one thread and on a JobPool, then padding to a power of two and
+// luminance. Checks the color keyed pixels match the byte compare.
+//
+// Run from the repository root. Build with the TantechEngine sources it
+// uses and DevIL, e.g.
+//   g++ -std=c++14 -O2 -msse2 -Ilib/glew-1.12.0/include -Ilib/SDL2-2.0.3/include -Ilib/Devil/include
+//       -Isrc/TantechEngine tools/image_ops_bench.cpp src/TantechEngine/image_ops.cpp
+//       src/TantechEngine/job_pool.cpp -lIL -lpthread
+
+#include "image_ops.h"
+#include "job_pool.h"
+
+#include <IL/il.h>
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace te;
+
+static const int RUNS = 20;
+
+// Average milliseconds per run.
+static double timeRuns(const std::function<void()>& fn)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < RUNS; ++i) fn();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count() / RUNS;
+}
+
+// The same sizes Texture pads to.
+static GLuint nextPowerOfTwo(GLuint n)
+{
+    GLuint power = 1;
+    while (power < n) power <<= 1;
+    return power;
+}
+
+int main()
+{
+    const std::vector<std::string> images{
+        "assets/spritesheets/platformer-art-complete-pack-0/Base pack/Tiles/tiles_spritesheet.png",
+        "assets/spritesheets/platformer-art-complete-pack-0/Request pack/sheet.png",
+        "assets/spritesheets/tilesets/grass.png"
+    };
+    ilInit();
+    JobPool pool;
+    int mismatches = 0;
+
+    for (const auto& image : images) {
+        ILuint imgID = 0;
+        ilGenImages(1, &imgID);
+        ilBindImage(imgID);
+        if (ilLoadImage(image.c_str()) != IL_TRUE || ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE) != IL_TRUE) {
+            ilDeleteImages(1, &imgID);
+            std::printf("Skipping %s\n", image.c_str());
+            continue;
+        }
+        GLuint width = (GLuint)ilGetInteger(IL_IMAGE_WIDTH);
+        GLuint height = (GLuint)ilGetInteger(IL_IMAGE_HEIGHT);
+        const GLuint* data = (const GLuint*)ilGetData();
+        std::vector<GLuint> pixels(data, data + width * height);
+        ilDeleteImages(1, &imgID);
+
+        std::vector<GLuint> reference(pixels);
+        std::vector<GLuint> work(pixels);
+        std::vector<GLubyte> luminance(pixels.size());
+
+        // The per pixel byte compare Texture::loadWithColorMask used to do.
+        double byteCompare = timeRuns([&] {
+            reference = pixels;
+            for (auto& pixel : reference) {
+                GLubyte* colors = (GLubyte*)&pixel;
+                if (colors[0] == 255 && colors[1] == 0 && colors[2] == 255) {
+                    colors[0] = 255;
+                    colors[1] = 255;
+                    colors[2] = 255;
+                    colors[3] = 0;
+                }
+            }
+        });
+        double serial = timeRuns([&] {
+            work = pixels;
+            applyColorKey(work.data(), width, height, 255, 0, 255);
+        });
+        if (work != reference) ++mismatches;
+        double pooled = timeRuns([&] {
+            work = pixels;
+            applyColorKey(work.data(), width, height, 255, 0, 255, 0, &pool);
+        });
+        if (work != reference) ++mismatches;
+        double padded = timeRuns([&] {
+            padCanvas32(pixels.data(), width, height, nextPowerOfTwo(width), nextPowerOfTwo(height), 0x00ffffff, &pool);
+        });
+        double grey = timeRuns([&] {
+            rgbaToLuminance(pixels.data(), luminance.data(), width, height, &pool);
+        });
+
+        std::printf("%s (%ux%u)\n", image.c_str(), width, height);
+        std::printf("    color key: byte compare %.3f ms, serial %.3f ms, %u threads %.3f ms\n",
+            byteCompare, serial, pool.getThreadCount() + 1, pooled);
+        std::printf("    pad to power of two: %.3f ms\n", padded);
+        std::printf("    luminance: %.3f ms\n", grey);
+    }
+
+    if (mismatches > 0) std::printf("%d color key mismatches\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
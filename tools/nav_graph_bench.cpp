@@ -0,0 +1,222 @@
+// Times A* on a 200x200 tile nav graph, once over the SparseGraph edge
+// lists and once over the CompactNavGraph built from it, and checks both
+// find paths of the same cost. Then times HPA* over a HierarchicalNavGraph
+// on the same queries, refining every leg, against the shortest paths,
+// and Jump Point Search over the walkable tiles against GraphSearchAStar.
+//
+// Build from the repository root with the Zelda sources it uses, e.g.
+//   g++ -std=c++14 -O2 -Ilib/SFML-2.3.2/include -Ilib/Box2D/include -Isrc/Zelda
+//       tools/nav_graph_bench.cpp src/Zelda/graph_node.cpp src/Zelda/graph_edge.cpp
+//       src/Zelda/nav_graph_node.cpp src/Zelda/nav_graph_edge.cpp
+//       src/Zelda/compact_nav_graph.cpp src/Zelda/hierarchical_nav_graph.cpp
+//       src/Zelda/walkable_grid.cpp src/Zelda/jump_point_search.cpp
+//       -lsfml-graphics -lsfml-system
+
+#include "sparse_graph.h"
+#include "compact_nav_graph.h"
+#include "graph_search_a_star.h"
+#include "graph_search_compact_a_star.h"
+#include "hierarchical_nav_graph.h"
+#include "jump_point_search.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace te;
+
+typedef SparseGraph<NavGraphNode, NavGraphEdge> NavGraph;
+
+static const int MAP_SIZE = 200;
+static const int QUERIES = 500;
+
+// A node per open tile with edges to the open tiles around it, about a
+// fifth of the tiles walls in short runs like the TMX maps have. The
+// same tiles are marked in grid.
+static void makeTileGraph(NavGraph& graph, WalkableGrid& grid, std::mt19937& rng)
+{
+	std::vector<bool> wall(MAP_SIZE * MAP_SIZE, false);
+	std::uniform_int_distribution<int> tile(0, MAP_SIZE - 1), run(2, 8), horizontal(0, 1);
+	for (int i = 0; i < MAP_SIZE * MAP_SIZE / 25; ++i)
+	{
+		int x = tile(rng), y = tile(rng), length = run(rng);
+		bool alongX = horizontal(rng) == 1;
+		for (int j = 0; j < length; ++j)
+		{
+			int wx = alongX ? x + j : x, wy = alongX ? y : y + j;
+			if (wx < MAP_SIZE && wy < MAP_SIZE) wall[wy * MAP_SIZE + wx] = true;
+		}
+	}
+
+	std::vector<int> nodeOfTile(MAP_SIZE * MAP_SIZE, -1);
+	for (int y = 0; y < MAP_SIZE; ++y)
+	{
+		for (int x = 0; x < MAP_SIZE; ++x)
+		{
+			if (wall[y * MAP_SIZE + x]) continue;
+			grid.setWalkable(x, y, true);
+			NavGraphNode node;
+			node.setPosition({ x + 0.5f, y + 0.5f });
+			nodeOfTile[y * MAP_SIZE + x] = graph.addNode(node);
+		}
+	}
+
+	const int offsets[4][2] = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { 1, -1 } };
+	for (int y = 0; y < MAP_SIZE; ++y)
+	{
+		for (int x = 0; x < MAP_SIZE; ++x)
+		{
+			int from = nodeOfTile[y * MAP_SIZE + x];
+			if (from < 0) continue;
+			for (const auto& offset : offsets)
+			{
+				int nx = x + offset[0], ny = y + offset[1];
+				if (nx < 0 || ny < 0 || nx >= MAP_SIZE || ny >= MAP_SIZE) continue;
+				int to = nodeOfTile[ny * MAP_SIZE + nx];
+				if (to < 0) continue;
+				graph.addEdge(NavGraphEdge(from, to, std::sqrt(double(offset[0] * offset[0] + offset[1] * offset[1]))));
+			}
+		}
+	}
+}
+
+static double pathCost(const NavGraph& graph, const std::list<int>& path)
+{
+	double cost = 0;
+	if (path.empty()) return cost;
+	for (auto it = path.begin(); std::next(it) != path.end(); ++it)
+	{
+		cost += graph.getEdge(*std::next(it), *it).getCost();
+	}
+	return cost;
+}
+
+int main()
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	std::mt19937 rng(7);
+	NavGraph graph;
+	WalkableGrid grid(MAP_SIZE, MAP_SIZE, { 1.f, 1.f });
+	makeTileGraph(graph, grid, rng);
+
+	auto compileStart = Clock::now();
+	CompactNavGraph compact(graph);
+	double compileMs = std::chrono::duration<double, std::milli>(Clock::now() - compileStart).count();
+	std::printf("%d nodes, %d edges, compiled in %.1f ms\n", compact.numNodes(), compact.numEdges(), compileMs);
+
+	std::uniform_int_distribution<int> node(0, graph.numNodes() - 1);
+	std::vector<std::pair<int, int>> queries;
+	for (int i = 0; i < QUERIES; ++i)
+	{
+		queries.push_back({ node(rng), node(rng) });
+	}
+
+	GraphSearchAStar<NavGraph, HeuristicEuclid> listSearch(graph);
+	GraphSearchCompactAStar compactSearch(compact);
+	std::vector<double> listCosts, compactCosts;
+
+	auto listStart = Clock::now();
+	for (const auto& query : queries)
+	{
+		listSearch.search(query.first, query.second);
+		listCosts.push_back(pathCost(graph, listSearch.getPathToTarget()));
+	}
+	double listMs = std::chrono::duration<double, std::milli>(Clock::now() - listStart).count();
+
+	auto compactStart = Clock::now();
+	for (const auto& query : queries)
+	{
+		compactSearch.search(query.first, query.second);
+		compactCosts.push_back(compactSearch.getCostToTarget());
+	}
+	double compactMs = std::chrono::duration<double, std::milli>(Clock::now() - compactStart).count();
+
+	int mismatches = 0;
+	for (int i = 0; i < QUERIES; ++i)
+	{
+		double listCost = listCosts[i], compactCost = compactCosts[i] < 0 ? 0 : compactCosts[i];
+		if (std::abs(listCost - compactCost) > 1e-3 * (1 + listCost)) ++mismatches;
+	}
+
+	std::printf("%d queries: edge lists %.1f ms, compact %.1f ms (%.1fx), %d cost mismatches\n",
+		QUERIES, listMs, compactMs, listMs / compactMs, mismatches);
+
+	auto buildStart = Clock::now();
+	HierarchicalNavGraph hierarchy(compact, { 1.f, 1.f }, { MAP_SIZE, MAP_SIZE });
+	double buildMs = std::chrono::duration<double, std::milli>(Clock::now() - buildStart).count();
+	std::printf("%d clusters, %d entrances, built in %.1f ms\n", hierarchy.numClusters(), hierarchy.numEntrances(), buildMs);
+
+	// Only the long requests, where flat A* hurts.
+	std::vector<int> longQueries;
+	for (int i = 0; i < QUERIES; ++i)
+	{
+		if (compactCosts[i] > MAP_SIZE / 2) longQueries.push_back(i);
+	}
+
+	double abstractMs = 0, refineMs = 0, flatMs = 0, longestRatio = 1, ratioSum = 0;
+	std::size_t flatTouched = 0, hierarchyTouched = 0;
+	int failures = 0;
+	std::list<int> waypoints;
+	for (int i : longQueries)
+	{
+		auto flatStart = Clock::now();
+		compactSearch.search(queries[i].first, queries[i].second);
+		flatMs += std::chrono::duration<double, std::milli>(Clock::now() - flatStart).count();
+		flatTouched += compactSearch.getNodesTouched();
+
+		auto abstractStart = Clock::now();
+		bool found = hierarchy.findPath(queries[i].first, queries[i].second, waypoints);
+		auto refineStart = Clock::now();
+		abstractMs += std::chrono::duration<double, std::milli>(refineStart - abstractStart).count();
+		hierarchyTouched += hierarchy.getEntrancesTouched();
+
+		double cost = 0;
+		for (auto it = waypoints.begin(); found && std::next(it) != waypoints.end(); ++it)
+		{
+			found = compactSearch.search(*it, *std::next(it));
+			cost += compactSearch.getCostToTarget();
+			hierarchyTouched += compactSearch.getNodesTouched();
+		}
+		refineMs += std::chrono::duration<double, std::milli>(Clock::now() - refineStart).count();
+
+		if (!found)
+		{
+			++failures;
+			continue;
+		}
+		double ratio = cost / compactCosts[i];
+		ratioSum += ratio;
+		longestRatio = std::max(longestRatio, ratio);
+	}
+
+	int solved = static_cast<int>(longQueries.size()) - failures;
+	std::printf("%d long queries: flat %.1f ms, %zu nodes touched; hierarchical %.1f ms to plan + %.1f ms to refine, %zu touched\n",
+		static_cast<int>(longQueries.size()), flatMs, flatTouched, abstractMs, refineMs, hierarchyTouched);
+	std::printf("hierarchical paths %.3fx optimal on average, %.3fx at worst, %d not found\n",
+		solved ? ratioSum / solved : 0.0, longestRatio, failures);
+
+	// The nav graph links diagonals whatever is beside them, as DIAGONAL
+	// moves do.
+	JumpPointSearch jumpPointSearch(grid, JumpPointSearch::Moves::DIAGONAL);
+	std::size_t jumpTouched = 0;
+	int jumpMismatches = 0;
+	auto tile = [&graph](int node) {
+		sf::Vector2f position = graph.getNode(node).getPosition();
+		return sf::Vector2i(static_cast<int>(position.x), static_cast<int>(position.y));
+	};
+
+	auto jumpStart = Clock::now();
+	for (int i = 0; i < QUERIES; ++i)
+	{
+		jumpPointSearch.search(tile(queries[i].first), tile(queries[i].second));
+		jumpTouched += jumpPointSearch.getNodesTouched();
+		if (std::abs(jumpPointSearch.getCostToTarget() - compactCosts[i]) > 1e-3 * (1 + std::abs(compactCosts[i]))) ++jumpMismatches;
+	}
+	double jumpMs = std::chrono::duration<double, std::milli>(Clock::now() - jumpStart).count();
+
+	std::printf("%d queries: jump point search %.1f ms (%.1fx edge lists), %zu tiles opened, %d cost mismatches\n",
+		QUERIES, jumpMs, listMs / jumpMs, jumpTouched, jumpMismatches);
+	return mismatches == 0 && jumpMismatches == 0 ? 0 : 1;
+}
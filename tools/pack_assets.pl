@@ -0,0 +1,146 @@
+#!/usr/bin/perl -w
+use strict;
+use File::Find;
+use File::Spec;
+
+my $usage = "Usage: pack_assets.pl [options] [directory...]";
+my $help = <<EOF;
+
+$usage
+Options:
+  --help            prints help and exits
+  --out FILE        writes the pack to FILE instead of assets.pak
+  --no-compress     stores every entry uncompressed
+
+Packs the given directories (assets by default) into a single archive read
+by te::AssetPack. Run it from the repository root so entries are stored
+under the same relative paths the games open, e.g. assets/maps/grassy.tmx.
+
+Entries are LZ4 block compressed when that saves at least an eighth of
+their size; images are usually stored as is, which lets the engine read
+them straight out of the mapped pack.
+
+EOF
+
+my $out = "assets.pak";
+my $compress = 1;
+my @dirs;
+while (@ARGV) {
+    my $arg = shift @ARGV;
+    if ($arg eq "--help") { print $help; exit 0; }
+    elsif ($arg eq "--out") { $out = shift @ARGV or die $usage, "\n"; }
+    elsif ($arg eq "--no-compress") { $compress = 0; }
+    elsif ($arg =~ /^-/) { die "Option `$arg' not supported.\n"; }
+    else { push @dirs, $arg; }
+}
+@dirs = ("assets") unless @dirs;
+
+my @paths;
+find({ no_chdir => 1, wanted => sub {
+    return unless -f $_;
+    my $path = File::Spec->abs2rel($_);
+    $path =~ s{\\}{/}g;
+    push @paths, $path;
+}}, @dirs);
+
+# The engine binary searches the index bytewise.
+@paths = sort { $a cmp $b } @paths;
+
+# Greedy LZ4 block compressor, one hash probe per position. Follows the
+# format's end of block rules: the last match starts at least 12 bytes
+# before the end and the last 5 bytes are literals.
+sub lz4_length {
+    my ($length) = @_;
+    my $bytes = "";
+    while ($length >= 255) { $bytes .= chr(255); $length -= 255; }
+    return $bytes . chr($length);
+}
+
+sub lz4_sequence {
+    my ($literals, $offset, $match) = @_;
+    my $literal_length = length $literals;
+    my $token = ($literal_length < 15 ? $literal_length : 15) << 4;
+    $token |= defined $match ? ($match - 4 < 15 ? $match - 4 : 15) : 0;
+
+    my $sequence = chr($token);
+    $sequence .= lz4_length($literal_length - 15) if $literal_length >= 15;
+    $sequence .= $literals;
+    if (defined $match) {
+        $sequence .= pack("v", $offset);
+        $sequence .= lz4_length($match - 4 - 15) if $match - 4 >= 15;
+    }
+    return $sequence;
+}
+
+sub lz4_compress {
+    my ($src) = @_;
+    my $size = length $src;
+    my $out = "";
+    my %last;
+    my ($anchor, $i) = (0, 0);
+
+    while ($i < $size - 12) {
+        my $key = substr($src, $i, 4);
+        my $ref = $last{$key};
+        $last{$key} = $i;
+        if (defined $ref && $i - $ref <= 65535) {
+            my $match = 4;
+            my $max = $size - 5 - $i;
+            $match++ while $match < $max && substr($src, $ref + $match, 1) eq substr($src, $i + $match, 1);
+            $out .= lz4_sequence(substr($src, $anchor, $i - $anchor), $i - $ref, $match);
+            $i += $match;
+            $anchor = $i;
+        } else {
+            $i++;
+        }
+    }
+    return $out . lz4_sequence(substr($src, $anchor));
+}
+
+my $header_size = 16;
+my $entry_size = 24;
+my $paths_offset = $header_size + $entry_size * @paths;
+my $paths_size = 0;
+$paths_size += length $_ for @paths;
+
+sub align { my ($n) = @_; return ($n + 15) & ~15; }
+
+my (@entries, @blobs);
+my $path_offset = $paths_offset;
+my $data_offset = align($paths_offset + $paths_size);
+my ($total, $stored_total) = (0, 0);
+for my $path (@paths) {
+    open(my $in, "<:raw", $path) or die "Could not read $path: $!\n";
+    local $/;
+    my $data = <$in>;
+    $data = "" unless defined $data;
+    close $in;
+
+    my ($stored, $flags) = ($data, 0);
+    if ($compress && length $data > 64) {
+        my $packed = lz4_compress($data);
+        if (length $packed <= length($data) - length($data) / 8) {
+            ($stored, $flags) = ($packed, 1);
+        }
+    }
+
+    push @entries, pack("V6", $path_offset, length $path, $data_offset, length $stored, length $data, $flags);
+    push @blobs, [$data_offset, $stored];
+    $path_offset += length $path;
+    $data_offset = align($data_offset + length $stored);
+    $total += length $data;
+    $stored_total += length $stored;
+}
+
+open(my $fh, ">:raw", $out) or die "Could not write $out: $!\n";
+print $fh "TEPK", pack("V3", 1, scalar @paths, 0);
+print $fh @entries;
+print $fh @paths;
+for my $blob (@blobs) {
+    my ($offset, $stored) = @$blob;
+    print $fh "\0" x ($offset - tell $fh);
+    print $fh $stored;
+}
+close $fh;
+
+printf "%s: %d entries, %d bytes stored of %d\n", $out, scalar @paths, $stored_total, $total;